@@ -0,0 +1,61 @@
+#version 430 core
+// Multi-draw variant of depth.vert, the model matrix comes from the DrawBuffer instead of a uniform
+layout (location = 0) in vec3 aPos;
+// index of this draw, sourced from the draw's base instance
+layout (location = 5) in uint aDrawIndex;
+#ifdef SCRATCH_SKINNING
+// joints every skinned vertex follows and how much, three uints a vertex, see GeometryPool::SKINNING_BINDING
+layout (std430, binding = 10) readonly buffer SkinningBuffer {
+    uint skinning[];
+};
+
+// every animated entity's skinning matrices, see AnimationSampler
+layout (std430, binding = 9) readonly buffer BonePalette {
+    mat4 bones[];
+};
+
+const uint NO_PALETTE = 0xFFFFFFFFu;
+#endif
+
+struct DrawData {
+    mat4 model;
+    uint materialIndex;
+    // first of the draw's matrices in the bone palette, NO_PALETTE when it isn't animated
+    uint paletteOffset;
+    // added to gl_VertexID to find the draw's vertices in skinning
+    int skinningOffset;
+};
+
+layout (std430, binding = 0) readonly buffer DrawBuffer {
+    DrawData draws[];
+};
+
+uniform mat4 view;
+uniform mat4 projection;
+
+// must match the shaded passes bit for bit for their GL_EQUAL depth test
+invariant gl_Position;
+
+#ifdef SCRATCH_SKINNING
+// the same in every vertex shader, so the depth passes and shading still match bit for bit
+mat4 SkinMatrix(uint offset, int vertexOffset)
+{
+    uint vertex = uint(gl_VertexID + vertexOffset) * 3u;
+    uvec4 joints = uvec4(skinning[vertex] & 0xFFFFu, skinning[vertex] >> 16u,
+                         skinning[vertex + 1u] & 0xFFFFu, skinning[vertex + 1u] >> 16u) + offset;
+    vec4 weights = unpackUnorm4x8(skinning[vertex + 2u]);
+    return bones[joints.x] * weights.x + bones[joints.y] * weights.y +
+           bones[joints.z] * weights.z + bones[joints.w] * weights.w;
+}
+#endif
+
+void main()
+{
+    mat4 model = draws[aDrawIndex].model;
+#ifdef SCRATCH_SKINNING
+    if (draws[aDrawIndex].paletteOffset != NO_PALETTE) {
+        model = model * SkinMatrix(draws[aDrawIndex].paletteOffset, draws[aDrawIndex].skinningOffset);
+    }
+#endif
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+}
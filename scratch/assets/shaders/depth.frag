@@ -0,0 +1,6 @@
+#version 400 core
+// Nothing to write, depth comes from the rasterizer
+
+void main()
+{
+}
@@ -0,0 +1,55 @@
+#version 400 core
+#ifdef SCRATCH_SKINNING
+#extension GL_ARB_shader_storage_buffer_object : require
+#extension GL_ARB_shading_language_420pack : require
+#endif
+// Depth only, used for shadow casters and the depth pre-pass
+layout (location = 0) in vec3 aPos;
+#ifdef SCRATCH_SKINNING
+// joints every skinned vertex follows and how much, three uints a vertex, see GeometryPool::SKINNING_BINDING
+layout (std430, binding = 10) readonly buffer SkinningBuffer {
+    uint skinning[];
+};
+
+// every animated entity's skinning matrices, see AnimationSampler
+layout (std430, binding = 9) readonly buffer BonePalette {
+    mat4 bones[];
+};
+
+const uint NO_PALETTE = 0xFFFFFFFFu;
+// first of this draw's matrices in bones, NO_PALETTE when it isn't animated
+uniform uint paletteOffset;
+// added to gl_VertexID to find this draw's vertices in skinning
+uniform int skinningOffset;
+#endif
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+// must match the shaded passes bit for bit for their GL_EQUAL depth test
+invariant gl_Position;
+
+#ifdef SCRATCH_SKINNING
+// the same in every vertex shader, so the depth passes and shading still match bit for bit
+mat4 SkinMatrix(uint offset, int vertexOffset)
+{
+    uint vertex = uint(gl_VertexID + vertexOffset) * 3u;
+    uvec4 joints = uvec4(skinning[vertex] & 0xFFFFu, skinning[vertex] >> 16u,
+                         skinning[vertex + 1u] & 0xFFFFu, skinning[vertex + 1u] >> 16u) + offset;
+    vec4 weights = unpackUnorm4x8(skinning[vertex + 2u]);
+    return bones[joints.x] * weights.x + bones[joints.y] * weights.y +
+           bones[joints.z] * weights.z + bones[joints.w] * weights.w;
+}
+#endif
+
+void main()
+{
+    mat4 skinnedModel = model;
+#ifdef SCRATCH_SKINNING
+    if (paletteOffset != NO_PALETTE) {
+        skinnedModel = model * SkinMatrix(paletteOffset, skinningOffset);
+    }
+#endif
+    gl_Position = projection * view * skinnedModel * vec4(aPos, 1.0);
+}
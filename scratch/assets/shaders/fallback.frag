@@ -0,0 +1,12 @@
+#version 400 core
+// Flat grey with a fixed light so shapes stay readable while shaders compile
+in vec3 Normal;
+
+out vec4 FragColor;
+
+void main()
+{
+    vec3 lightDir = normalize(vec3(0.3, 1.0, 0.5));
+    float diff = max(dot(normalize(Normal), lightDir), 0.0);
+    FragColor = vec4(vec3(0.35 + 0.4 * diff), 1.0);
+}
@@ -0,0 +1,216 @@
+#version 430 core
+// Multi-draw variant of lit.frag. Textures are referenced from the MaterialBuffer, either as bindless handles
+// (SCRATCH_BINDLESS_TEXTURES) or as a page and layer into the bound texture arrays (SCRATCH_TEXTURE_ARRAYS).
+#ifdef SCRATCH_BINDLESS_TEXTURES
+#extension GL_ARB_bindless_texture : require
+// lifts the uniformity requirement on handles, TextureManager only picks bindless where it is supported
+#extension GL_NV_gpu_shader5 : require
+#endif
+
+struct GpuMaterial {
+    uvec2 diffuse;
+    uvec2 specular;
+    uvec2 normal;
+    float shininess;
+    uint padding;
+};
+
+struct DirectionalLight {
+    vec3 direction;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+layout (std430, binding = 1) readonly buffer MaterialBuffer {
+    GpuMaterial materials[];
+};
+
+#ifdef SCRATCH_CLUSTERED_LIGHTING
+// Point and spot lights, see LightClusters. Point lights have a cutoff cosine below -1 so the spot falloff is 1.
+struct GpuLight {
+    vec4 positionRange;
+    vec4 directionCosOuter;
+    vec4 diffuseCosInner;
+    vec4 specular;
+};
+
+layout (std430, binding = 2) readonly buffer LightBuffer {
+    GpuLight lights[];
+};
+
+// offset into lightIndices and light count, per cluster
+layout (std430, binding = 3) readonly buffer ClusterBuffer {
+    uvec2 clusterRanges[];
+};
+
+layout (std430, binding = 4) readonly buffer LightIndexBuffer {
+    uint lightIndices[];
+};
+
+uniform vec3 viewPos;
+uniform uvec3 clusterGrid;
+uniform vec2 clusterTileScale;
+uniform float clusterDepthScale;
+uniform float clusterDepthBias;
+
+in mat3 TangentToWorld;
+#endif
+
+in vec2 TexCoords;
+in vec3 FragPos;
+in vec3 TangentViewPos;
+in vec3 TangentFragPos;
+flat in uint MaterialIndex;
+
+uniform DirectionalLight dirLight;
+uniform mat4 view;
+
+// Cascaded shadow maps for the directional light, see ShadowMaps
+uniform sampler2DArrayShadow shadowMap;
+uniform mat4 lightSpaceMatrices[4];
+uniform float cascadeSplits[4];
+uniform int cascadeCount;
+uniform float shadowTexelSize;
+
+#ifdef SCRATCH_TEXTURE_ARRAYS
+uniform sampler2DArray textureArrays[16];
+// pages actually bound, the rest of the units are empty
+uniform int textureArrayCount;
+#endif
+
+out vec4 FragColor;
+
+// The material comes from a per draw index, but draws of one multi-draw can share an invocation group so it
+// isn't dynamically uniform. Bindless handles may differ per invocation with GL_NV_gpu_shader5, sampler array
+// indices have to be uniform
+vec4 sampleTexture(uvec2 reference, vec2 uv)
+{
+#ifdef SCRATCH_BINDLESS_TEXTURES
+    return texture(sampler2D(reference), uv);
+#else
+    // every invocation walks the pages with the same index and samples its own, gradients taken outside the
+    // branch since derivatives inside it are undefined
+    vec2 gradientX = dFdx(uv);
+    vec2 gradientY = dFdy(uv);
+    vec4 result = vec4(0.0);
+    for (int page = 0; page < textureArrayCount; ++page) {
+        if (uint(page) == reference.x) {
+            result = textureGrad(textureArrays[page], vec3(uv, float(reference.y)), gradientX, gradientY);
+        }
+    }
+    return result;
+#endif
+}
+
+vec3 CalcDirLight(DirectionalLight light, GpuMaterial material, vec3 normal, vec3 viewDir, float shadow);
+float CalcShadow(vec3 worldPos);
+#ifdef SCRATCH_CLUSTERED_LIGHTING
+vec3 CalcClusteredLights(vec3 normal, vec3 viewDir, vec3 diffuseColor, vec3 specularColor, float shininess);
+#endif
+
+void main()
+{
+    GpuMaterial material = materials[MaterialIndex];
+
+#ifdef NORMAL_MAP
+    // z is rebuilt so two channel (BC5) maps work too
+    vec2 normalXY = sampleTexture(material.normal, TexCoords).rg * 2.0 - 1.0;
+    vec3 normal = normalize(vec3(normalXY, sqrt(max(1.0 - dot(normalXY, normalXY), 0.0))));
+#else
+    vec3 normal = vec3(0.0, 0.0, 1.0);
+#endif
+    vec3 viewDir = normalize(TangentViewPos - TangentFragPos);
+
+    vec3 result = CalcDirLight(dirLight, material, normal, viewDir, CalcShadow(FragPos));
+#ifdef SCRATCH_CLUSTERED_LIGHTING
+    result += CalcClusteredLights(normalize(TangentToWorld * normal), normalize(viewPos - FragPos),
+                                  vec3(sampleTexture(material.diffuse, TexCoords)),
+                                  vec3(sampleTexture(material.specular, TexCoords)), material.shininess);
+#endif
+
+#ifdef HIGHLIGHTED
+    result += vec3(0,0.5f,0);
+#endif
+
+    FragColor = vec4(result,1);
+}
+
+vec3 CalcDirLight(DirectionalLight light, GpuMaterial material, vec3 normal, vec3 viewDir, float shadow)
+{
+    vec3 lightDir = normalize(-light.direction);
+    float diff = max(dot(lightDir, normal), 0.0);
+
+    vec3 diffuseColor = vec3(sampleTexture(material.diffuse, TexCoords));
+    vec3 ambient  = light.ambient  * diffuseColor;
+    vec3 diffuse  = light.diffuse  * diff * shadow * diffuseColor;
+#ifdef SPECULAR_MAP
+    // Calculate Specular with Blinn-Phong
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(normal, halfwayDir), 0.0), material.shininess);
+    vec3 specular = light.specular * spec * shadow * vec3(sampleTexture(material.specular, TexCoords));
+    return (ambient + diffuse + specular);
+#else
+    return (ambient + diffuse);
+#endif
+}
+
+float CalcShadow(vec3 worldPos)
+{
+    // the first cascade reaching past the fragment's depth
+    float viewDepth = -(view * vec4(worldPos, 1.0)).z;
+    int cascade = 0;
+    while (cascade < cascadeCount && viewDepth > cascadeSplits[cascade]) {
+        ++cascade;
+    }
+    if (cascade >= cascadeCount) {
+        return 1.0;
+    }
+    vec4 lightSpacePos = lightSpaceMatrices[cascade] * vec4(worldPos, 1.0);
+    vec3 coords = lightSpacePos.xyz / lightSpacePos.w * 0.5 + 0.5;
+    if (coords.z > 1.0) {
+        return 1.0;
+    }
+    // PCF over 3x3 taps, each one already a filtered 2x2 comparison
+    float lit = 0.0;
+    for (int x = -1; x <= 1; ++x) {
+        for (int y = -1; y <= 1; ++y) {
+            lit += texture(shadowMap, vec4(coords.xy + vec2(x, y) * shadowTexelSize, float(cascade), coords.z));
+        }
+    }
+    return lit / 9.0;
+}
+
+#ifdef SCRATCH_CLUSTERED_LIGHTING
+vec3 CalcClusteredLights(vec3 normal, vec3 viewDir, vec3 diffuseColor, vec3 specularColor, float shininess)
+{
+    // same exponential depth slices as LightClusters::build
+    float viewDepth = -(view * vec4(FragPos, 1.0)).z;
+    uint slice = uint(max(log(viewDepth) * clusterDepthScale + clusterDepthBias, 0.0));
+    uvec3 cluster = min(uvec3(uvec2(gl_FragCoord.xy * clusterTileScale), slice), clusterGrid - 1u);
+    uvec2 range = clusterRanges[cluster.x + clusterGrid.x * (cluster.y + clusterGrid.y * cluster.z)];
+
+    vec3 result = vec3(0.0);
+    for (uint i = 0u; i < range.y; ++i) {
+        GpuLight light = lights[lightIndices[range.x + i]];
+        vec3 toLight = light.positionRange.xyz - FragPos;
+        float lightDistance = length(toLight);
+        vec3 lightDir = toLight / max(lightDistance, 0.0001);
+        // inverse square falloff windowed to reach 0 at the light's range
+        float window = clamp(1.0 - pow(lightDistance / light.positionRange.w, 4.0), 0.0, 1.0);
+        float attenuation = window * window / (1.0 + lightDistance * lightDistance);
+        float cosTheta = dot(-lightDir, light.directionCosOuter.xyz);
+        attenuation *= clamp((cosTheta - light.directionCosOuter.w) /
+                             (light.diffuseCosInner.w - light.directionCosOuter.w), 0.0, 1.0);
+
+        float diff = max(dot(normal, lightDir), 0.0);
+        result += light.diffuseCosInner.rgb * diff * diffuseColor * attenuation;
+#ifdef SPECULAR_MAP
+        vec3 halfwayDir = normalize(lightDir + viewDir);
+        float spec = pow(max(dot(normal, halfwayDir), 0.0), shininess);
+        result += light.specular.rgb * spec * specularColor * attenuation;
+#endif
+    }
+    return result;
+}
+#endif
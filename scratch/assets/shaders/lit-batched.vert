@@ -0,0 +1,93 @@
+#version 430 core
+// Multi-draw variant of lit.vert, per draw data comes from the DrawBuffer instead of uniforms
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in vec3 aTangent;
+layout (location = 4) in vec3 aBitangent;
+// index of this draw, sourced from the draw's base instance
+layout (location = 5) in uint aDrawIndex;
+#ifdef SCRATCH_SKINNING
+// joints every skinned vertex follows and how much, three uints a vertex, see GeometryPool::SKINNING_BINDING
+layout (std430, binding = 10) readonly buffer SkinningBuffer {
+    uint skinning[];
+};
+
+// every animated entity's skinning matrices, see AnimationSampler
+layout (std430, binding = 9) readonly buffer BonePalette {
+    mat4 bones[];
+};
+
+const uint NO_PALETTE = 0xFFFFFFFFu;
+#endif
+
+struct DrawData {
+    mat4 model;
+    uint materialIndex;
+    // first of the draw's matrices in the bone palette, NO_PALETTE when it isn't animated
+    uint paletteOffset;
+    // added to gl_VertexID to find the draw's vertices in skinning
+    int skinningOffset;
+};
+
+layout (std430, binding = 0) readonly buffer DrawBuffer {
+    DrawData draws[];
+};
+
+out vec2 TexCoords;
+out vec3 FragPos;
+out vec3 TangentViewPos;
+out vec3 TangentFragPos;
+#ifdef SCRATCH_CLUSTERED_LIGHTING
+// clustered lights are shaded in world space
+out mat3 TangentToWorld;
+#endif
+flat out uint MaterialIndex;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+uniform vec3 viewPos;
+
+// same position as the depth pre-pass, bit for bit, so the GL_EQUAL depth test passes
+invariant gl_Position;
+
+#ifdef SCRATCH_SKINNING
+// the same in every vertex shader, so the depth passes and shading still match bit for bit
+mat4 SkinMatrix(uint offset, int vertexOffset)
+{
+    uint vertex = uint(gl_VertexID + vertexOffset) * 3u;
+    uvec4 joints = uvec4(skinning[vertex] & 0xFFFFu, skinning[vertex] >> 16u,
+                         skinning[vertex + 1u] & 0xFFFFu, skinning[vertex + 1u] >> 16u) + offset;
+    vec4 weights = unpackUnorm4x8(skinning[vertex + 2u]);
+    return bones[joints.x] * weights.x + bones[joints.y] * weights.y +
+           bones[joints.z] * weights.z + bones[joints.w] * weights.w;
+}
+#endif
+
+void main()
+{
+    mat4 model = draws[aDrawIndex].model;
+    MaterialIndex = draws[aDrawIndex].materialIndex;
+#ifdef SCRATCH_SKINNING
+    if (draws[aDrawIndex].paletteOffset != NO_PALETTE) {
+        model = model * SkinMatrix(draws[aDrawIndex].paletteOffset, draws[aDrawIndex].skinningOffset);
+    }
+#endif
+
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    FragPos = vec3(model * vec4(aPos,1.0));
+    TexCoords = aTexCoord;
+
+    vec3 T = normalize(vec3(model * vec4(aTangent,   0.0)));
+    vec3 N = normalize(vec3(model * vec4(aNormal,    0.0)));
+    // re-orthogonalize T with respect to N
+    T = normalize(T - dot(T, N) * N);
+    vec3 B = cross(N, T);
+    mat3 TBN = mat3(T, B, N);
+    TangentViewPos  = TBN * viewPos;
+    TangentFragPos  = TBN * vec3(model * vec4(aPos, 0.0));
+#ifdef SCRATCH_CLUSTERED_LIGHTING
+    TangentToWorld = TBN;
+#endif
+}
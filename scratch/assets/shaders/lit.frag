@@ -1,4 +1,8 @@
 #version 400 core
+#ifdef SCRATCH_CLUSTERED_LIGHTING
+#extension GL_ARB_shader_storage_buffer_object : require
+#extension GL_ARB_shading_language_420pack : require
+#endif
 struct Material {
     sampler2D texture_diffuse1;
     sampler2D texture_specular1;
@@ -22,42 +26,157 @@ in vec3 TangentFragPos;
 
 uniform Material material;
 uniform DirectionalLight dirLight;
+uniform mat4 view;
+
+// Cascaded shadow maps for the directional light, see ShadowMaps
+uniform sampler2DArrayShadow shadowMap;
+uniform mat4 lightSpaceMatrices[4];
+uniform float cascadeSplits[4];
+uniform int cascadeCount;
+uniform float shadowTexelSize;
+
 uniform vec3 viewPos;
-uniform bool highlighted;
 uniform sampler2D texture_diffuse1;
+#ifdef SCRATCH_CLUSTERED_LIGHTING
+// Point and spot lights, see LightClusters. Point lights have a cutoff cosine below -1 so the spot falloff is 1.
+struct GpuLight {
+    vec4 positionRange;
+    vec4 directionCosOuter;
+    vec4 diffuseCosInner;
+    vec4 specular;
+};
+
+layout (std430, binding = 2) readonly buffer LightBuffer {
+    GpuLight lights[];
+};
+
+// offset into lightIndices and light count, per cluster
+layout (std430, binding = 3) readonly buffer ClusterBuffer {
+    uvec2 clusterRanges[];
+};
+
+layout (std430, binding = 4) readonly buffer LightIndexBuffer {
+    uint lightIndices[];
+};
+
+uniform uvec3 clusterGrid;
+uniform vec2 clusterTileScale;
+uniform float clusterDepthScale;
+uniform float clusterDepthBias;
+
+in mat3 TangentToWorld;
+#endif
 
 out vec4 FragColor;
 
-vec3 CalcDirLight(DirectionalLight light, vec3 normal, vec3 viewDir);
+vec3 CalcDirLight(DirectionalLight light, vec3 normal, vec3 viewDir, float shadow);
+float CalcShadow(vec3 worldPos);
+#ifdef SCRATCH_CLUSTERED_LIGHTING
+vec3 CalcClusteredLights(vec3 normal, vec3 viewDir, vec3 diffuseColor, vec3 specularColor, float shininess);
+#endif
 
 void main()
 {
-    // obtain normal from normal map in range [0,1]
-    vec3 normal = normalize(texture(material.texture_normal1, TexCoords).rgb);
-    normal = normalize(normal * 2.0 - 1.0);
+#ifdef NORMAL_MAP
+    // obtain normal from normal map in range [0,1], z is rebuilt so two channel (BC5) maps work too
+    vec2 normalXY = texture(material.texture_normal1, TexCoords).rg * 2.0 - 1.0;
+    vec3 normal = normalize(vec3(normalXY, sqrt(max(1.0 - dot(normalXY, normalXY), 0.0))));
+#else
+    // tangent space, so the unperturbed surface normal
+    vec3 normal = vec3(0.0, 0.0, 1.0);
+#endif
     vec3 viewDir = normalize(TangentViewPos - TangentFragPos);
 
-    vec3 result = CalcDirLight(dirLight, normal, viewDir);
+    vec3 result = CalcDirLight(dirLight, normal, viewDir, CalcShadow(FragPos));
+#ifdef SCRATCH_CLUSTERED_LIGHTING
+    result += CalcClusteredLights(normalize(TangentToWorld * normal), normalize(viewPos - FragPos),
+                                  vec3(texture(material.texture_diffuse1, TexCoords)),
+                                  vec3(texture(material.texture_specular1, TexCoords)), material.shininess);
+#endif
 
-    if(highlighted){
-        result += vec3(0,0.5f,0);
-    }
+#ifdef HIGHLIGHTED
+    result += vec3(0,0.5f,0);
+#endif
 
     FragColor = vec4(result,1);
 }
 
-vec3 CalcDirLight(DirectionalLight light, vec3 normal, vec3 viewDir)
+vec3 CalcDirLight(DirectionalLight light, vec3 normal, vec3 viewDir, float shadow)
 {
     vec3 lightDir = normalize(-light.direction);
     // diffuse shading
     float diff = max(dot(lightDir, normal), 0.0);
+    // combine results
+    vec3 ambient  = light.ambient  * vec3(texture(material.texture_diffuse1, TexCoords));
+    vec3 diffuse  = light.diffuse  * diff * shadow * vec3(texture(material.texture_diffuse1, TexCoords));
+#ifdef SPECULAR_MAP
     // specular shading
     vec3 halfwayDir = normalize(lightDir + viewDir);
     // Calculate Specular with Blinn-Phong
     float spec = pow(max(dot(normal, halfwayDir), 0.0),material.shininess);
-    // combine results
-    vec3 ambient  = light.ambient  * vec3(texture(material.texture_diffuse1, TexCoords));
-    vec3 diffuse  = light.diffuse  * diff * vec3(texture(material.texture_diffuse1, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.texture_specular1, TexCoords));
+    vec3 specular = light.specular * spec * shadow * vec3(texture(material.texture_specular1, TexCoords));
     return (ambient + diffuse + specular);
-}
\ No newline at end of file
+#else
+    return (ambient + diffuse);
+#endif
+}
+
+float CalcShadow(vec3 worldPos)
+{
+    // the first cascade reaching past the fragment's depth
+    float viewDepth = -(view * vec4(worldPos, 1.0)).z;
+    int cascade = 0;
+    while (cascade < cascadeCount && viewDepth > cascadeSplits[cascade]) {
+        ++cascade;
+    }
+    if (cascade >= cascadeCount) {
+        return 1.0;
+    }
+    vec4 lightSpacePos = lightSpaceMatrices[cascade] * vec4(worldPos, 1.0);
+    vec3 coords = lightSpacePos.xyz / lightSpacePos.w * 0.5 + 0.5;
+    if (coords.z > 1.0) {
+        return 1.0;
+    }
+    // PCF over 3x3 taps, each one already a filtered 2x2 comparison
+    float lit = 0.0;
+    for (int x = -1; x <= 1; ++x) {
+        for (int y = -1; y <= 1; ++y) {
+            lit += texture(shadowMap, vec4(coords.xy + vec2(x, y) * shadowTexelSize, float(cascade), coords.z));
+        }
+    }
+    return lit / 9.0;
+}
+
+#ifdef SCRATCH_CLUSTERED_LIGHTING
+vec3 CalcClusteredLights(vec3 normal, vec3 viewDir, vec3 diffuseColor, vec3 specularColor, float shininess)
+{
+    // same exponential depth slices as LightClusters::build
+    float viewDepth = -(view * vec4(FragPos, 1.0)).z;
+    uint slice = uint(max(log(viewDepth) * clusterDepthScale + clusterDepthBias, 0.0));
+    uvec3 cluster = min(uvec3(uvec2(gl_FragCoord.xy * clusterTileScale), slice), clusterGrid - 1u);
+    uvec2 range = clusterRanges[cluster.x + clusterGrid.x * (cluster.y + clusterGrid.y * cluster.z)];
+
+    vec3 result = vec3(0.0);
+    for (uint i = 0u; i < range.y; ++i) {
+        GpuLight light = lights[lightIndices[range.x + i]];
+        vec3 toLight = light.positionRange.xyz - FragPos;
+        float lightDistance = length(toLight);
+        vec3 lightDir = toLight / max(lightDistance, 0.0001);
+        // inverse square falloff windowed to reach 0 at the light's range
+        float window = clamp(1.0 - pow(lightDistance / light.positionRange.w, 4.0), 0.0, 1.0);
+        float attenuation = window * window / (1.0 + lightDistance * lightDistance);
+        float cosTheta = dot(-lightDir, light.directionCosOuter.xyz);
+        attenuation *= clamp((cosTheta - light.directionCosOuter.w) /
+                             (light.diffuseCosInner.w - light.directionCosOuter.w), 0.0, 1.0);
+
+        float diff = max(dot(normal, lightDir), 0.0);
+        result += light.diffuseCosInner.rgb * diff * diffuseColor * attenuation;
+#ifdef SPECULAR_MAP
+        vec3 halfwayDir = normalize(lightDir + viewDir);
+        float spec = pow(max(dot(normal, halfwayDir), 0.0), shininess);
+        result += light.specular.rgb * spec * specularColor * attenuation;
+#endif
+    }
+    return result;
+}
+#endif
@@ -1,4 +1,8 @@
 #version 400 core
+#ifdef SCRATCH_SKINNING
+#extension GL_ARB_shader_storage_buffer_object : require
+#extension GL_ARB_shading_language_420pack : require
+#endif
 // Input Vector3 as aPos at Location 0
 // Can also omit layout and use glGetAttribLocation()
 layout (location = 0) in vec3 aPos;
@@ -6,12 +10,33 @@ layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
 layout (location = 3) in vec3 aTangent;
 layout (location = 4) in vec3 aBitangent;
+#ifdef SCRATCH_SKINNING
+// joints every skinned vertex follows and how much, three uints a vertex, see GeometryPool::SKINNING_BINDING
+layout (std430, binding = 10) readonly buffer SkinningBuffer {
+    uint skinning[];
+};
+
+// every animated entity's skinning matrices, see AnimationSampler
+layout (std430, binding = 9) readonly buffer BonePalette {
+    mat4 bones[];
+};
+
+const uint NO_PALETTE = 0xFFFFFFFFu;
+// first of this draw's matrices in bones, NO_PALETTE when it isn't animated
+uniform uint paletteOffset;
+// added to gl_VertexID to find this draw's vertices in skinning
+uniform int skinningOffset;
+#endif
 // will be available in frag shader
 out vec2 TexCoords;
 out vec3 Normal;
 out vec3 FragPos;
 out vec3 TangentViewPos;
 out vec3 TangentFragPos;
+#ifdef SCRATCH_CLUSTERED_LIGHTING
+// clustered lights are shaded in world space
+out mat3 TangentToWorld;
+#endif
 
 uniform mat4 model;
 uniform mat4 view;
@@ -19,20 +44,45 @@ uniform mat4 projection;
 
 uniform vec3 viewPos;
 
+// same position as the depth pre-pass, bit for bit, so the GL_EQUAL depth test passes
+invariant gl_Position;
+
+#ifdef SCRATCH_SKINNING
+// the same in every vertex shader, so the depth passes and shading still match bit for bit
+mat4 SkinMatrix(uint offset, int vertexOffset)
+{
+    uint vertex = uint(gl_VertexID + vertexOffset) * 3u;
+    uvec4 joints = uvec4(skinning[vertex] & 0xFFFFu, skinning[vertex] >> 16u,
+                         skinning[vertex + 1u] & 0xFFFFu, skinning[vertex + 1u] >> 16u) + offset;
+    vec4 weights = unpackUnorm4x8(skinning[vertex + 2u]);
+    return bones[joints.x] * weights.x + bones[joints.y] * weights.y +
+           bones[joints.z] * weights.z + bones[joints.w] * weights.w;
+}
+#endif
+
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    mat4 skinnedModel = model;
+#ifdef SCRATCH_SKINNING
+    if (paletteOffset != NO_PALETTE) {
+        skinnedModel = model * SkinMatrix(paletteOffset, skinningOffset);
+    }
+#endif
+    gl_Position = projection * view * skinnedModel * vec4(aPos, 1.0);
     // Calculate Position in world space
-    FragPos = vec3(model * vec4(aPos,1.0));
+    FragPos = vec3(skinnedModel * vec4(aPos,1.0));
     TexCoords = aTexCoord;
 
-    vec3 T = normalize(vec3(model * vec4(aTangent,   0.0)));
-    vec3 N = normalize(vec3(model * vec4(aNormal,    0.0)));
+    vec3 T = normalize(vec3(skinnedModel * vec4(aTangent,   0.0)));
+    vec3 N = normalize(vec3(skinnedModel * vec4(aNormal,    0.0)));
     // re-orthogonalize T with respect to N
     T = normalize(T - dot(T, N) * N);
     // then retrieve perpendicular vector B with the cross product of T and N
     vec3 B = cross(N, T);
     mat3 TBN = mat3(T, B, N);
     TangentViewPos  = TBN * viewPos;
-    TangentFragPos  = TBN * vec3(model * vec4(aPos, 0.0));
+    TangentFragPos  = TBN * vec3(skinnedModel * vec4(aPos, 0.0));
+#ifdef SCRATCH_CLUSTERED_LIGHTING
+    TangentToWorld = TBN;
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,135 @@
+#version 400 core
+// The whole post-process chain in one pass over the HDR scene, see PostProcessChain:
+// upscale -> exposure -> tone mapping -> FXAA (optional) -> sRGB encoding
+in vec2 TexCoords;
+
+uniform sampler2D sceneColor;
+uniform vec2 sceneTexelSize;
+// the scene fills the bottom left of the target, this much of it in uv
+uniform vec2 sceneScale;
+uniform vec2 sceneMax;
+// output and scene resolution differ
+uniform bool upscale;
+uniform float exposure;
+// 0 Reinhard, 1 ACES
+uniform int toneMapper;
+
+out vec4 FragColor;
+
+vec3 ToneMap(vec3 color)
+{
+    if (toneMapper == 1) {
+        // Narkowicz's fit of the ACES filmic curve
+        return clamp((color * (2.51 * color + 0.03)) / (color * (2.43 * color + 0.59) + 0.14), 0.0, 1.0);
+    }
+    return color / (1.0 + color);
+}
+
+vec3 ReadScene(vec2 uv)
+{
+    return texture(sceneColor, min(uv, sceneMax)).rgb;
+}
+
+// Catmull-Rom in 9 bilinear fetches, each fetch landing between two texels weighs both at once
+vec3 ReadSceneCatmullRom(vec2 uv)
+{
+    vec2 samplePosition = uv / sceneTexelSize;
+    vec2 texelPosition1 = floor(samplePosition - 0.5) + 0.5;
+    vec2 f = samplePosition - texelPosition1;
+
+    vec2 w0 = f * (-0.5 + f * (1.0 - 0.5 * f));
+    vec2 w1 = 1.0 + f * f * (-2.5 + 1.5 * f);
+    vec2 w2 = f * (0.5 + f * (2.0 - 1.5 * f));
+    vec2 w3 = f * f * (-0.5 + 0.5 * f);
+    vec2 w12 = w1 + w2;
+
+    vec2 uv0 = (texelPosition1 - 1.0) * sceneTexelSize;
+    vec2 uv12 = (texelPosition1 + w2 / w12) * sceneTexelSize;
+    vec2 uv3 = (texelPosition1 + 2.0) * sceneTexelSize;
+
+    vec3 result = ReadScene(vec2(uv0.x, uv0.y)) * w0.x * w0.y +
+                  ReadScene(vec2(uv12.x, uv0.y)) * w12.x * w0.y +
+                  ReadScene(vec2(uv3.x, uv0.y)) * w3.x * w0.y +
+                  ReadScene(vec2(uv0.x, uv12.y)) * w0.x * w12.y +
+                  ReadScene(vec2(uv12.x, uv12.y)) * w12.x * w12.y +
+                  ReadScene(vec2(uv3.x, uv12.y)) * w3.x * w12.y +
+                  ReadScene(vec2(uv0.x, uv3.y)) * w0.x * w3.y +
+                  ReadScene(vec2(uv12.x, uv3.y)) * w12.x * w3.y +
+                  ReadScene(vec2(uv3.x, uv3.y)) * w3.x * w3.y;
+    // the negative lobes can overshoot below zero next to bright edges
+    return max(result, vec3(0.0));
+}
+
+// Tone mapped scene at uv, still linear. Bilinear, for the taps that only look for edges.
+vec3 SampleScene(vec2 uv)
+{
+    return ToneMap(ReadScene(uv) * exposure);
+}
+
+// Same but with the upscale filter, for the pixel's own color
+vec3 SampleSceneSharp(vec2 uv)
+{
+    return ToneMap((upscale ? ReadSceneCatmullRom(uv) : ReadScene(uv)) * exposure);
+}
+
+vec3 LinearToSrgb(vec3 color)
+{
+    return mix(color * 12.92, 1.055 * pow(color, vec3(1.0 / 2.4)) - 0.055, step(vec3(0.0031308), color));
+}
+
+#ifdef FXAA
+const float FXAA_SPAN_MAX = 8.0;
+const float FXAA_REDUCE_MUL = 1.0 / 8.0;
+const float FXAA_REDUCE_MIN = 1.0 / 128.0;
+// local contrast below which the pixel isn't on an edge
+const float FXAA_EDGE_THRESHOLD = 1.0 / 8.0;
+const float FXAA_EDGE_THRESHOLD_MIN = 1.0 / 16.0;
+
+// perceptual luma, edges are found on what the display shows rather than on linear values
+float Luma(vec3 color)
+{
+    return sqrt(dot(color, vec3(0.299, 0.587, 0.114)));
+}
+
+// Blurs along the edge through the pixel, found from the luma of its four diagonal neighbours
+vec3 Fxaa(vec2 uv)
+{
+    vec3 colorM = SampleSceneSharp(uv);
+    float lumaNW = Luma(SampleScene(uv + vec2(-1.0, -1.0) * sceneTexelSize));
+    float lumaNE = Luma(SampleScene(uv + vec2(1.0, -1.0) * sceneTexelSize));
+    float lumaSW = Luma(SampleScene(uv + vec2(-1.0, 1.0) * sceneTexelSize));
+    float lumaSE = Luma(SampleScene(uv + vec2(1.0, 1.0) * sceneTexelSize));
+    float lumaM = Luma(colorM);
+    float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+    float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+    if (lumaMax - lumaMin < max(FXAA_EDGE_THRESHOLD_MIN, lumaMax * FXAA_EDGE_THRESHOLD)) {
+        return colorM;
+    }
+
+    vec2 direction = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)), (lumaNW + lumaSW) - (lumaNE + lumaSE));
+    float directionReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * 0.25 * FXAA_REDUCE_MUL, FXAA_REDUCE_MIN);
+    float inverseDirectionMin = 1.0 / (min(abs(direction.x), abs(direction.y)) + directionReduce);
+    direction = clamp(direction * inverseDirectionMin, vec2(-FXAA_SPAN_MAX), vec2(FXAA_SPAN_MAX)) * sceneTexelSize;
+
+    vec3 colorA = 0.5 * (SampleScene(uv + direction * (1.0 / 3.0 - 0.5)) +
+                         SampleScene(uv + direction * (2.0 / 3.0 - 0.5)));
+    vec3 colorB = colorA * 0.5 + 0.25 * (SampleScene(uv - direction * 0.5) + SampleScene(uv + direction * 0.5));
+    // the wider blur crossed another edge, keep the narrow one
+    float lumaB = Luma(colorB);
+    if (lumaB < lumaMin || lumaB > lumaMax) {
+        return colorA;
+    }
+    return colorB;
+}
+#endif
+
+void main()
+{
+    vec2 uv = TexCoords * sceneScale;
+#ifdef FXAA
+    vec3 color = Fxaa(uv);
+#else
+    vec3 color = SampleSceneSharp(uv);
+#endif
+    FragColor = vec4(LinearToSrgb(color), 1.0);
+}
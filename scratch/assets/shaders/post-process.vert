@@ -0,0 +1,10 @@
+#version 400 core
+// One triangle covering the screen, positions made from gl_VertexID so no vertex buffer is needed
+out vec2 TexCoords;
+
+void main()
+{
+    vec2 position = vec2(float((gl_VertexID & 1) << 2) - 1.0, float((gl_VertexID & 2) << 1) - 1.0);
+    TexCoords = position * 0.5 + 0.5;
+    gl_Position = vec4(position, 0.0, 1.0);
+}
@@ -13,15 +13,14 @@ in vec3 vertexColor;
 in vec2 TexCoords;
 
 uniform Material material;
-uniform bool highlighted;
 
 out vec4 FragColor;
 
 void main()
 {
     vec4 color = texture(material.texture_diffuse1, TexCoords);
-    if(highlighted){
-        color += vec4(0,0.5f,0,0);
-    }
+#ifdef HIGHLIGHTED
+    color += vec4(0,0.5f,0,0);
+#endif
     FragColor = color;
 } 
\ No newline at end of file
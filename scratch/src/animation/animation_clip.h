@@ -0,0 +1,41 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace scratch {
+    // Keys for one joint, times in seconds and ascending. A component without keys keeps its bind pose value.
+    struct JointChannel {
+        std::vector<float> translationTimes;
+        std::vector<glm::vec3> translations;
+        std::vector<float> rotationTimes;
+        std::vector<glm::quat> rotations;
+        std::vector<float> scaleTimes;
+        std::vector<glm::vec3> scales;
+    };
+
+    // One animation of a skeleton, see Skeleton
+    struct AnimationClip {
+        std::string name;
+        // seconds
+        float duration = 0.0f;
+        // one per joint of the skeleton
+        std::vector<JointChannel> channels;
+    };
+
+    // Which of a renderable's clips an entity is playing and how far in
+    struct AnimationState {
+        // index into the renderable's animations, -1 for the bind pose
+        int clipIndex = -1;
+        // seconds into the clip
+        float time = 0.0f;
+        float speed = 1.0f;
+        // clips that don't loop hold their last frame
+        bool looping = true;
+    };
+}
@@ -0,0 +1,154 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include "animation_sampler.h"
+
+#include <algorithm>
+
+// Palette matrices are multiplied a column of four floats at a time where SSE is available
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SCRATCH_ANIMATION_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace {
+    // The key at or before time and how far towards the next key time is, clamped to the first and last key
+    size_t findKey(const std::vector<float> &times, float time, float &blend) {
+        blend = 0.0f;
+        auto next = std::upper_bound(times.begin(), times.end(), time);
+        if (next == times.begin()) {
+            return 0;
+        }
+        auto key = static_cast<size_t>(next - times.begin()) - 1;
+        if (next != times.end()) {
+            blend = (time - times[key]) / (times[key + 1] - times[key]);
+        }
+        return key;
+    }
+
+    glm::vec3 sampleKeys(const std::vector<float> &times, const std::vector<glm::vec3> &values, float time) {
+        float blend;
+        size_t key = findKey(times, time, blend);
+        return blend > 0.0f ? glm::mix(values[key], values[key + 1], blend) : values[key];
+    }
+
+    glm::quat sampleKeys(const std::vector<float> &times, const std::vector<glm::quat> &values, float time) {
+        float blend;
+        size_t key = findKey(times, time, blend);
+        return blend > 0.0f ? glm::slerp(values[key], values[key + 1], blend) : values[key];
+    }
+
+    glm::mat4 composeTransform(const glm::vec3 &translation, const glm::quat &rotation, const glm::vec3 &scale) {
+        glm::mat4 transform = glm::mat4_cast(rotation);
+        transform[0] *= scale.x;
+        transform[1] *= scale.y;
+        transform[2] *= scale.z;
+        transform[3] = glm::vec4(translation, 1.0f);
+        return transform;
+    }
+
+    // result = a * b, result may be either of them
+    void multiply(const glm::mat4 &a, const glm::mat4 &b, glm::mat4 &result) {
+#ifdef SCRATCH_ANIMATION_SSE
+        __m128 a0 = _mm_loadu_ps(&a[0][0]);
+        __m128 a1 = _mm_loadu_ps(&a[1][0]);
+        __m128 a2 = _mm_loadu_ps(&a[2][0]);
+        __m128 a3 = _mm_loadu_ps(&a[3][0]);
+        // each column of the result is a's columns weighted by the same column of b, which is only read
+        // before that column is stored
+        for (int column = 0; column < 4; ++column) {
+            const float *weights = &b[column][0];
+            __m128 sum = _mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(weights[0])), _mm_mul_ps(a1, _mm_set1_ps(weights[1])));
+            sum = _mm_add_ps(sum, _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(weights[2])),
+                                             _mm_mul_ps(a3, _mm_set1_ps(weights[3]))));
+            _mm_storeu_ps(&result[column][0], sum);
+        }
+#else
+        result = a * b;
+#endif
+    }
+}
+
+void scratch::AnimationSampler::sample(const std::vector<AnimationInstance> &instances, PoseBuffer &poses,
+                                       std::vector<glm::mat4> &palette, std::vector<Bounds> &poseBounds,
+                                       JobSystem &jobSystem) {
+    uint32_t jointCount = getJointCount(instances);
+    poses.resize(jointCount);
+    palette.resize(jointCount);
+    poseBounds.resize(instances.size());
+    // every instance writes only its own slices, so they need no synchronization
+    jobSystem.parallelFor(instances.size(), [&](size_t i) {
+        samplePose(instances[i], poses);
+        poseBounds[i] = computePalette(instances[i], poses, palette.data() + instances[i].firstJoint);
+    });
+}
+
+void scratch::AnimationSampler::samplePose(const AnimationInstance &instance, PoseBuffer &poses) {
+    const Skeleton &skeleton = *instance.skeleton;
+    const size_t jointCount = skeleton.getJointCount();
+    const AnimationClip *clip = instance.clip;
+    const float time = instance.time;
+    glm::vec3 *translations = poses.translations.data() + instance.firstJoint;
+    glm::quat *rotations = poses.rotations.data() + instance.firstJoint;
+    glm::vec3 *scales = poses.scales.data() + instance.firstJoint;
+
+    // one component at a time, so each pass only reads one key list per joint
+    for (size_t joint = 0; joint < jointCount; ++joint) {
+        const JointChannel *channel = clip != nullptr ? &clip->channels[joint] : nullptr;
+        translations[joint] = channel != nullptr && !channel->translations.empty()
+                              ? sampleKeys(channel->translationTimes, channel->translations, time)
+                              : skeleton.bindPose[joint].translation;
+    }
+    for (size_t joint = 0; joint < jointCount; ++joint) {
+        const JointChannel *channel = clip != nullptr ? &clip->channels[joint] : nullptr;
+        rotations[joint] = channel != nullptr && !channel->rotations.empty()
+                           ? sampleKeys(channel->rotationTimes, channel->rotations, time)
+                           : skeleton.bindPose[joint].rotation;
+    }
+    for (size_t joint = 0; joint < jointCount; ++joint) {
+        const JointChannel *channel = clip != nullptr ? &clip->channels[joint] : nullptr;
+        scales[joint] = channel != nullptr && !channel->scales.empty()
+                        ? sampleKeys(channel->scaleTimes, channel->scales, time)
+                        : skeleton.bindPose[joint].scale;
+    }
+}
+
+scratch::Bounds scratch::AnimationSampler::computePalette(const AnimationInstance &instance, const PoseBuffer &poses,
+                                                          glm::mat4 *palette) {
+    const Skeleton &skeleton = *instance.skeleton;
+    const size_t jointCount = skeleton.getJointCount();
+    const glm::vec3 *translations = poses.translations.data() + instance.firstJoint;
+    const glm::quat *rotations = poses.rotations.data() + instance.firstJoint;
+    const glm::vec3 *scales = poses.scales.data() + instance.firstJoint;
+
+    // model space transforms first, parents are earlier in the palette so theirs are always done
+    Bounds bounds;
+    bool hasJointBounds = skeleton.jointBounds.size() == jointCount;
+    for (size_t joint = 0; joint < jointCount; ++joint) {
+        glm::mat4 local = composeTransform(translations[joint], rotations[joint], scales[joint]);
+        int parent = skeleton.parents[joint];
+        multiply(parent >= 0 ? palette[parent] : skeleton.rootTransform, local, palette[joint]);
+        if (!hasJointBounds) {
+            // nothing known about the vertices, the joints themselves are the best there is
+            bounds.encapsulate(glm::vec3(palette[joint][3]));
+        }
+    }
+    // then every joint's inverse bind, taking a vertex from where it was modelled to where the joint is now
+    for (size_t joint = 0; joint < jointCount; ++joint) {
+        multiply(palette[joint], skeleton.inverseBindMatrices[joint], palette[joint]);
+        if (hasJointBounds && !skeleton.jointBounds[joint].isEmpty()) {
+            Bounds posed = skeleton.jointBounds[joint].transform(palette[joint]);
+            bounds.encapsulate(posed.getMin());
+            bounds.encapsulate(posed.getMax());
+        }
+    }
+    return bounds;
+}
+
+uint32_t scratch::AnimationSampler::getJointCount(const std::vector<AnimationInstance> &instances) {
+    if (instances.empty()) {
+        return 0;
+    }
+    return instances.back().firstJoint + static_cast<uint32_t>(instances.back().skeleton->getJointCount());
+}
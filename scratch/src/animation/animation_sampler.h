@@ -0,0 +1,62 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "animation/animation_clip.h"
+#include "animation/skeleton.h"
+#include "graphics/bounds.h"
+#include "threading/job_system.h"
+
+namespace scratch {
+    // Local joint transforms of every skeleton being posed, back to back. One array per component so sampling
+    // streams through each of them once.
+    struct PoseBuffer {
+        std::vector<glm::vec3> translations;
+        std::vector<glm::quat> rotations;
+        std::vector<glm::vec3> scales;
+
+        void resize(size_t jointCount) {
+            translations.resize(jointCount);
+            rotations.resize(jointCount);
+            scales.resize(jointCount);
+        }
+    };
+
+    // A skeleton to pose this frame and where its joints go in the pose buffer and the palette
+    struct AnimationInstance {
+        const Skeleton *skeleton;
+        // nullptr for the bind pose
+        const AnimationClip *clip;
+        // seconds into the clip
+        float time;
+        uint32_t firstJoint;
+    };
+
+    // Turns clips into skinning matrices for the vertex shaders
+    class AnimationSampler {
+    public:
+        // Samples and builds the palette of every instance, instances spread across the job system. The palette
+        // gets one matrix per joint from each instance's firstJoint on, poseBounds the model space box around
+        // each instance's posed vertices, see computePalette.
+        static void sample(const std::vector<AnimationInstance> &instances, PoseBuffer &poses,
+                           std::vector<glm::mat4> &palette, std::vector<Bounds> &poseBounds,
+                           JobSystem &jobSystem);
+
+        // The instance's local joint transforms at its time, written to its slice of poses
+        static void samplePose(const AnimationInstance &instance, PoseBuffer &poses);
+
+        // Skinning matrices from the instance's sampled pose, taking vertices from the bind pose to the posed
+        // joints. Returns the box around the posed vertices from the skeleton's joint bounds, or around the posed
+        // joints for a skeleton without them.
+        static Bounds computePalette(const AnimationInstance &instance, const PoseBuffer &poses, glm::mat4 *palette);
+
+        // Joints the instances need in total, where the next instance's firstJoint goes
+        static uint32_t getJointCount(const std::vector<AnimationInstance> &instances);
+    };
+}
@@ -0,0 +1,40 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "graphics/bounds.h"
+
+namespace scratch {
+    // A joint relative to its parent
+    struct JointTransform {
+        glm::vec3 translation;
+        glm::quat rotation;
+        glm::vec3 scale;
+    };
+
+    // The joint hierarchy a model's meshes are skinned to, every array indexed by joint
+    struct Skeleton {
+        std::vector<std::string> jointNames;
+        // parents always come before their children, -1 for a root
+        std::vector<int> parents;
+        // what joints the playing clip has no keys for hold
+        std::vector<JointTransform> bindPose;
+        // mesh space to the joint's space at bind time, identity for joints no vertex is weighted to
+        std::vector<glm::mat4> inverseBindMatrices;
+        // applied above the roots, undoes the scene root's transform the unskinned meshes never get either
+        glm::mat4 rootTransform = glm::mat4(1.0f);
+        // mesh space box around the vertices following each joint at bind time, empty for joints none follow.
+        // A skinned vertex is a blend of its joints' transforms of it, so it stays inside their posed boxes.
+        std::vector<Bounds> jointBounds;
+
+        size_t getJointCount() const {
+            return parents.size();
+        }
+    };
+}
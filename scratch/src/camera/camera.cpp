@@ -21,10 +21,14 @@ glm::mat4 scratch::Camera::getProjectionMatrix() const {
     return glm::perspective<double>(glm::radians(_fieldOfView), aspectRatio, _nearPlane, _farPlane);
 }
 
-const glm::vec3 &scratch::Camera::getPosition() {
+const glm::vec3 &scratch::Camera::getPosition() const {
     return _position;
 }
 
+float scratch::Camera::getFieldOfView() const {
+    return _fieldOfView;
+}
+
 // Processes input received from any keyboard-like input system. Accepts input parameter in the form of camera defined ENUM (to abstract it from windowing systems)
 void scratch::Camera::processKeyboard(CameraMovement direction, float deltaTime) {
     float velocity = _movementSpeed * deltaTime;
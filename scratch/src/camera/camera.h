@@ -47,7 +47,9 @@ namespace scratch {
 
         glm::mat4 getProjectionMatrix() const;
 
-        const glm::vec3 &getPosition();
+        const glm::vec3 &getPosition() const;
+
+        float getFieldOfView() const;
 
         // Processes input received from any keyboard-like input system. Accepts input parameter in the form of camera defined ENUM (to abstract it from windowing systems)
         void processKeyboard(CameraMovement direction, float deltaTime);
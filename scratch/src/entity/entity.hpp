@@ -2,8 +2,11 @@
 
 #include <stdlib.h>
 #include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <utility>
+#include "animation/animation_clip.h"
 #include "graphics/renderable.h"
 #include "graphics/model.h"
 
@@ -12,6 +15,7 @@ namespace scratch {
     private:
         unsigned int _id;
         std::shared_ptr<scratch::Renderable> _renderable;
+        scratch::AnimationState _animationState;
 
     public:
         Entity(const unsigned int id, std::shared_ptr<scratch::Renderable> renderable) {
@@ -23,10 +27,48 @@ namespace scratch {
             return _id;
         }
 
-        std::shared_ptr<scratch::Renderable> getRenderable() {
+        // by reference, many nodes share a renderable and copies would contend on its count across threads
+        const std::shared_ptr<scratch::Renderable> &getRenderable() const {
             return _renderable;
         }
 
+        // Plays one of the renderable's animations from the start, -1 goes back to the bind pose
+        void playAnimation(int clipIndex, bool looping = true) {
+            _animationState.clipIndex = clipIndex;
+            _animationState.time = 0.0f;
+            _animationState.looping = looping;
+        }
+
+        void setAnimationSpeed(float speed) {
+            _animationState.speed = speed;
+        }
+
+        const scratch::AnimationState &getAnimationState() const {
+            return _animationState;
+        }
+
+        // Moves the playing clip along, looping clips wrap around and the rest stop at their ends
+        void advanceAnimation(float deltaTime) {
+            const std::vector<scratch::AnimationClip> &animations = _renderable->getAnimations();
+            if (_animationState.clipIndex < 0 || _animationState.clipIndex >= static_cast<int>(animations.size())) {
+                return;
+            }
+            float duration = animations[_animationState.clipIndex].duration;
+            if (duration <= 0.0f) {
+                _animationState.time = 0.0f;
+                return;
+            }
+            _animationState.time += deltaTime * _animationState.speed;
+            if (_animationState.looping) {
+                _animationState.time = std::fmod(_animationState.time, duration);
+                if (_animationState.time < 0.0f) {
+                    _animationState.time += duration;
+                }
+            } else {
+                _animationState.time = std::clamp(_animationState.time, 0.0f, duration);
+            }
+        }
+
         void serialize(rapidjson::PrettyWriter<rapidjson::StringBuffer> &writer) {
             writer.StartObject();
 
@@ -34,6 +76,10 @@ namespace scratch {
             writer.Uint(_id);
             writer.String("renderableId");
             writer.Uint(_renderable->getId());
+            writer.String("animationClip");
+            writer.Int(_animationState.clipIndex);
+            writer.String("animationSpeed");
+            writer.Double(_animationState.speed);
 
             writer.EndObject();
         }
@@ -0,0 +1,394 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "bc_encoder.h"
+
+namespace {
+    const int BLOCK_PIXELS = 16;
+    const int BC7_WEIGHTS[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    // Dominant direction of a set of points, found by power iteration on their covariance
+    template<int N>
+    void principalAxis(const uint8_t *block, int firstChannel, float *mean, float *axis) {
+        float covariance[N][N] = {};
+        for (int c = 0; c < N; ++c) {
+            mean[c] = 0.0f;
+            for (int i = 0; i < BLOCK_PIXELS; ++i) {
+                mean[c] += block[i * 4 + firstChannel + c];
+            }
+            mean[c] /= BLOCK_PIXELS;
+        }
+        for (int i = 0; i < BLOCK_PIXELS; ++i) {
+            for (int row = 0; row < N; ++row) {
+                for (int column = 0; column < N; ++column) {
+                    covariance[row][column] += (block[i * 4 + firstChannel + row] - mean[row]) *
+                                               (block[i * 4 + firstChannel + column] - mean[column]);
+                }
+            }
+        }
+        for (int c = 0; c < N; ++c) {
+            axis[c] = 1.0f;
+        }
+        for (int iteration = 0; iteration < 8; ++iteration) {
+            float next[N] = {};
+            float length = 0.0f;
+            for (int row = 0; row < N; ++row) {
+                for (int column = 0; column < N; ++column) {
+                    next[row] += covariance[row][column] * axis[column];
+                }
+                length += next[row] * next[row];
+            }
+            length = std::sqrt(length);
+            if (length < 1e-6f) {
+                // flat block, every axis is as good as any other
+                return;
+            }
+            for (int c = 0; c < N; ++c) {
+                axis[c] = next[c] / length;
+            }
+        }
+    }
+
+    // Endpoints at the extremes of the block projected onto its principal axis
+    template<int N>
+    void fitEndpoints(const uint8_t *block, int firstChannel, float *low, float *high) {
+        float mean[N];
+        float axis[N];
+        principalAxis<N>(block, firstChannel, mean, axis);
+        float minProjection = std::numeric_limits<float>::max();
+        float maxProjection = std::numeric_limits<float>::lowest();
+        for (int i = 0; i < BLOCK_PIXELS; ++i) {
+            float projection = 0.0f;
+            for (int c = 0; c < N; ++c) {
+                projection += (block[i * 4 + firstChannel + c] - mean[c]) * axis[c];
+            }
+            minProjection = std::min(minProjection, projection);
+            maxProjection = std::max(maxProjection, projection);
+        }
+        for (int c = 0; c < N; ++c) {
+            low[c] = std::clamp(mean[c] + axis[c] * minProjection, 0.0f, 255.0f);
+            high[c] = std::clamp(mean[c] + axis[c] * maxProjection, 0.0f, 255.0f);
+        }
+    }
+
+    uint16_t packRgb565(const float *color) {
+        auto r = static_cast<uint16_t>(std::lround(color[0] * 31.0f / 255.0f));
+        auto g = static_cast<uint16_t>(std::lround(color[1] * 63.0f / 255.0f));
+        auto b = static_cast<uint16_t>(std::lround(color[2] * 31.0f / 255.0f));
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    void unpackRgb565(uint16_t packed, int *color) {
+        int r = (packed >> 11) & 31;
+        int g = (packed >> 5) & 63;
+        int b = packed & 31;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+
+    // Picks the closest of the four palette entries for every pixel, returns the summed squared error.
+    // Expects color0 > color1 so the block decodes in four color mode.
+    int chooseBc1Indices(const uint8_t *block, uint16_t color0, uint16_t color1, uint8_t *indices) {
+        int palette[4][3];
+        unpackRgb565(color0, palette[0]);
+        unpackRgb565(color1, palette[1]);
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        int totalError = 0;
+        for (int i = 0; i < BLOCK_PIXELS; ++i) {
+            int bestError = std::numeric_limits<int>::max();
+            for (int entry = 0; entry < 4; ++entry) {
+                int error = 0;
+                for (int c = 0; c < 3; ++c) {
+                    int difference = block[i * 4 + c] - palette[entry][c];
+                    error += difference * difference;
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    indices[i] = static_cast<uint8_t>(entry);
+                }
+            }
+            totalError += bestError;
+        }
+        return totalError;
+    }
+
+    // Least squares endpoints for a fixed set of indices
+    bool refineBc1Endpoints(const uint8_t *block, const uint8_t *indices, float *high, float *low) {
+        const float highWeights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        float ax[3] = {}, bx[3] = {};
+        for (int i = 0; i < BLOCK_PIXELS; ++i) {
+            float a = highWeights[indices[i]];
+            float b = 1.0f - a;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (int c = 0; c < 3; ++c) {
+                ax[c] += a * block[i * 4 + c];
+                bx[c] += b * block[i * 4 + c];
+            }
+        }
+        float determinant = aa * bb - ab * ab;
+        if (std::abs(determinant) < 1e-6f) {
+            return false;
+        }
+        for (int c = 0; c < 3; ++c) {
+            high[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.0f, 255.0f);
+            low[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.0f, 255.0f);
+        }
+        return true;
+    }
+
+    void writeBc1(uint16_t color0, uint16_t color1, const uint8_t *indices, uint8_t *output) {
+        uint32_t packedIndices = 0;
+        for (int i = 0; i < BLOCK_PIXELS; ++i) {
+            packedIndices |= static_cast<uint32_t>(indices[i]) << (i * 2);
+        }
+        output[0] = static_cast<uint8_t>(color0 & 0xFF);
+        output[1] = static_cast<uint8_t>(color0 >> 8);
+        output[2] = static_cast<uint8_t>(color1 & 0xFF);
+        output[3] = static_cast<uint8_t>(color1 >> 8);
+        for (int i = 0; i < 4; ++i) {
+            output[4 + i] = static_cast<uint8_t>(packedIndices >> (i * 8));
+        }
+    }
+
+    // Endpoints packed as 565, ordered for four color mode. Returns false if they collapse to a single color.
+    bool orderBc1Endpoints(const float *high, const float *low, uint16_t &color0, uint16_t &color1) {
+        color0 = packRgb565(high);
+        color1 = packRgb565(low);
+        if (color0 < color1) {
+            std::swap(color0, color1);
+        }
+        return color0 != color1;
+    }
+
+    // Writes values LSB first into a 128 bit block
+    class BitWriter {
+    public:
+        explicit BitWriter(uint8_t *output) : _output(output) {
+            std::memset(_output, 0, 16);
+        }
+
+        void write(uint32_t value, int bitCount) {
+            for (int bit = 0; bit < bitCount; ++bit) {
+                if (value & (1u << bit)) {
+                    _output[_position >> 3] |= static_cast<uint8_t>(1u << (_position & 7));
+                }
+                _position++;
+            }
+        }
+
+    private:
+        uint8_t *_output;
+        int _position = 0;
+    };
+}
+
+size_t scratch::BcEncoder::getBlockSize(BlockFormat format) {
+    return format == BC1 ? 8 : 16;
+}
+
+size_t scratch::BcEncoder::getCompressedSize(BlockFormat format, int width, int height) {
+    size_t blocksWide = std::max(1, (width + 3) / 4);
+    size_t blocksHigh = std::max(1, (height + 3) / 4);
+    return blocksWide * blocksHigh * getBlockSize(format);
+}
+
+std::vector<uint8_t> scratch::BcEncoder::encode(BlockFormat format, const uint8_t *rgba, int width, int height) {
+    std::vector<uint8_t> output(getCompressedSize(format, width, height));
+    size_t blockSize = getBlockSize(format);
+    int blocksWide = std::max(1, (width + 3) / 4);
+    int blocksHigh = std::max(1, (height + 3) / 4);
+
+    uint8_t block[BLOCK_PIXELS * 4];
+    for (int blockY = 0; blockY < blocksHigh; ++blockY) {
+        for (int blockX = 0; blockX < blocksWide; ++blockX) {
+            for (int y = 0; y < 4; ++y) {
+                int sourceY = std::min(blockY * 4 + y, height - 1);
+                for (int x = 0; x < 4; ++x) {
+                    int sourceX = std::min(blockX * 4 + x, width - 1);
+                    std::memcpy(&block[(y * 4 + x) * 4], &rgba[(static_cast<size_t>(sourceY) * width + sourceX) * 4], 4);
+                }
+            }
+
+            uint8_t *destination = &output[(static_cast<size_t>(blockY) * blocksWide + blockX) * blockSize];
+            switch (format) {
+                case BC1:
+                    encodeBc1Block(block, destination);
+                    break;
+                case BC3:
+                    encodeBc4Block(block, 3, destination);
+                    encodeBc1Block(block, destination + 8);
+                    break;
+                case BC5:
+                    encodeBc4Block(block, 0, destination);
+                    encodeBc4Block(block, 1, destination + 8);
+                    break;
+                case BC7:
+                    encodeBc7Block(block, destination);
+                    break;
+            }
+        }
+    }
+    return output;
+}
+
+void scratch::BcEncoder::encodeBc1Block(const uint8_t *block, uint8_t *output) {
+    float high[3];
+    float low[3];
+    fitEndpoints<3>(block, 0, low, high);
+
+    uint8_t indices[BLOCK_PIXELS] = {};
+    uint16_t color0;
+    uint16_t color1;
+    if (!orderBc1Endpoints(high, low, color0, color1)) {
+        writeBc1(color0, color1, indices, output);
+        return;
+    }
+    int error = chooseBc1Indices(block, color0, color1, indices);
+
+    // one least squares pass usually beats the bounding endpoints
+    float refinedHigh[3];
+    float refinedLow[3];
+    uint16_t refinedColor0;
+    uint16_t refinedColor1;
+    uint8_t refinedIndices[BLOCK_PIXELS];
+    if (refineBc1Endpoints(block, indices, refinedHigh, refinedLow) &&
+        orderBc1Endpoints(refinedHigh, refinedLow, refinedColor0, refinedColor1) &&
+        chooseBc1Indices(block, refinedColor0, refinedColor1, refinedIndices) < error) {
+        color0 = refinedColor0;
+        color1 = refinedColor1;
+        std::memcpy(indices, refinedIndices, sizeof(indices));
+    }
+    writeBc1(color0, color1, indices, output);
+}
+
+void scratch::BcEncoder::encodeBc4Block(const uint8_t *block, int channel, uint8_t *output) {
+    int high = 0;
+    int low = 255;
+    for (int i = 0; i < BLOCK_PIXELS; ++i) {
+        high = std::max(high, static_cast<int>(block[i * 4 + channel]));
+        low = std::min(low, static_cast<int>(block[i * 4 + channel]));
+    }
+
+    std::memset(output, 0, 8);
+    output[0] = static_cast<uint8_t>(high);
+    output[1] = static_cast<uint8_t>(low);
+    if (high == low) {
+        return;
+    }
+
+    // high > low selects the eight value mode
+    int palette[8] = {high, low};
+    for (int i = 2; i < 8; ++i) {
+        palette[i] = ((8 - i) * high + (i - 1) * low) / 7;
+    }
+    uint64_t packedIndices = 0;
+    for (int i = 0; i < BLOCK_PIXELS; ++i) {
+        int value = block[i * 4 + channel];
+        int bestEntry = 0;
+        int bestError = std::numeric_limits<int>::max();
+        for (int entry = 0; entry < 8; ++entry) {
+            int error = std::abs(value - palette[entry]);
+            if (error < bestError) {
+                bestError = error;
+                bestEntry = entry;
+            }
+        }
+        packedIndices |= static_cast<uint64_t>(bestEntry) << (i * 3);
+    }
+    for (int i = 0; i < 6; ++i) {
+        output[2 + i] = static_cast<uint8_t>(packedIndices >> (i * 8));
+    }
+}
+
+void scratch::BcEncoder::encodeBc7Block(const uint8_t *block, uint8_t *output) {
+    float low[4];
+    float high[4];
+    fitEndpoints<4>(block, 0, low, high);
+
+    // Mode 6: one subset, 7 bit RGBA endpoints each with a shared low bit, 4 bit indices.
+    // Try every combination of those low bits and keep the closest.
+    int bestError = std::numeric_limits<int>::max();
+    int bestEndpoints[2][4] = {};
+    int bestPBits[2] = {};
+    uint8_t bestIndices[BLOCK_PIXELS] = {};
+    for (int pBits = 0; pBits < 4; ++pBits) {
+        int p[2] = {pBits & 1, pBits >> 1};
+        int endpoints[2][4];
+        int expanded[2][4];
+        for (int c = 0; c < 4; ++c) {
+            endpoints[0][c] = std::clamp(static_cast<int>(std::lround((low[c] - p[0]) / 2.0f)), 0, 127);
+            endpoints[1][c] = std::clamp(static_cast<int>(std::lround((high[c] - p[1]) / 2.0f)), 0, 127);
+            expanded[0][c] = (endpoints[0][c] << 1) | p[0];
+            expanded[1][c] = (endpoints[1][c] << 1) | p[1];
+        }
+        int palette[16][4];
+        for (int entry = 0; entry < 16; ++entry) {
+            for (int c = 0; c < 4; ++c) {
+                palette[entry][c] = ((64 - BC7_WEIGHTS[entry]) * expanded[0][c] +
+                                     BC7_WEIGHTS[entry] * expanded[1][c] + 32) >> 6;
+            }
+        }
+
+        int totalError = 0;
+        uint8_t indices[BLOCK_PIXELS];
+        for (int i = 0; i < BLOCK_PIXELS && totalError < bestError; ++i) {
+            int pixelError = std::numeric_limits<int>::max();
+            for (int entry = 0; entry < 16; ++entry) {
+                int error = 0;
+                for (int c = 0; c < 4; ++c) {
+                    int difference = block[i * 4 + c] - palette[entry][c];
+                    error += difference * difference;
+                }
+                if (error < pixelError) {
+                    pixelError = error;
+                    indices[i] = static_cast<uint8_t>(entry);
+                }
+            }
+            totalError += pixelError;
+        }
+        if (totalError < bestError) {
+            bestError = totalError;
+            std::memcpy(bestEndpoints, endpoints, sizeof(endpoints));
+            bestPBits[0] = p[0];
+            bestPBits[1] = p[1];
+            std::memcpy(bestIndices, indices, sizeof(indices));
+        }
+    }
+
+    // The first index only stores 3 bits, so its top bit has to be zero
+    if (bestIndices[0] & 8) {
+        for (int c = 0; c < 4; ++c) {
+            std::swap(bestEndpoints[0][c], bestEndpoints[1][c]);
+        }
+        std::swap(bestPBits[0], bestPBits[1]);
+        for (auto &index : bestIndices) {
+            index = static_cast<uint8_t>(15 - index);
+        }
+    }
+
+    BitWriter writer(output);
+    writer.write(1u << 6, 7);
+    for (int c = 0; c < 4; ++c) {
+        writer.write(bestEndpoints[0][c], 7);
+        writer.write(bestEndpoints[1][c], 7);
+    }
+    writer.write(bestPBits[0], 1);
+    writer.write(bestPBits[1], 1);
+    writer.write(bestIndices[0], 3);
+    for (int i = 1; i < BLOCK_PIXELS; ++i) {
+        writer.write(bestIndices[i], 4);
+    }
+}
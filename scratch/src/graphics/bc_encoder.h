@@ -0,0 +1,49 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace scratch {
+    enum BlockFormat {
+        // RGB, 1 bit alpha ignored, 8 bytes per block
+        BC1,
+        // RGB + interpolated alpha, 16 bytes per block
+        BC3,
+        // two independent channels, used for tangent space normals
+        BC5,
+        // RGBA, mode 6 only, 16 bytes per block
+        BC7
+    };
+    const std::map<BlockFormat, std::string> BLOCK_FORMAT_TO_STRING{{BC1, "bc1"},
+                                                                    {BC3, "bc3"},
+                                                                    {BC5, "bc5"},
+                                                                    {BC7, "bc7"}};
+    const std::map<std::string, BlockFormat> STRING_TO_BLOCK_FORMAT{{"bc1", BC1},
+                                                                    {"bc3", BC3},
+                                                                    {"bc5", BC5},
+                                                                    {"bc7", BC7}};
+
+    // CPU block compressor for cooking textures offline, doesn't touch the GPU
+    class BcEncoder {
+    public:
+        static size_t getBlockSize(BlockFormat format);
+
+        static size_t getCompressedSize(BlockFormat format, int width, int height);
+
+        // Compresses tightly packed 8 bit RGBA pixels, edge blocks repeat the last row and column
+        static std::vector<uint8_t> encode(BlockFormat format, const uint8_t *rgba, int width, int height);
+
+    private:
+        static void encodeBc1Block(const uint8_t *block, uint8_t *output);
+
+        static void encodeBc4Block(const uint8_t *block, int channel, uint8_t *output);
+
+        static void encodeBc7Block(const uint8_t *block, uint8_t *output);
+    };
+}
@@ -0,0 +1,69 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include <cmath>
+#include <limits>
+
+#include "bounds.h"
+
+scratch::Bounds::Bounds() : _min(glm::vec3(std::numeric_limits<float>::max())),
+                            _max(glm::vec3(std::numeric_limits<float>::lowest())) {}
+
+scratch::Bounds::Bounds(const glm::vec3 &min, const glm::vec3 &max) : _min(min), _max(max) {}
+
+scratch::Bounds scratch::Bounds::fromPoints(const std::vector<glm::vec3> &points) {
+    Bounds bounds;
+    for (const auto &point : points) {
+        bounds.encapsulate(point);
+    }
+    return bounds;
+}
+
+void scratch::Bounds::encapsulate(const glm::vec3 &point) {
+    _min = glm::min(_min, point);
+    _max = glm::max(_max, point);
+}
+
+bool scratch::Bounds::isEmpty() const {
+    return _min.x > _max.x || _min.y > _max.y || _min.z > _max.z;
+}
+
+const glm::vec3 &scratch::Bounds::getMin() const {
+    return _min;
+}
+
+const glm::vec3 &scratch::Bounds::getMax() const {
+    return _max;
+}
+
+glm::vec3 scratch::Bounds::getCenter() const {
+    return (_min + _max) * 0.5f;
+}
+
+glm::vec3 scratch::Bounds::getExtents() const {
+    return (_max - _min) * 0.5f;
+}
+
+float scratch::Bounds::getRadius() const {
+    if (isEmpty()) {
+        return 0.0f;
+    }
+    return glm::length(getExtents());
+}
+
+scratch::Bounds scratch::Bounds::transform(const glm::mat4 &matrix) const {
+    if (isEmpty()) {
+        return *this;
+    }
+    // Arvo's method: project the extents onto each axis of the transformed frame
+    glm::vec3 center = glm::vec3(matrix * glm::vec4(getCenter(), 1.0f));
+    glm::vec3 extents = getExtents();
+    glm::vec3 newExtents = glm::vec3(0.0f);
+    for (int column = 0; column < 3; ++column) {
+        for (int row = 0; row < 3; ++row) {
+            newExtents[row] += std::abs(matrix[column][row]) * extents[column];
+        }
+    }
+    return Bounds(center - newExtents, center + newExtents);
+}
@@ -0,0 +1,41 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace scratch {
+    // Axis aligned bounding box
+    class Bounds {
+    public:
+        Bounds();
+
+        Bounds(const glm::vec3 &min, const glm::vec3 &max);
+
+        static Bounds fromPoints(const std::vector<glm::vec3> &points);
+
+        void encapsulate(const glm::vec3 &point);
+
+        bool isEmpty() const;
+
+        const glm::vec3 &getMin() const;
+
+        const glm::vec3 &getMax() const;
+
+        glm::vec3 getCenter() const;
+
+        glm::vec3 getExtents() const;
+
+        // Radius of the sphere around the box center that contains the whole box
+        float getRadius() const;
+
+        // Box containing this box after it has been transformed by the given matrix
+        Bounds transform(const glm::mat4 &matrix) const;
+
+    private:
+        glm::vec3 _min;
+        glm::vec3 _max;
+    };
+}
@@ -0,0 +1,89 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include "compute_shader.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <glm/gtc/type_ptr.hpp>
+
+scratch::ComputeShader::ComputeShader(const std::string &path) : _path(path) {
+    std::ifstream file(path);
+    std::stringstream fileStream;
+    fileStream << file.rdbuf();
+    std::string source = fileStream.str();
+    const char *sourcePointer = source.c_str();
+
+    GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(shader, 1, &sourcePointer, nullptr);
+    glCompileShader(shader);
+    int success;
+    char infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cout << "ERROR::scratch::COMPUTE_SHADER::COMPILATION_FAILED " << path << "\n" << infoLog << std::endl;
+        glDeleteShader(shader);
+        return;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, shader);
+    glLinkProgram(program);
+    glDetachShader(program, shader);
+    glDeleteShader(shader);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cout << "ERROR::scratch::COMPUTE_SHADER::LINK_FAILED " << path << "\n" << infoLog << std::endl;
+        glDeleteProgram(program);
+        return;
+    }
+    _programId = program;
+}
+
+scratch::ComputeShader::~ComputeShader() {
+    glDeleteProgram(_programId);
+}
+
+bool scratch::ComputeShader::isValid() const {
+    return _programId != 0;
+}
+
+void scratch::ComputeShader::use() const {
+    glUseProgram(_programId);
+}
+
+GLuint scratch::ComputeShader::groupsFor(GLuint count, GLuint groupSize) {
+    return (count + groupSize - 1) / groupSize;
+}
+
+unsigned int scratch::ComputeShader::getShaderId() const {
+    return _programId;
+}
+
+void scratch::ComputeShader::setBool(const std::string &name, bool value) const {
+    glUniform1i(glGetUniformLocation(_programId, name.c_str()), (int) value);
+}
+
+void scratch::ComputeShader::setInt(const std::string &name, int value) const {
+    glUniform1i(glGetUniformLocation(_programId, name.c_str()), value);
+}
+
+void scratch::ComputeShader::setUnsignedInt(const std::string &name, unsigned int value) const {
+    glUniform1ui(glGetUniformLocation(_programId, name.c_str()), value);
+}
+
+void scratch::ComputeShader::setVec2(const std::string &name, const glm::vec2 &value) const {
+    glUniform2f(glGetUniformLocation(_programId, name.c_str()), value.x, value.y);
+}
+
+void scratch::ComputeShader::setIVec2(const std::string &name, const glm::ivec2 &value) const {
+    glUniform2i(glGetUniformLocation(_programId, name.c_str()), value.x, value.y);
+}
+
+void scratch::ComputeShader::setMat4(const std::string &name, const glm::mat4 &value) const {
+    glUniformMatrix4fv(glGetUniformLocation(_programId, name.c_str()), 1, GL_FALSE, glm::value_ptr(value));
+}
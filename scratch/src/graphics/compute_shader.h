@@ -0,0 +1,48 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <string>
+
+namespace scratch {
+    // A single compute stage program, GL 4.3+. Compile errors are logged and leave the shader invalid.
+    class ComputeShader {
+    public:
+        explicit ComputeShader(const std::string &path);
+
+        ~ComputeShader();
+
+        ComputeShader(const ComputeShader &other) = delete;
+
+        ComputeShader &operator=(const ComputeShader &other) = delete;
+
+        bool isValid() const;
+
+        void use() const;
+
+        // Work groups of groupSize invocations needed to cover count
+        static GLuint groupsFor(GLuint count, GLuint groupSize);
+
+        unsigned int getShaderId() const;
+
+        void setBool(const std::string &name, bool value) const;
+
+        void setInt(const std::string &name, int value) const;
+
+        void setUnsignedInt(const std::string &name, unsigned int value) const;
+
+        void setVec2(const std::string &name, const glm::vec2 &value) const;
+
+        void setIVec2(const std::string &name, const glm::ivec2 &value) const;
+
+        void setMat4(const std::string &name, const glm::mat4 &value) const;
+
+    private:
+        std::string _path;
+        unsigned int _programId = 0;
+    };
+}
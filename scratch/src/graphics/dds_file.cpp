@@ -0,0 +1,224 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "dds_file.h"
+
+namespace {
+    const uint32_t DDS_MAGIC = 0x20534444;
+
+    const uint32_t DDSD_CAPS = 0x1;
+    const uint32_t DDSD_HEIGHT = 0x2;
+    const uint32_t DDSD_WIDTH = 0x4;
+    const uint32_t DDSD_PIXELFORMAT = 0x1000;
+    const uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+    const uint32_t DDSD_LINEARSIZE = 0x80000;
+    const uint32_t DDPF_FOURCC = 0x4;
+    const uint32_t DDSCAPS_COMPLEX = 0x8;
+    const uint32_t DDSCAPS_TEXTURE = 0x1000;
+    const uint32_t DDSCAPS_MIPMAP = 0x400000;
+    const uint32_t D3D10_RESOURCE_DIMENSION_TEXTURE2D = 3;
+
+    enum DxgiFormat : uint32_t {
+        DXGI_FORMAT_BC1_UNORM = 71,
+        DXGI_FORMAT_BC1_UNORM_SRGB = 72,
+        DXGI_FORMAT_BC3_UNORM = 77,
+        DXGI_FORMAT_BC3_UNORM_SRGB = 78,
+        DXGI_FORMAT_BC5_UNORM = 83,
+        DXGI_FORMAT_BC7_UNORM = 98,
+        DXGI_FORMAT_BC7_UNORM_SRGB = 99
+    };
+
+    constexpr uint32_t fourCC(char a, char b, char c, char d) {
+        return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) |
+               (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+    }
+
+    // On disk layout, every field is a little endian 32 bit word
+    struct DdsPixelFormat {
+        uint32_t size;
+        uint32_t flags;
+        uint32_t fourCC;
+        uint32_t rgbBitCount;
+        uint32_t masks[4];
+    };
+
+    struct DdsHeader {
+        uint32_t size;
+        uint32_t flags;
+        uint32_t height;
+        uint32_t width;
+        uint32_t pitchOrLinearSize;
+        uint32_t depth;
+        uint32_t mipMapCount;
+        uint32_t reserved1[11];
+        DdsPixelFormat pixelFormat;
+        uint32_t caps;
+        uint32_t caps2;
+        uint32_t caps3;
+        uint32_t caps4;
+        uint32_t reserved2;
+    };
+
+    struct DdsHeaderDx10 {
+        uint32_t dxgiFormat;
+        uint32_t resourceDimension;
+        uint32_t miscFlag;
+        uint32_t arraySize;
+        uint32_t miscFlags2;
+    };
+
+    static_assert(sizeof(DdsHeader) == 124, "DDS header must match the file layout");
+    static_assert(sizeof(DdsHeaderDx10) == 20, "DX10 header must match the file layout");
+
+    uint32_t toDxgiFormat(scratch::BlockFormat format, bool srgb) {
+        switch (format) {
+            case scratch::BC1:
+                return srgb ? DXGI_FORMAT_BC1_UNORM_SRGB : DXGI_FORMAT_BC1_UNORM;
+            case scratch::BC3:
+                return srgb ? DXGI_FORMAT_BC3_UNORM_SRGB : DXGI_FORMAT_BC3_UNORM;
+            case scratch::BC5:
+                return DXGI_FORMAT_BC5_UNORM;
+            case scratch::BC7:
+                return srgb ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM;
+        }
+        return DXGI_FORMAT_BC1_UNORM;
+    }
+
+    bool fromDxgiFormat(uint32_t dxgiFormat, scratch::BlockFormat &format, bool &srgb) {
+        switch (dxgiFormat) {
+            case DXGI_FORMAT_BC1_UNORM:
+            case DXGI_FORMAT_BC1_UNORM_SRGB:
+                format = scratch::BC1;
+                break;
+            case DXGI_FORMAT_BC3_UNORM:
+            case DXGI_FORMAT_BC3_UNORM_SRGB:
+                format = scratch::BC3;
+                break;
+            case DXGI_FORMAT_BC5_UNORM:
+                format = scratch::BC5;
+                break;
+            case DXGI_FORMAT_BC7_UNORM:
+            case DXGI_FORMAT_BC7_UNORM_SRGB:
+                format = scratch::BC7;
+                break;
+            default:
+                return false;
+        }
+        srgb = dxgiFormat == DXGI_FORMAT_BC1_UNORM_SRGB || dxgiFormat == DXGI_FORMAT_BC3_UNORM_SRGB ||
+               dxgiFormat == DXGI_FORMAT_BC7_UNORM_SRGB;
+        return true;
+    }
+}
+
+int scratch::CompressedTexture::getWidth() const {
+    return mips.empty() ? 0 : mips[0].width;
+}
+
+int scratch::CompressedTexture::getHeight() const {
+    return mips.empty() ? 0 : mips[0].height;
+}
+
+void scratch::DdsFile::write(const std::string &path, const CompressedTexture &texture) {
+    if (texture.mips.empty()) {
+        throw std::runtime_error("Refusing to write a texture without mip levels to " + path);
+    }
+
+    DdsHeader header = {};
+    header.size = sizeof(DdsHeader);
+    header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+    header.height = static_cast<uint32_t>(texture.getHeight());
+    header.width = static_cast<uint32_t>(texture.getWidth());
+    header.pitchOrLinearSize = static_cast<uint32_t>(texture.mips[0].byteSize);
+    header.mipMapCount = static_cast<uint32_t>(texture.mips.size());
+    header.pixelFormat.size = sizeof(DdsPixelFormat);
+    header.pixelFormat.flags = DDPF_FOURCC;
+    header.pixelFormat.fourCC = fourCC('D', 'X', '1', '0');
+    header.caps = DDSCAPS_TEXTURE | DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+
+    DdsHeaderDx10 headerDx10 = {};
+    headerDx10.dxgiFormat = toDxgiFormat(texture.format, texture.srgb);
+    headerDx10.resourceDimension = D3D10_RESOURCE_DIMENSION_TEXTURE2D;
+    headerDx10.arraySize = 1;
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Could not open " + path + " for writing");
+    }
+    file.write(reinterpret_cast<const char *>(&DDS_MAGIC), sizeof(DDS_MAGIC));
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(&headerDx10), sizeof(headerDx10));
+    // mip levels follow each other without padding
+    for (const auto &mip : texture.mips) {
+        file.write(reinterpret_cast<const char *>(texture.data.data() + mip.offset),
+                   static_cast<std::streamsize>(mip.byteSize));
+    }
+    if (!file) {
+        throw std::runtime_error("Failed writing " + path);
+    }
+}
+
+bool scratch::DdsFile::read(const std::string &path, CompressedTexture &texture) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    uint32_t magic = 0;
+    DdsHeader header = {};
+    file.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!file || magic != DDS_MAGIC || header.size != sizeof(DdsHeader)) {
+        std::cout << "Not a DDS file: " << path << std::endl;
+        return false;
+    }
+
+    bool supported = (header.pixelFormat.flags & DDPF_FOURCC) != 0;
+    uint32_t formatCode = header.pixelFormat.fourCC;
+    texture.srgb = false;
+    if (supported && formatCode == fourCC('D', 'X', '1', '0')) {
+        DdsHeaderDx10 headerDx10 = {};
+        file.read(reinterpret_cast<char *>(&headerDx10), sizeof(headerDx10));
+        supported = file && headerDx10.resourceDimension == D3D10_RESOURCE_DIMENSION_TEXTURE2D &&
+                    headerDx10.arraySize <= 1 &&
+                    fromDxgiFormat(headerDx10.dxgiFormat, texture.format, texture.srgb);
+    } else if (formatCode == fourCC('D', 'X', 'T', '1')) {
+        texture.format = BC1;
+    } else if (formatCode == fourCC('D', 'X', 'T', '5')) {
+        texture.format = BC3;
+    } else if (formatCode == fourCC('A', 'T', 'I', '2') || formatCode == fourCC('B', 'C', '5', 'U')) {
+        texture.format = BC5;
+    } else {
+        supported = false;
+    }
+    if (!supported) {
+        std::cout << "Unsupported DDS format in " << path << std::endl;
+        return false;
+    }
+
+    uint32_t mipCount = (header.flags & DDSD_MIPMAPCOUNT) ? std::max(header.mipMapCount, 1u) : 1u;
+    int width = static_cast<int>(header.width);
+    int height = static_cast<int>(header.height);
+    size_t totalSize = 0;
+    texture.mips.clear();
+    for (uint32_t level = 0; level < mipCount; ++level) {
+        size_t byteSize = BcEncoder::getCompressedSize(texture.format, width, height);
+        texture.mips.push_back({width, height, totalSize, byteSize});
+        totalSize += byteSize;
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+
+    texture.data.resize(totalSize);
+    file.read(reinterpret_cast<char *>(texture.data.data()), static_cast<std::streamsize>(totalSize));
+    if (!file) {
+        std::cout << "Truncated DDS file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,44 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bc_encoder.h"
+
+namespace scratch {
+    struct CompressedMip {
+        int width;
+        int height;
+        // location of the level inside CompressedTexture::data
+        size_t offset;
+        size_t byteSize;
+    };
+
+    // A block compressed texture with its whole mip chain, largest level first
+    struct CompressedTexture {
+        BlockFormat format = BC1;
+        bool srgb = false;
+        std::vector<CompressedMip> mips;
+        std::vector<uint8_t> data;
+
+        int getWidth() const;
+
+        int getHeight() const;
+    };
+
+    // Reads and writes DirectDraw Surface containers. Files are always written with the DX10 header,
+    // legacy DXT1/DXT5/ATI2 files can still be read.
+    class DdsFile {
+    public:
+        // Throws std::runtime_error if the file can't be written
+        static void write(const std::string &path, const CompressedTexture &texture);
+
+        // Returns false for missing files and anything not in a supported block format
+        static bool read(const std::string &path, CompressedTexture &texture);
+    };
+}
@@ -0,0 +1,28 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "bounds.h"
+
+namespace scratch { class Mesh; }
+
+namespace scratch {
+    // A single mesh instance queued for drawing. The mesh is owned by its model, which the frame packet keeps alive.
+    struct DrawItem {
+        const scratch::Mesh *mesh;
+        glm::mat4 modelMatrix;
+        unsigned int lod;
+        // world space, what culling tests against
+        scratch::Bounds bounds;
+        // view depth above the material id, ascending is front to back with ties grouped by material
+        uint64_t sortKey;
+        // first of the item's skinning matrices in the frame's bone palette, NO_PALETTE unless it's animated
+        uint32_t paletteOffset;
+
+        static constexpr uint32_t NO_PALETTE = 0xFFFFFFFFu;
+    };
+}
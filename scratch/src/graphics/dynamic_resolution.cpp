@@ -0,0 +1,90 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include "dynamic_resolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+void scratch::DynamicResolution::setEnabled(bool enabled) {
+    _enabled = enabled;
+    _renderScale = _maxScale;
+    _gpuFrameTime = 0.0f;
+}
+
+bool scratch::DynamicResolution::isEnabled() {
+    return _enabled;
+}
+
+void scratch::DynamicResolution::setTargetFrameTime(float milliseconds) {
+    _targetFrameTime = std::max(milliseconds, 1.0f);
+}
+
+float scratch::DynamicResolution::getTargetFrameTime() {
+    return _targetFrameTime;
+}
+
+void scratch::DynamicResolution::setScaleRange(float minScale, float maxScale) {
+    _minScale = std::clamp(minScale, 0.1f, 1.0f);
+    _maxScale = std::clamp(maxScale, _minScale, 1.0f);
+    _renderScale = std::clamp(_renderScale, _minScale, _maxScale);
+}
+
+float scratch::DynamicResolution::getRenderScale() {
+    return _renderScale;
+}
+
+float scratch::DynamicResolution::getGpuFrameTime() {
+    return _gpuFrameTime;
+}
+
+void scratch::DynamicResolution::beginFrame() {
+    if (_queries[0] == 0) {
+        glGenQueries(QUERY_COUNT, _queries);
+    }
+    unsigned int slot = _frame % QUERY_COUNT;
+    // the oldest query gets reused, its result has had the longest to arrive
+    if (_queryPending[slot]) {
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(_queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(_queries[slot], GL_QUERY_RESULT, &elapsed);
+            updateScale(static_cast<float>(static_cast<double>(elapsed) / 1000000.0));
+        }
+        // late results are dropped rather than waited on
+        _queryPending[slot] = false;
+    }
+    glBeginQuery(GL_TIME_ELAPSED, _queries[slot]);
+}
+
+void scratch::DynamicResolution::endFrame() {
+    glEndQuery(GL_TIME_ELAPSED);
+    _queryPending[_frame % QUERY_COUNT] = true;
+    ++_frame;
+}
+
+void scratch::DynamicResolution::updateScale(float gpuMilliseconds) {
+    _gpuFrameTime = _gpuFrameTime == 0.0f ? gpuMilliseconds
+                                          : _gpuFrameTime + (gpuMilliseconds - _gpuFrameTime) * SMOOTHING;
+    if (!_enabled) {
+        return;
+    }
+    float budget = _targetFrameTime * BUDGET_FRACTION;
+    if (std::abs(_gpuFrameTime - budget) < budget * DEAD_BAND) {
+        return;
+    }
+    // time scales with pixel count, the square of the scale
+    float desiredScale = _renderScale * std::sqrt(budget / std::max(_gpuFrameTime, 0.01f));
+    float step = std::clamp(desiredScale - _renderScale, -MAX_SCALE_STEP, MAX_SCALE_STEP);
+    _renderScale = std::clamp(_renderScale + step, _minScale, _maxScale);
+}
+
+void scratch::DynamicResolution::shutdown() {
+    if (_queries[0] != 0) {
+        glDeleteQueries(QUERY_COUNT, _queries);
+        std::fill(_queries, _queries + QUERY_COUNT, 0);
+        std::fill(_queryPending, _queryPending + QUERY_COUNT, false);
+    }
+}
@@ -0,0 +1,62 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <glad/glad.h>
+
+namespace scratch {
+    // Picks the render scale each frame from how long the GPU took on recent ones, so heavy scenes drop
+    // resolution instead of frames. Frames are timed with GL_TIME_ELAPSED queries read back a couple of frames
+    // late so nothing stalls. Pixel count goes with the square of the scale, which the controller accounts for,
+    // and it only moves once the smoothed time has left a small band around the budget so the scale doesn't
+    // wobble from frame to frame.
+    class DynamicResolution {
+    public:
+        static void setEnabled(bool enabled);
+
+        static bool isEnabled();
+
+        // GPU time per frame to aim for, e.g. 16.6 for 60 Hz
+        static void setTargetFrameTime(float milliseconds);
+
+        static float getTargetFrameTime();
+
+        static void setScaleRange(float minScale, float maxScale);
+
+        // Scale the next frame should render at
+        static float getRenderScale();
+
+        // Smoothed GPU time of the frames measured so far
+        static float getGpuFrameTime();
+
+        // Brackets the GPU work to time, the scale is updated at the end from whatever results are in
+        static void beginFrame();
+
+        static void endFrame();
+
+        static void shutdown();
+
+    private:
+        static const unsigned int QUERY_COUNT = 3;
+        // aim a bit under the target so spikes don't go over it
+        static constexpr float BUDGET_FRACTION = 0.9f;
+        // how far the time can drift from the budget before the scale reacts
+        static constexpr float DEAD_BAND = 0.08f;
+        static constexpr float MAX_SCALE_STEP = 0.05f;
+        static constexpr float SMOOTHING = 0.2f;
+
+        inline static bool _enabled = true;
+        inline static float _targetFrameTime = 1000.0f / 60.0f;
+        inline static float _minScale = 0.5f;
+        inline static float _maxScale = 1.0f;
+        inline static float _renderScale = 1.0f;
+        inline static float _gpuFrameTime = 0.0f;
+
+        inline static GLuint _queries[QUERY_COUNT] = {};
+        inline static bool _queryPending[QUERY_COUNT] = {};
+        inline static unsigned int _frame = 0;
+
+        static void updateScale(float gpuMilliseconds);
+    };
+}
@@ -0,0 +1,42 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "camera/camera.h"
+#include "lights/directional_light.h"
+#include "lights/point_light.h"
+#include "lights/spot_light.h"
+#include "render_queue.h"
+
+namespace scratch {
+    class Material;
+
+    class Renderable;
+
+    // Everything a frame draws, copied out of the scene so the scene can move on while it is drawn.
+    // See SceneManager::beginSnapshot.
+    struct FramePacket {
+        // the camera when the snapshot was taken, the live one moves again with the next frame's input
+        Camera camera;
+        // taken on the main thread, the projection asks GLFW for the window size
+        glm::mat4 view;
+        glm::mat4 projection;
+        RenderQueue renderQueue;
+        DirectionalLight directionalLight;
+        std::vector<PointLight> pointLights;
+        std::vector<SpotLight> spotLights;
+        // skinning matrices of every animated entity back to back, draw items find theirs by paletteOffset
+        std::vector<glm::mat4> bonePalette;
+        // largest screen fraction each material covers, handed to texture streaming when the packet is drawn
+        std::vector<std::pair<const Material *, float>> textureCoverage;
+        // keeps the meshes and materials the draw items point at alive, loading a scene can drop them before
+        // the packet is drawn
+        std::vector<std::shared_ptr<const Renderable>> renderables;
+    };
+}
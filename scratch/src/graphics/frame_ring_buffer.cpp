@@ -0,0 +1,151 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "frame_ring_buffer.h"
+
+void scratch::FrameRingBuffer::initialize(size_t slotSize) {
+    if (!GLAD_GL_VERSION_4_4) {
+        std::cout << "Persistent buffer mapping unavailable, streaming frame data with glBufferData" << std::endl;
+        return;
+    }
+    createBuffer(slotSize);
+}
+
+void scratch::FrameRingBuffer::shutdown() {
+    destroyBuffer();
+    deleteFences();
+}
+
+void scratch::FrameRingBuffer::beginFrame() {
+    _frame++;
+    if (_buffer == 0) {
+        return;
+    }
+    if (_overflowed) {
+        // buffers in use by queued frames stay alive until the GPU is done with them, their fences are kept
+        // to tell when frames finish and replaced as the new slots are fenced
+        size_t slotSize = _slotSize * 2;
+        std::cout << "Growing the frame ring buffer to " << slotSize << " bytes per frame" << std::endl;
+        destroyBuffer();
+        createBuffer(slotSize);
+        _overflowed = false;
+        return;
+    }
+
+    _slot = (_slot + 1) % FRAME_SLOTS;
+    _bytesUsed = 0;
+    GLsync &fence = _fences[_slot];
+    if (fence != nullptr) {
+        // FRAME_SLOTS frames ago, normally long done
+        GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        while (status == GL_TIMEOUT_EXPIRED) {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+        _completedFrame = std::max(_completedFrame, _slotFrames[_slot]);
+    }
+}
+
+void scratch::FrameRingBuffer::endFrame() {
+    if (_buffer == 0) {
+        return;
+    }
+    // fenced even when nothing was written, isFrameComplete goes by every frame's fence
+    GLsync &fence = _fences[_slot];
+    if (fence != nullptr) {
+        // left from before the ring grew, the new fence comes later so it covers that frame too
+        glDeleteSync(fence);
+    }
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    _slotFrames[_slot] = _frame;
+}
+
+GLintptr scratch::FrameRingBuffer::write(const void *data, size_t byteSize, size_t alignment) {
+    if (_memory == nullptr) {
+        return -1;
+    }
+    size_t start = (_bytesUsed + alignment - 1) / alignment * alignment;
+    if (start + byteSize > _slotSize) {
+        _overflowed = true;
+        return -1;
+    }
+    size_t offset = _slot * _slotSize + start;
+    std::memcpy(_memory + offset, data, byteSize);
+    _bytesUsed = start + byteSize;
+    return static_cast<GLintptr>(offset);
+}
+
+GLuint scratch::FrameRingBuffer::getBuffer() {
+    return _buffer;
+}
+
+bool scratch::FrameRingBuffer::isAvailable() {
+    return _memory != nullptr;
+}
+
+uint64_t scratch::FrameRingBuffer::getFrame() {
+    return _frame;
+}
+
+bool scratch::FrameRingBuffer::isFrameComplete(uint64_t frame) {
+    if (frame <= _completedFrame) {
+        return true;
+    }
+    if (_buffer == 0) {
+        return frame + FRAME_SLOTS <= _frame;
+    }
+    // fences signal in order, any frame at or after this one being done means this one is
+    for (unsigned int slot = 0; slot < FRAME_SLOTS; ++slot) {
+        if (_fences[slot] == nullptr || _slotFrames[slot] < frame) {
+            continue;
+        }
+        GLenum status = glClientWaitSync(_fences[slot], 0, 0);
+        if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+            _completedFrame = std::max(_completedFrame, _slotFrames[slot]);
+        }
+    }
+    return frame <= _completedFrame;
+}
+
+void scratch::FrameRingBuffer::createBuffer(size_t slotSize) {
+    _slotSize = slotSize;
+    auto totalSize = static_cast<GLsizeiptr>(_slotSize * FRAME_SLOTS);
+    // coherent, so writes are visible to commands submitted after them without an explicit flush
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glGenBuffers(1, &_buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _buffer);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, totalSize, nullptr, flags);
+    _memory = static_cast<unsigned char *>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, totalSize, flags));
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    _slot = 0;
+    _bytesUsed = 0;
+}
+
+void scratch::FrameRingBuffer::deleteFences() {
+    for (auto &fence : _fences) {
+        if (fence != nullptr) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+}
+
+void scratch::FrameRingBuffer::destroyBuffer() {
+    if (_buffer != 0) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, _buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glDeleteBuffers(1, &_buffer);
+        _buffer = 0;
+    }
+    _memory = nullptr;
+    _slotSize = 0;
+    _bytesUsed = 0;
+}
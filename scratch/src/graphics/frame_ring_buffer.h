@@ -0,0 +1,68 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace scratch {
+    // One persistently mapped buffer for data written fresh every frame, split into a slot per frame in flight.
+    // A frame writes its slot front to back and fences it when done, the slot is only written again once the GPU
+    // has passed that fence, so the CPU never waits on or overwrites anything still being read.
+    class FrameRingBuffer {
+    public:
+        static const unsigned int FRAME_SLOTS = 3;
+        static const size_t INITIAL_SLOT_SIZE = 4 * 1024 * 1024;
+
+        // Persistent mapping is 4.4+, without it write always fails and callers stream their own buffers
+        static void initialize(size_t slotSize = INITIAL_SLOT_SIZE);
+
+        static void shutdown();
+
+        // Moves to the next slot, waiting for the GPU to finish the frame that last wrote it. A slot that ran out
+        // of space last frame gets all slots reallocated at twice the size first.
+        static void beginFrame();
+
+        // Fences this frame's slot, call once everything reading it has been submitted
+        static void endFrame();
+
+        // Copies data into this frame's slot at a multiple of alignment, returns its offset in getBuffer or -1
+        // when the ring is unavailable or the slot has no room left
+        static GLintptr write(const void *data, size_t byteSize, size_t alignment);
+
+        static GLuint getBuffer();
+
+        static bool isAvailable();
+
+        // Number of the frame being recorded, counting every beginFrame
+        static uint64_t getFrame();
+
+        // Whether the GPU is done with everything submitted up to the end of frame, by polling the slot fences
+        // without waiting. Without the ring there are no fences to go by, frames FRAME_SLOTS back are taken to be
+        // done, about as far as drivers let the CPU run ahead.
+        static bool isFrameComplete(uint64_t frame);
+
+    private:
+        inline static GLuint _buffer = 0;
+        inline static unsigned char *_memory = nullptr;
+        inline static size_t _slotSize = 0;
+        inline static unsigned int _slot = 0;
+        inline static size_t _bytesUsed = 0;
+        inline static bool _overflowed = false;
+        inline static GLsync _fences[FRAME_SLOTS] = {};
+        // the frame each slot's fence was placed at the end of
+        inline static uint64_t _slotFrames[FRAME_SLOTS] = {};
+        inline static uint64_t _frame = 0;
+        // newest frame a signalled fence has shown to be finished
+        inline static uint64_t _completedFrame = 0;
+
+        static void createBuffer(size_t slotSize);
+
+        static void destroyBuffer();
+
+        static void deleteFences();
+    };
+}
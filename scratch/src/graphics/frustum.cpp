@@ -0,0 +1,50 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include "frustum.h"
+
+scratch::Frustum::Frustum() {
+    // passes everything until built from a matrix
+    for (auto &plane : _planes) {
+        plane = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+}
+
+scratch::Frustum::Frustum(const glm::mat4 &viewProjection) {
+    // Gribb and Hartmann: each plane is the last row of the matrix plus or minus one of the others
+    glm::vec4 rows[4];
+    for (int row = 0; row < 4; ++row) {
+        rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row], viewProjection[2][row],
+                              viewProjection[3][row]);
+    }
+    _planes[0] = rows[3] + rows[0];
+    _planes[1] = rows[3] - rows[0];
+    _planes[2] = rows[3] + rows[1];
+    _planes[3] = rows[3] - rows[1];
+    _planes[4] = rows[3] + rows[2];
+    _planes[5] = rows[3] - rows[2];
+    for (auto &plane : _planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+}
+
+bool scratch::Frustum::intersects(const Bounds &worldBounds) const {
+    if (worldBounds.isEmpty()) {
+        return true;
+    }
+    for (const auto &plane : _planes) {
+        // the corner furthest along the plane normal, if even that is behind the plane the box is outside
+        glm::vec3 normal = glm::vec3(plane);
+        glm::vec3 positiveCorner = worldBounds.getMin();
+        for (int axis = 0; axis < 3; ++axis) {
+            if (normal[axis] >= 0.0f) {
+                positiveCorner[axis] = worldBounds.getMax()[axis];
+            }
+        }
+        if (glm::dot(normal, positiveCorner) + plane.w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,24 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "bounds.h"
+
+namespace scratch {
+    // The six planes bounding what a view projection matrix can see, normals pointing inwards
+    class Frustum {
+    public:
+        Frustum();
+
+        explicit Frustum(const glm::mat4 &viewProjection);
+
+        // Conservative, boxes near a corner can pass without actually being inside. Empty bounds always pass.
+        bool intersects(const Bounds &worldBounds) const;
+
+    private:
+        glm::vec4 _planes[6];
+    };
+}
@@ -0,0 +1,249 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+
+#include "geometry_pool.h"
+
+namespace {
+    const size_t INITIAL_VERTEX_CAPACITY = 64 * 1024;
+    const size_t INITIAL_INDEX_CAPACITY = 256 * 1024;
+    const size_t INITIAL_DRAW_INDEX_CAPACITY = 4096;
+    // only skinned meshes live here, a few characters' worth
+    const size_t INITIAL_SKINNING_CAPACITY = 16 * 1024;
+
+    GLuint createBuffer(size_t byteSize) {
+        GLuint buffer;
+        glGenBuffers(1, &buffer);
+        // the copy targets don't touch any vertex array state
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, byteSize, nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return buffer;
+    }
+}
+
+void scratch::GeometryPool::initialize() {
+    _vertexBuffer = createBuffer(INITIAL_VERTEX_CAPACITY * sizeof(Vertex));
+    _positionBuffer = createBuffer(INITIAL_VERTEX_CAPACITY * sizeof(glm::vec3));
+    _vertexAllocator = RangeAllocator(INITIAL_VERTEX_CAPACITY);
+    for (IndexArena *arena : {&_shortArena, &_intArena}) {
+        arena->buffer = createBuffer(INITIAL_INDEX_CAPACITY * IndexData::getIndexTypeSize(arena->type));
+        arena->allocator = RangeAllocator(INITIAL_INDEX_CAPACITY);
+        glGenVertexArrays(1, &arena->vertexArray);
+        glGenVertexArrays(1, &arena->positionVertexArray);
+    }
+    reserveDrawIndices(INITIAL_DRAW_INDEX_CAPACITY);
+}
+
+void scratch::GeometryPool::shutdown() {
+    for (IndexArena *arena : {&_shortArena, &_intArena}) {
+        glDeleteVertexArrays(1, &arena->vertexArray);
+        glDeleteVertexArrays(1, &arena->positionVertexArray);
+        glDeleteBuffers(1, &arena->buffer);
+        arena->vertexArray = 0;
+        arena->positionVertexArray = 0;
+        arena->buffer = 0;
+    }
+    glDeleteBuffers(1, &_vertexBuffer);
+    glDeleteBuffers(1, &_positionBuffer);
+    glDeleteBuffers(1, &_drawIndexBuffer);
+    glDeleteBuffers(1, &_skinningBuffer);
+    _vertexBuffer = 0;
+    _positionBuffer = 0;
+    _drawIndexBuffer = 0;
+    _skinningBuffer = 0;
+    _skinningAllocator = RangeAllocator();
+    _drawIndexCapacity = 0;
+}
+
+scratch::GeometryAllocation scratch::GeometryPool::allocate(const std::vector<Vertex> &vertices,
+                                                            const std::vector<SkinningVertex> &skinning,
+                                                            const IndexData &indices) {
+    GeometryAllocation allocation;
+    if (vertices.empty() || indices.empty()) {
+        return allocation;
+    }
+    IndexArena &arena = getArena(indices.getType());
+    size_t indexSize = IndexData::getIndexTypeSize(arena.type);
+
+    size_t firstVertex = _vertexAllocator.allocate(vertices.size());
+    if (firstVertex == RangeAllocator::INVALID_OFFSET) {
+        size_t oldCapacity = _vertexAllocator.getCapacity();
+        size_t newCapacity = std::max(oldCapacity * 2, oldCapacity + vertices.size());
+        growBuffer(_vertexBuffer, oldCapacity * sizeof(Vertex), newCapacity * sizeof(Vertex));
+        growBuffer(_positionBuffer, oldCapacity * sizeof(glm::vec3), newCapacity * sizeof(glm::vec3));
+        _vertexAllocator.grow(newCapacity);
+        setupVertexArray(_shortArena);
+        setupVertexArray(_intArena);
+        firstVertex = _vertexAllocator.allocate(vertices.size());
+    }
+
+    size_t firstIndex = arena.allocator.allocate(indices.getCount());
+    if (firstIndex == RangeAllocator::INVALID_OFFSET) {
+        size_t oldCapacity = arena.allocator.getCapacity();
+        size_t newCapacity = std::max(oldCapacity * 2, oldCapacity + indices.getCount());
+        growBuffer(arena.buffer, oldCapacity * indexSize, newCapacity * indexSize);
+        arena.allocator.grow(newCapacity);
+        setupVertexArray(arena);
+        firstIndex = arena.allocator.allocate(indices.getCount());
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _vertexBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, firstVertex * sizeof(Vertex), vertices.size() * sizeof(Vertex),
+                    vertices.data());
+    std::vector<glm::vec3> positions;
+    positions.reserve(vertices.size());
+    for (const auto &vertex : vertices) {
+        positions.push_back(vertex.position);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _positionBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, firstVertex * sizeof(glm::vec3), positions.size() * sizeof(glm::vec3),
+                    positions.data());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, arena.buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, firstIndex * indexSize, indices.getByteSize(), indices.getData());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    allocation.firstVertex = firstVertex;
+    allocation.vertexCount = vertices.size();
+    allocation.firstIndex = firstIndex;
+    allocation.indexCount = indices.getCount();
+    allocation.indexType = arena.type;
+    if (!skinning.empty()) {
+        allocation.firstSkinningVertex = allocateSkinning(skinning);
+        allocation.skinned = true;
+    }
+    return allocation;
+}
+
+size_t scratch::GeometryPool::allocateSkinning(const std::vector<SkinningVertex> &skinning) {
+    if (_skinningBuffer == 0) {
+        size_t capacity = std::max(INITIAL_SKINNING_CAPACITY, skinning.size());
+        _skinningBuffer = createBuffer(capacity * sizeof(SkinningVertex));
+        _skinningAllocator = RangeAllocator(capacity);
+    }
+    size_t firstVertex = _skinningAllocator.allocate(skinning.size());
+    if (firstVertex == RangeAllocator::INVALID_OFFSET) {
+        size_t oldCapacity = _skinningAllocator.getCapacity();
+        size_t newCapacity = std::max(oldCapacity * 2, oldCapacity + skinning.size());
+        growBuffer(_skinningBuffer, oldCapacity * sizeof(SkinningVertex), newCapacity * sizeof(SkinningVertex));
+        _skinningAllocator.grow(newCapacity);
+        firstVertex = _skinningAllocator.allocate(skinning.size());
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _skinningBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, firstVertex * sizeof(SkinningVertex),
+                    skinning.size() * sizeof(SkinningVertex), skinning.data());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    return firstVertex;
+}
+
+void scratch::GeometryPool::release(GeometryAllocation &allocation) {
+    if (!allocation.isValid()) {
+        return;
+    }
+    _vertexAllocator.free(allocation.firstVertex, allocation.vertexCount);
+    if (allocation.skinned) {
+        _skinningAllocator.free(allocation.firstSkinningVertex, allocation.vertexCount);
+    }
+    getArena(allocation.indexType).allocator.free(allocation.firstIndex, allocation.indexCount);
+    allocation = GeometryAllocation();
+}
+
+void scratch::GeometryPool::bind(GLenum indexType, VertexStream stream) {
+    const IndexArena &arena = getArena(indexType);
+    glBindVertexArray(stream == POSITION_STREAM ? arena.positionVertexArray : arena.vertexArray);
+}
+
+void scratch::GeometryPool::reserveDrawIndices(size_t drawCount) {
+    if (drawCount <= _drawIndexCapacity) {
+        return;
+    }
+    size_t newCapacity = std::max(drawCount, _drawIndexCapacity * 2);
+    // identity mapping, instance n reads draw index n
+    std::vector<uint32_t> drawIndices(newCapacity);
+    std::iota(drawIndices.begin(), drawIndices.end(), 0u);
+
+    if (_drawIndexBuffer == 0) {
+        glGenBuffers(1, &_drawIndexBuffer);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _drawIndexBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, newCapacity * sizeof(uint32_t), drawIndices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    _drawIndexCapacity = newCapacity;
+
+    setupVertexArray(_shortArena);
+    setupVertexArray(_intArena);
+}
+
+void scratch::GeometryPool::bindSkinning() {
+    if (_skinningBuffer != 0) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SKINNING_BINDING, _skinningBuffer);
+    }
+}
+
+scratch::IndexArena &scratch::GeometryPool::getArena(GLenum indexType) {
+    return indexType == GL_UNSIGNED_SHORT ? _shortArena : _intArena;
+}
+
+void scratch::GeometryPool::growBuffer(GLuint &buffer, size_t oldByteSize, size_t newByteSize) {
+    GLuint newBuffer = createBuffer(newByteSize);
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldByteSize);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, &buffer);
+    buffer = newBuffer;
+}
+
+void scratch::GeometryPool::setupVertexArray(IndexArena &arena) {
+    if (arena.vertexArray == 0 || _vertexBuffer == 0 || _positionBuffer == 0) {
+        return;
+    }
+    glBindVertexArray(arena.vertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena.buffer);
+
+    // vertex Positions
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) 0);
+    // vertex normals
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, normal));
+    // vertex texture coords
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, texCoords));
+    // vertex tangent
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, tangent));
+    // vertex bitangent
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, bitangent));
+
+    setupDrawIndexAttribute();
+
+    // positions only, at the same attribute location as the full stream
+    glBindVertexArray(arena.positionVertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, _positionBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena.buffer);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void *) 0);
+    setupDrawIndexAttribute();
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void scratch::GeometryPool::setupDrawIndexAttribute() {
+    // per draw index, advanced once per instance
+    if (_drawIndexBuffer != 0) {
+        glBindBuffer(GL_ARRAY_BUFFER, _drawIndexBuffer);
+        glEnableVertexAttribArray(DRAW_INDEX_ATTRIBUTE);
+        glVertexAttribIPointer(DRAW_INDEX_ATTRIBUTE, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (void *) 0);
+        glVertexAttribDivisor(DRAW_INDEX_ATTRIBUTE, 1);
+    }
+}
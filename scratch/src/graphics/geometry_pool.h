@@ -0,0 +1,121 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+#include "index_data.h"
+#include "range_allocator.h"
+#include "vertex.h"
+
+namespace scratch {
+    // Where a mesh lives inside the pool, indices are relative to firstVertex
+    struct GeometryAllocation {
+        size_t firstVertex = 0;
+        size_t vertexCount = 0;
+        // counted in elements of indexType
+        size_t firstIndex = 0;
+        size_t indexCount = 0;
+        GLenum indexType = GL_UNSIGNED_INT;
+        // skinned meshes only, vertexCount bone weights in the skinning buffer
+        size_t firstSkinningVertex = 0;
+        bool skinned = false;
+
+        bool isValid() const {
+            return vertexCount > 0;
+        }
+
+        // Added to gl_VertexID, which counts from firstVertex, to index the skinning buffer
+        GLint getSkinningOffset() const {
+            return skinned ? static_cast<GLint>(firstSkinningVertex) - static_cast<GLint>(firstVertex) : 0;
+        }
+    };
+
+    // Layout glMultiDrawElementsIndirect reads from the indirect buffer
+    struct DrawElementsIndirectCommand {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+    // Which attributes a vertex array feeds. Depth only passes read the tightly packed positions, a third of
+    // the bandwidth of full vertices.
+    enum VertexStream {
+        FULL_VERTEX_STREAM,
+        POSITION_STREAM
+    };
+
+    // One index buffer and the vertex arrays drawing from it
+    struct IndexArena {
+        GLenum type;
+        GLuint buffer;
+        GLuint vertexArray;
+        GLuint positionVertexArray;
+        RangeAllocator allocator;
+    };
+
+    // Every mesh's vertices in one shared buffer and its indices in one of two arenas, 16 and 32 bit.
+    // Meshes sharing an index width can then be drawn together with a single multi-draw call.
+    // Attribute 5 holds a per draw index sourced from the draw's base instance, shaders use it to find their
+    // entry in per draw storage buffers.
+    // Bone weights of skinned meshes go to a storage buffer of their own, allocated on the first skinned mesh.
+    // Skinning shaders read it at gl_VertexID plus the draw's skinning offset, so static meshes carry none and
+    // the position stream stays positions only, while skinned and static meshes still share multi-draws.
+    class GeometryPool {
+    public:
+        static const GLuint DRAW_INDEX_ATTRIBUTE = 5;
+        // storage binding of the skinning buffer, three uints per vertex: joints 0 and 1, joints 2 and 3 as
+        // 16 bit halves, then the four weight bytes
+        static const GLuint SKINNING_BINDING = 10;
+
+        static void initialize();
+
+        static void shutdown();
+
+        // Uploads the geometry, growing the pool if it doesn't fit. Skinning is empty for static meshes.
+        static GeometryAllocation allocate(const std::vector<Vertex> &vertices,
+                                           const std::vector<SkinningVertex> &skinning, const IndexData &indices);
+
+        static void release(GeometryAllocation &allocation);
+
+        // Binds the vertex array drawing from the arena for indexType
+        static void bind(GLenum indexType, VertexStream stream = FULL_VERTEX_STREAM);
+
+        // Makes sure base instances up to drawCount map to a draw index
+        static void reserveDrawIndices(size_t drawCount);
+
+        // Binds the skinning buffer for skinning shaders, nothing to bind before a skinned mesh is added
+        static void bindSkinning();
+
+    private:
+        inline static GLuint _vertexBuffer = 0;
+        // copy of every vertex position, indexed the same as _vertexBuffer
+        inline static GLuint _positionBuffer = 0;
+        inline static RangeAllocator _vertexAllocator = RangeAllocator();
+        inline static GLuint _skinningBuffer = 0;
+        inline static RangeAllocator _skinningAllocator = RangeAllocator();
+        inline static IndexArena _shortArena = {GL_UNSIGNED_SHORT, 0, 0, 0, RangeAllocator()};
+        inline static IndexArena _intArena = {GL_UNSIGNED_INT, 0, 0, 0, RangeAllocator()};
+        inline static GLuint _drawIndexBuffer = 0;
+        inline static size_t _drawIndexCapacity = 0;
+
+        static IndexArena &getArena(GLenum indexType);
+
+        // Moves the contents into a larger buffer, buffer names change so vertex arrays need setting up again
+        static void growBuffer(GLuint &buffer, size_t oldByteSize, size_t newByteSize);
+
+        static void setupVertexArray(IndexArena &arena);
+
+        // Adds the draw index attribute to the bound vertex array
+        static void setupDrawIndexAttribute();
+
+        // Uploads bone weights to the skinning buffer, creating or growing it as needed
+        static size_t allocateSkinning(const std::vector<SkinningVertex> &skinning);
+    };
+}
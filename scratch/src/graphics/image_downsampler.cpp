@@ -0,0 +1,79 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include "image_downsampler.h"
+
+namespace {
+    float srgbToLinear(uint8_t value) {
+        float color = value / 255.0f;
+        return color <= 0.04045f ? color / 12.92f : std::pow((color + 0.055f) / 1.055f, 2.4f);
+    }
+
+    uint8_t linearToSrgb(float value) {
+        float color = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+        return static_cast<uint8_t>(std::lround(std::clamp(color, 0.0f, 1.0f) * 255.0f));
+    }
+
+    uint8_t toByte(float value) {
+        return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+    }
+}
+
+std::vector<uint8_t> scratch::ImageDownsampler::halve(const uint8_t *pixels, int width, int height, int channels,
+                                                      DownsampleMode mode, int &resultWidth, int &resultHeight) {
+    resultWidth = std::max(1, width / 2);
+    resultHeight = std::max(1, height / 2);
+    std::vector<uint8_t> result(static_cast<size_t>(resultWidth) * resultHeight * channels);
+    // alpha is never gamma encoded or part of a normal
+    int colorChannels = channels == 2 || channels == 4 ? channels - 1 : channels;
+    if (mode == DOWNSAMPLE_NORMAL) {
+        colorChannels = std::min(channels, 3);
+    }
+
+    for (int y = 0; y < resultHeight; ++y) {
+        for (int x = 0; x < resultWidth; ++x) {
+            float sum[4] = {};
+            for (int sampleY = 0; sampleY < 2; ++sampleY) {
+                for (int sampleX = 0; sampleX < 2; ++sampleX) {
+                    int sourceX = std::min(x * 2 + sampleX, width - 1);
+                    int sourceY = std::min(y * 2 + sampleY, height - 1);
+                    const uint8_t *pixel = &pixels[(static_cast<size_t>(sourceY) * width + sourceX) * channels];
+                    for (int c = 0; c < channels; ++c) {
+                        if (mode == DOWNSAMPLE_SRGB && c < colorChannels) {
+                            sum[c] += srgbToLinear(pixel[c]);
+                        } else if (mode == DOWNSAMPLE_NORMAL && c < colorChannels) {
+                            sum[c] += pixel[c] / 255.0f * 2.0f - 1.0f;
+                        } else {
+                            sum[c] += pixel[c] / 255.0f;
+                        }
+                    }
+                }
+            }
+
+            uint8_t *pixel = &result[(static_cast<size_t>(y) * resultWidth + x) * channels];
+            if (mode == DOWNSAMPLE_NORMAL) {
+                float length = 0.0f;
+                for (int c = 0; c < colorChannels; ++c) {
+                    length += sum[c] * sum[c];
+                }
+                length = std::sqrt(length);
+                for (int c = 0; c < colorChannels; ++c) {
+                    float normal = length > 0.0f ? sum[c] / length : (c == 2 ? 1.0f : 0.0f);
+                    pixel[c] = toByte(normal * 0.5f + 0.5f);
+                }
+            } else {
+                for (int c = 0; c < colorChannels; ++c) {
+                    pixel[c] = mode == DOWNSAMPLE_SRGB ? linearToSrgb(sum[c] / 4.0f) : toByte(sum[c] / 4.0f);
+                }
+            }
+            for (int c = colorChannels; c < channels; ++c) {
+                pixel[c] = toByte(sum[c] / 4.0f);
+            }
+        }
+    }
+    return result;
+}
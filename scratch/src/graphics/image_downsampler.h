@@ -0,0 +1,26 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace scratch {
+    enum DownsampleMode {
+        // every channel averaged as is
+        DOWNSAMPLE_LINEAR,
+        // colour channels averaged in linear space, alpha as is
+        DOWNSAMPLE_SRGB,
+        // xyz decoded from [0, 1], averaged and renormalized
+        DOWNSAMPLE_NORMAL
+    };
+
+    // CPU mip generation, shared by the texture cooker and texture streaming
+    class ImageDownsampler {
+    public:
+        // 2x2 box filter down to half size (at least 1x1), pixels are tightly packed 8 bit channels
+        static std::vector<uint8_t> halve(const uint8_t *pixels, int width, int height, int channels,
+                                          DownsampleMode mode, int &resultWidth, int &resultHeight);
+    };
+}
@@ -0,0 +1,67 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include <limits>
+
+#include "index_data.h"
+
+scratch::IndexData::IndexData(const std::vector<unsigned int> &indices, size_t vertexCount) {
+    _type = selectIndexType(vertexCount);
+    if (_type == GL_UNSIGNED_SHORT) {
+        _shortIndices.reserve(indices.size());
+        for (unsigned int index : indices) {
+            _shortIndices.push_back(static_cast<uint16_t>(index));
+        }
+    } else {
+        _intIndices.assign(indices.begin(), indices.end());
+    }
+}
+
+GLenum scratch::IndexData::selectIndexType(size_t vertexCount) {
+    // vertex ids run from 0 to vertexCount - 1, so a full 65536 vertices still fit in a short
+    if (vertexCount <= static_cast<size_t>(std::numeric_limits<uint16_t>::max()) + 1) {
+        return GL_UNSIGNED_SHORT;
+    }
+    return GL_UNSIGNED_INT;
+}
+
+size_t scratch::IndexData::getIndexTypeSize(GLenum indexType) {
+    return indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+GLenum scratch::IndexData::getType() const {
+    return _type;
+}
+
+size_t scratch::IndexData::getCount() const {
+    return _type == GL_UNSIGNED_SHORT ? _shortIndices.size() : _intIndices.size();
+}
+
+size_t scratch::IndexData::getByteSize() const {
+    return getCount() * getIndexTypeSize(_type);
+}
+
+const void *scratch::IndexData::getData() const {
+    if (_type == GL_UNSIGNED_SHORT) {
+        return _shortIndices.data();
+    }
+    return _intIndices.data();
+}
+
+unsigned int scratch::IndexData::get(size_t position) const {
+    if (_type == GL_UNSIGNED_SHORT) {
+        return _shortIndices[position];
+    }
+    return _intIndices[position];
+}
+
+bool scratch::IndexData::empty() const {
+    return getCount() == 0;
+}
+
+void scratch::IndexData::clear() {
+    // swap with empty vectors so the capacity is actually handed back
+    std::vector<uint16_t>().swap(_shortIndices);
+    std::vector<uint32_t>().swap(_intIndices);
+}
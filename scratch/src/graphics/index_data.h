@@ -0,0 +1,44 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace scratch {
+    // Index buffer contents stored at the narrowest GL index type that can address every vertex of a mesh
+    class IndexData {
+    public:
+        IndexData() = default;
+
+        IndexData(const std::vector<unsigned int> &indices, size_t vertexCount);
+
+        // GL_UNSIGNED_SHORT when every vertex fits in 16 bits, GL_UNSIGNED_INT otherwise
+        static GLenum selectIndexType(size_t vertexCount);
+
+        static size_t getIndexTypeSize(GLenum indexType);
+
+        GLenum getType() const;
+
+        size_t getCount() const;
+
+        size_t getByteSize() const;
+
+        const void *getData() const;
+
+        unsigned int get(size_t position) const;
+
+        bool empty() const;
+
+        void clear();
+
+    private:
+        GLenum _type = GL_UNSIGNED_INT;
+        std::vector<uint16_t> _shortIndices;
+        std::vector<uint32_t> _intIndices;
+    };
+}
@@ -0,0 +1,246 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include "light_clusters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/type_ptr.hpp>
+
+// Four lights are tested against a cluster at once where SSE is available
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SCRATCH_LIGHT_CLUSTERS_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace {
+    const unsigned int LANES = 4;
+
+    // Bounds of the lights reaching one depth slice, laid out so LANES of them load at once
+    struct SliceLights {
+        std::vector<uint32_t> indices;
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+        std::vector<float> radiusSquared;
+    };
+
+    // Bit i is set when sphere first + i overlaps the box
+    unsigned int overlapMask(const SliceLights &lights, size_t first, const glm::vec3 &boxMin,
+                             const glm::vec3 &boxMax) {
+#ifdef SCRATCH_LIGHT_CLUSTERS_SSE
+        const __m128 zero = _mm_setzero_ps();
+        __m128 x = _mm_loadu_ps(&lights.x[first]);
+        __m128 y = _mm_loadu_ps(&lights.y[first]);
+        __m128 z = _mm_loadu_ps(&lights.z[first]);
+        // distance from the center to the box along each axis, 0 when inside
+        __m128 dx = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(boxMin.x), x), zero),
+                               _mm_max_ps(_mm_sub_ps(x, _mm_set1_ps(boxMax.x)), zero));
+        __m128 dy = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(boxMin.y), y), zero),
+                               _mm_max_ps(_mm_sub_ps(y, _mm_set1_ps(boxMax.y)), zero));
+        __m128 dz = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(boxMin.z), z), zero),
+                               _mm_max_ps(_mm_sub_ps(z, _mm_set1_ps(boxMax.z)), zero));
+        __m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        return static_cast<unsigned int>(
+                _mm_movemask_ps(_mm_cmple_ps(distanceSquared, _mm_loadu_ps(&lights.radiusSquared[first]))));
+#else
+        unsigned int mask = 0;
+        for (unsigned int lane = 0; lane < LANES; ++lane) {
+            glm::vec3 center(lights.x[first + lane], lights.y[first + lane], lights.z[first + lane]);
+            glm::vec3 delta = glm::max(boxMin - center, 0.0f) + glm::max(center - boxMax, 0.0f);
+            if (glm::dot(delta, delta) <= lights.radiusSquared[first + lane]) {
+                mask |= 1u << lane;
+            }
+        }
+        return mask;
+#endif
+    }
+
+    void uploadStorage(GLuint &buffer, GLuint binding, const void *data, size_t byteSize, size_t minimumSize) {
+        if (buffer == 0) {
+            glGenBuffers(1, &buffer);
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+        // keep the store non empty so the binding stays valid without lights
+        glBufferData(GL_SHADER_STORAGE_BUFFER, std::max(byteSize, minimumSize), nullptr, GL_STREAM_DRAW);
+        if (byteSize > 0) {
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, byteSize, data);
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer);
+    }
+}
+
+bool scratch::LightClusters::isSupported() {
+    return GLAD_GL_VERSION_4_3;
+}
+
+void scratch::LightClusters::build(const std::vector<PointLight> &pointLights,
+                                   const std::vector<SpotLight> &spotLights,
+                                   const glm::mat4 &view, const glm::mat4 &projection, int viewportWidth,
+                                   int viewportHeight, JobSystem &jobSystem) {
+    // planes straight from the perspective matrix so the slices always match what's drawn
+    _nearPlane = projection[3][2] / (projection[2][2] - 1.0f);
+    _farPlane = projection[3][2] / (projection[2][2] + 1.0f);
+    _tileScale = glm::vec2(static_cast<float>(GRID_WIDTH) / static_cast<float>(std::max(viewportWidth, 1)),
+                           static_cast<float>(GRID_HEIGHT) / static_cast<float>(std::max(viewportHeight, 1)));
+
+    _lights.clear();
+    _bounds.clear();
+    _lights.reserve(pointLights.size() + spotLights.size());
+    _bounds.reserve(pointLights.size() + spotLights.size());
+    for (const auto &pointLight : pointLights) {
+        GpuLight light = {};
+        light.positionRange = glm::vec4(pointLight.getPosition(), pointLight.getRange());
+        light.directionCosOuter = glm::vec4(0.0f, 0.0f, -1.0f, -2.0f);
+        light.diffuseCosInner = glm::vec4(pointLight.getDiffuse().getValue(), -1.0f);
+        light.specular = glm::vec4(pointLight.getSpecular().getValue(), 0.0f);
+        _lights.push_back(light);
+
+        glm::vec3 center = glm::vec3(view * glm::vec4(pointLight.getPosition(), 1.0f));
+        _bounds.push_back({glm::vec3(center.x, center.y, -center.z), pointLight.getRange()});
+    }
+    for (const auto &spotLight : spotLights) {
+        glm::vec3 direction = glm::normalize(spotLight.getDirection());
+        float outerAngle = glm::radians(std::clamp(spotLight.getOuterCutoff(), 0.0f, 89.0f));
+        float innerAngle = glm::radians(std::clamp(spotLight.getInnerCutoff(), 0.0f, 89.0f));
+        GpuLight light = {};
+        light.positionRange = glm::vec4(spotLight.getPosition(), spotLight.getRange());
+        light.directionCosOuter = glm::vec4(direction, std::cos(outerAngle));
+        // an inner cutoff at or past the outer one would divide by zero in the falloff
+        light.diffuseCosInner = glm::vec4(spotLight.getDiffuse().getValue(),
+                                          std::max(std::cos(innerAngle), std::cos(outerAngle) + 0.001f));
+        light.specular = glm::vec4(spotLight.getSpecular().getValue(), 0.0f);
+        _lights.push_back(light);
+
+        // smallest sphere around the cone, wide cones are bounded by their cap and narrow ones by the length
+        float range = spotLight.getRange();
+        glm::vec3 worldCenter;
+        float radius;
+        if (outerAngle > glm::radians(45.0f)) {
+            worldCenter = spotLight.getPosition() + direction * (std::cos(outerAngle) * range);
+            radius = std::sin(outerAngle) * range;
+        } else {
+            radius = range / (2.0f * std::cos(outerAngle));
+            worldCenter = spotLight.getPosition() + direction * radius;
+        }
+        glm::vec3 center = glm::vec3(view * glm::vec4(worldCenter, 1.0f));
+        _bounds.push_back({glm::vec3(center.x, center.y, -center.z), radius});
+    }
+
+    // slices are independent, each one builds its own lists which are joined afterwards
+    std::vector<std::vector<glm::uvec2>> sliceClusters(GRID_DEPTH);
+    std::vector<std::vector<uint32_t>> sliceIndices(GRID_DEPTH);
+    jobSystem.parallelFor(GRID_DEPTH, [&](size_t slice) {
+        assignSlice(static_cast<unsigned int>(slice), projection, sliceClusters[slice], sliceIndices[slice]);
+    });
+
+    _clusters.clear();
+    _lightIndices.clear();
+    _clusters.reserve(GRID_WIDTH * GRID_HEIGHT * GRID_DEPTH);
+    for (unsigned int slice = 0; slice < GRID_DEPTH; ++slice) {
+        auto offset = static_cast<uint32_t>(_lightIndices.size());
+        for (const auto &cluster : sliceClusters[slice]) {
+            _clusters.emplace_back(cluster.x + offset, cluster.y);
+        }
+        _lightIndices.insert(_lightIndices.end(), sliceIndices[slice].begin(), sliceIndices[slice].end());
+    }
+
+    uploadStorage(_lightBuffer, LIGHT_BINDING, _lights.data(), _lights.size() * sizeof(GpuLight), sizeof(GpuLight));
+    uploadStorage(_clusterBuffer, CLUSTER_BINDING, _clusters.data(), _clusters.size() * sizeof(glm::uvec2),
+                  sizeof(glm::uvec2));
+    uploadStorage(_lightIndexBuffer, LIGHT_INDEX_BINDING, _lightIndices.data(),
+                  _lightIndices.size() * sizeof(uint32_t), sizeof(uint32_t));
+}
+
+void scratch::LightClusters::assignSlice(unsigned int slice, const glm::mat4 &projection,
+                                         std::vector<glm::uvec2> &clusters, std::vector<uint32_t> &lightIndices) {
+    float sliceNear = getSliceDepth(slice);
+    float sliceFar = getSliceDepth(slice + 1);
+
+    // only lights reaching this slice's depth range are worth testing per cluster
+    SliceLights lights;
+    for (size_t i = 0; i < _bounds.size(); ++i) {
+        const LightBounds &bounds = _bounds[i];
+        if (bounds.center.z + bounds.radius < sliceNear || bounds.center.z - bounds.radius > sliceFar) {
+            continue;
+        }
+        lights.indices.push_back(static_cast<uint32_t>(i));
+        lights.x.push_back(bounds.center.x);
+        lights.y.push_back(bounds.center.y);
+        lights.z.push_back(bounds.center.z);
+        lights.radiusSquared.push_back(bounds.radius * bounds.radius);
+    }
+    // pad to whole groups with spheres nothing can overlap
+    while (lights.x.size() % LANES != 0) {
+        lights.x.push_back(0.0f);
+        lights.y.push_back(0.0f);
+        lights.z.push_back(0.0f);
+        lights.radiusSquared.push_back(-1.0f);
+    }
+
+    clusters.resize(GRID_WIDTH * GRID_HEIGHT);
+    for (unsigned int tileY = 0; tileY < GRID_HEIGHT; ++tileY) {
+        for (unsigned int tileX = 0; tileX < GRID_WIDTH; ++tileX) {
+            // the tile's corners in NDC, scaled out to view space at both ends of the slice
+            float ndcLeft = -1.0f + 2.0f * static_cast<float>(tileX) / GRID_WIDTH;
+            float ndcRight = -1.0f + 2.0f * static_cast<float>(tileX + 1) / GRID_WIDTH;
+            float ndcBottom = -1.0f + 2.0f * static_cast<float>(tileY) / GRID_HEIGHT;
+            float ndcTop = -1.0f + 2.0f * static_cast<float>(tileY + 1) / GRID_HEIGHT;
+            glm::vec3 boxMin(std::min(ndcLeft * sliceNear, ndcLeft * sliceFar) / projection[0][0],
+                             std::min(ndcBottom * sliceNear, ndcBottom * sliceFar) / projection[1][1],
+                             sliceNear);
+            glm::vec3 boxMax(std::max(ndcRight * sliceNear, ndcRight * sliceFar) / projection[0][0],
+                             std::max(ndcTop * sliceNear, ndcTop * sliceFar) / projection[1][1],
+                             sliceFar);
+
+            auto offset = static_cast<uint32_t>(lightIndices.size());
+            for (size_t first = 0; first < lights.x.size(); first += LANES) {
+                unsigned int mask = overlapMask(lights, first, boxMin, boxMax);
+                while (mask != 0) {
+                    unsigned int lane = 0;
+                    while ((mask & (1u << lane)) == 0) {
+                        ++lane;
+                    }
+                    lightIndices.push_back(lights.indices[first + lane]);
+                    mask &= mask - 1;
+                }
+            }
+            clusters[tileX + tileY * GRID_WIDTH] = glm::uvec2(offset,
+                                                               static_cast<uint32_t>(lightIndices.size()) - offset);
+        }
+    }
+}
+
+float scratch::LightClusters::getSliceDepth(unsigned int slice) {
+    // exponential slices keep clusters roughly cube shaped as they get further away
+    return _nearPlane * std::pow(_farPlane / _nearPlane, static_cast<float>(slice) / GRID_DEPTH);
+}
+
+void scratch::LightClusters::applyToShader(const Shader &shader) {
+    // slice = log(depth) * scale + bias, the inverse of getSliceDepth
+    float depthScale = GRID_DEPTH / std::log(_farPlane / _nearPlane);
+    float depthBias = -std::log(_nearPlane) * depthScale;
+    glUniform3ui(glGetUniformLocation(shader.getShaderId(), "clusterGrid"), GRID_WIDTH, GRID_HEIGHT, GRID_DEPTH);
+    glUniform2f(glGetUniformLocation(shader.getShaderId(), "clusterTileScale"), _tileScale.x, _tileScale.y);
+    shader.setFloat("clusterDepthScale", depthScale);
+    shader.setFloat("clusterDepthBias", depthBias);
+}
+
+size_t scratch::LightClusters::getLightCount() {
+    return _lights.size();
+}
+
+size_t scratch::LightClusters::getAssignmentCount() {
+    return _lightIndices.size();
+}
+
+void scratch::LightClusters::shutdown() {
+    glDeleteBuffers(1, &_lightBuffer);
+    glDeleteBuffers(1, &_clusterBuffer);
+    glDeleteBuffers(1, &_lightIndexBuffer);
+    _lightBuffer = 0;
+    _clusterBuffer = 0;
+    _lightIndexBuffer = 0;
+}
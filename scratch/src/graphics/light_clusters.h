@@ -0,0 +1,88 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "lights/point_light.h"
+#include "lights/spot_light.h"
+#include "threading/job_system.h"
+#include "shader.h"
+
+namespace scratch {
+    // Splits the view frustum into a grid of clusters, tiles on screen sliced exponentially in depth, and lists
+    // the point and spot lights reaching each one. Shaders built with SCRATCH_CLUSTERED_LIGHTING find their
+    // cluster from the fragment position and only walk its lights, so per pixel cost follows how many lights
+    // overlap rather than how many there are.
+    class LightClusters {
+    public:
+        static const unsigned int GRID_WIDTH = 16;
+        static const unsigned int GRID_HEIGHT = 9;
+        static const unsigned int GRID_DEPTH = 24;
+        // storage buffer bindings, after the batched DrawBuffer and MaterialBuffer
+        static const GLuint LIGHT_BINDING = 2;
+        static const GLuint CLUSTER_BINDING = 3;
+        static const GLuint LIGHT_INDEX_BINDING = 4;
+
+        // Storage buffers are 4.3+
+        static bool isSupported();
+
+        // Assigns the lights to clusters across the job system, then uploads and binds the result
+        static void build(const std::vector<PointLight> &pointLights,
+                          const std::vector<SpotLight> &spotLights,
+                          const glm::mat4 &view, const glm::mat4 &projection, int viewportWidth, int viewportHeight,
+                          JobSystem &jobSystem);
+
+        // Sets the uniforms a clustered shader needs to find its cluster
+        static void applyToShader(const Shader &shader);
+
+        static size_t getLightCount();
+
+        // Light indices over all clusters, a rough measure of the shading work
+        static size_t getAssignmentCount();
+
+        static void shutdown();
+
+    private:
+        // std430 mirror of GpuLight in the clustered shaders. Point lights get a cutoff cosine below -1 so
+        // the spot falloff never dims them.
+        struct GpuLight {
+            glm::vec4 positionRange;
+            glm::vec4 directionCosOuter;
+            glm::vec4 diffuseCosInner;
+            glm::vec4 specular;
+        };
+
+        // bounding sphere of a light in view space, depth being positive into the screen
+        struct LightBounds {
+            glm::vec3 center;
+            float radius;
+        };
+
+        inline static GLuint _lightBuffer = 0;
+        inline static GLuint _clusterBuffer = 0;
+        inline static GLuint _lightIndexBuffer = 0;
+
+        inline static std::vector<GpuLight> _lights;
+        inline static std::vector<LightBounds> _bounds;
+        // offset and count into _lightIndices per cluster, x fastest then y then depth slice
+        inline static std::vector<glm::uvec2> _clusters;
+        inline static std::vector<uint32_t> _lightIndices;
+
+        inline static float _nearPlane = 0.1f;
+        inline static float _farPlane = 100.0f;
+        inline static glm::vec2 _tileScale = glm::vec2(0.0f);
+
+        // Lists the lights touching each cluster in one depth slice
+        static void assignSlice(unsigned int slice, const glm::mat4 &projection,
+                                std::vector<glm::uvec2> &clusters, std::vector<uint32_t> &lightIndices);
+
+        static float getSliceDepth(unsigned int slice);
+    };
+}
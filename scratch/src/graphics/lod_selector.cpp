@@ -0,0 +1,93 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include "lod_selector.h"
+
+scratch::LodSelector::LodSelector() {
+    _screenSizeThresholds = {0.5f, 0.25f, 0.125f, 0.0625f};
+    _hysteresis = 0.15f;
+}
+
+unsigned int scratch::LodSelector::selectLod(unsigned int nodeId, size_t meshIndex, const scratch::Mesh &mesh,
+                                             const glm::mat4 &modelMatrix, const scratch::Camera &camera) const {
+    unsigned int lodCount = mesh.getLodCount();
+    if (lodCount <= 1) {
+        return 0;
+    }
+    float screenSize = calculateScreenSize(mesh.getBounds(), modelMatrix, camera);
+
+    unsigned int lod = getCurrentLod(nodeId, meshIndex);
+    unsigned int maxLod = std::min<unsigned int>(lodCount - 1, _screenSizeThresholds.size());
+    lod = std::min(lod, maxLod);
+
+    // coarsen only once clearly below the threshold, refine only once clearly above it
+    while (lod < maxLod && screenSize < _screenSizeThresholds[lod] * (1.0f - _hysteresis)) {
+        lod++;
+    }
+    while (lod > 0 && screenSize > _screenSizeThresholds[lod - 1] * (1.0f + _hysteresis)) {
+        lod--;
+    }
+    return lod;
+}
+
+unsigned int scratch::LodSelector::getCurrentLod(unsigned int nodeId, size_t meshIndex) const {
+    auto current = _currentLods.find(makeKey(nodeId, meshIndex));
+    return current == _currentLods.end() ? 0 : current->second;
+}
+
+void scratch::LodSelector::recordLod(unsigned int nodeId, size_t meshIndex, unsigned int lod) {
+    _currentLods[makeKey(nodeId, meshIndex)] = lod;
+}
+
+uint64_t scratch::LodSelector::makeKey(unsigned int nodeId, size_t meshIndex) {
+    return (static_cast<uint64_t>(nodeId) << 32) | static_cast<uint64_t>(meshIndex);
+}
+
+float scratch::LodSelector::calculateScreenSize(const scratch::Bounds &bounds, const glm::mat4 &modelMatrix,
+                                                const scratch::Camera &camera) {
+    glm::vec3 center = glm::vec3(modelMatrix * glm::vec4(bounds.getCenter(), 1.0f));
+    float maxScale = std::max(glm::length(glm::vec3(modelMatrix[0])),
+                              std::max(glm::length(glm::vec3(modelMatrix[1])),
+                                       glm::length(glm::vec3(modelMatrix[2]))));
+    float radius = bounds.getRadius() * maxScale;
+    float distance = glm::length(center - camera.getPosition());
+    if (distance <= radius) {
+        return 1.0f;
+    }
+    // projected diameter over the viewport height
+    float halfFieldOfView = glm::radians(camera.getFieldOfView()) * 0.5f;
+    return radius / (distance * std::tan(halfFieldOfView));
+}
+
+void scratch::LodSelector::setScreenSizeThresholds(const std::vector<float> &thresholds) {
+    _screenSizeThresholds = thresholds;
+}
+
+void scratch::LodSelector::setHysteresis(float hysteresis) {
+    _hysteresis = hysteresis;
+}
+
+void scratch::LodSelector::clear() {
+    _currentLods.clear();
+}
+
+size_t scratch::LodSelector::getInstanceCount() const {
+    return _currentLods.size();
+}
+
+void scratch::LodSelector::retainNodes(const std::unordered_map<unsigned int, size_t> &meshCounts) {
+    for (auto current = _currentLods.begin(); current != _currentLods.end();) {
+        auto nodeId = static_cast<unsigned int>(current->first >> 32);
+        auto meshIndex = static_cast<size_t>(current->first & 0xFFFFFFFF);
+        auto meshCount = meshCounts.find(nodeId);
+        if (meshCount == meshCounts.end() || meshIndex >= meshCount->second) {
+            current = _currentLods.erase(current);
+        } else {
+            ++current;
+        }
+    }
+}
@@ -0,0 +1,56 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "camera/camera.h"
+#include "mesh.hpp"
+
+namespace scratch {
+    // Picks a level of detail per mesh instance from its projected size on screen. Remembers the previous
+    // choice for every instance so a level only changes once the size is clearly past a threshold. Selecting only
+    // reads what was remembered, so several threads can select at once as long as nothing records meanwhile.
+    class LodSelector {
+    public:
+        LodSelector();
+
+        unsigned int selectLod(unsigned int nodeId, size_t meshIndex, const scratch::Mesh &mesh,
+                               const glm::mat4 &modelMatrix, const scratch::Camera &camera) const;
+
+        // The level last recorded for the instance, 0 if there's none
+        unsigned int getCurrentLod(unsigned int nodeId, size_t meshIndex) const;
+
+        // Remembers the selected level for the next selection's hysteresis
+        void recordLod(unsigned int nodeId, size_t meshIndex, unsigned int lod);
+
+        // Fraction of the viewport height a mesh's bounding sphere covers, 1 when the camera is inside it
+        static float calculateScreenSize(const scratch::Bounds &bounds, const glm::mat4 &modelMatrix,
+                                         const scratch::Camera &camera);
+
+        // Screen size below which lod i + 1 is used instead of lod i
+        void setScreenSizeThresholds(const std::vector<float> &thresholds);
+
+        // Relative band around each threshold the screen size has to cross before the level changes
+        void setHysteresis(float hysteresis);
+
+        void clear();
+
+        // Number of instances with a level remembered
+        size_t getInstanceCount() const;
+
+        // Forgets the instances of nodes missing from meshCounts, and meshes past a node's count
+        void retainNodes(const std::unordered_map<unsigned int, size_t> &meshCounts);
+
+    private:
+        std::vector<float> _screenSizeThresholds;
+        float _hysteresis;
+        std::unordered_map<uint64_t, unsigned int> _currentLods;
+
+        static uint64_t makeKey(unsigned int nodeId, size_t meshIndex);
+    };
+}
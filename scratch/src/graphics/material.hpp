@@ -12,7 +12,6 @@
 #undef GetObject
 #endif
 
-#include <stb_image.h>
 #include <include/rapidjson/writer.h>
 #include <include/rapidjson/prettywriter.h>
 #include <include/rapidjson/document.h>
@@ -20,9 +19,11 @@
 
 #include "converter/string_converter.h"
 #include "shader.h"
+#include "texture_manager.h"
 
 namespace scratch {
     struct Texture {
+        // TextureManager handle, not a GL texture name
         unsigned int id;
         std::string type;
         std::string path;
@@ -57,6 +58,13 @@ namespace scratch {
         std::vector<Texture> _textures;
         std::shared_ptr<scratch::Shader> _shader;
         std::map<std::string, scratch::Parameter> _parameters;
+        // the shader's variant for the current features, resolved whenever the shader, textures or parameters
+        // change so drawing only reads it
+        scratch::Shader *_activeShader = nullptr;
+
+        void updateActiveShader() {
+            _activeShader = _shader ? _shader->getVariant(getShaderFeatures()) : nullptr;
+        }
     public:
 
         Material(unsigned int id, std::vector<Texture> textures) {
@@ -75,19 +83,60 @@ namespace scratch {
         }
 
         void activate() {
-            _shader->use();
+            getActiveShader()->use();
             setupTextures();
             setupStateParameters();
         }
 
+        // Undoes activate's texture and parameter state before another material or pass uses the units
+        void deactivate() {
+            clearParameters();
+            clearTextures();
+        }
+
         void setShader(std::shared_ptr<scratch::Shader> shader) {
             _shader = shader;
+            updateActiveShader();
         }
 
         std::shared_ptr<scratch::Shader> getShader() {
             return _shader;
         }
 
+        // Features this material's textures and parameters call for
+        uint32_t getShaderFeatures() const {
+            uint32_t features = 0;
+            for (const auto &texture : _textures) {
+                scratch::TextureRole role = scratch::TextureManager::roleFromTypeName(texture.type);
+                if (role == scratch::NORMAL_TEXTURE) {
+                    features |= scratch::NORMAL_MAP_FEATURE;
+                } else if (role == scratch::SPECULAR_TEXTURE) {
+                    features |= scratch::SPECULAR_MAP_FEATURE;
+                }
+            }
+            auto highlighted = _parameters.find("highlighted");
+            if (highlighted != _parameters.end() && highlighted->second.type == BOOL &&
+                scratch::StringConverter::parsebool(highlighted->second.value)) {
+                features |= scratch::HIGHLIGHTED_FEATURE;
+            }
+            return features;
+        }
+
+        // Whether the batched path can reach every texture, see TextureManager::isBatchable
+        bool hasBatchableTextures() const {
+            for (const auto &texture : _textures) {
+                if (!scratch::TextureManager::isBatchable(texture.id)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Variant of the shader matching this material, what actually draws it
+        scratch::Shader *getActiveShader() const {
+            return _activeShader;
+        }
+
         unsigned int getId() const {
             return _id;
         }
@@ -96,12 +145,17 @@ namespace scratch {
             _id = id;
         }
 
+        const std::vector<Texture> &getTextures() const {
+            return _textures;
+        }
+
         const std::map<std::string, scratch::Parameter> &getParameters() const {
             return _parameters;
         }
 
         void setParameters(const std::map<std::string, scratch::Parameter> &parameters) {
             _parameters = parameters;
+            updateActiveShader();
         }
 
         void setBool(const std::string &name, bool value) {
@@ -109,6 +163,7 @@ namespace scratch {
             param.type = scratch::ParameterType::BOOL;
             param.value = scratch::StringConverter::toString(value, false);
             _parameters[name] = param;
+            updateActiveShader();
         }
 
         void setInt(const std::string &name, int value) {
@@ -116,6 +171,7 @@ namespace scratch {
             param.type = scratch::ParameterType::INT;
             param.value = scratch::StringConverter::toString(value);
             _parameters[name] = param;
+            updateActiveShader();
         }
 
         void setFloat(const std::string &name, float value) {
@@ -123,6 +179,7 @@ namespace scratch {
             param.type = scratch::ParameterType::FLOAT;
             param.value = scratch::StringConverter::toString(value);
             _parameters[name] = param;
+            updateActiveShader();
         }
 
         void setMat4(const std::string &name, glm::mat4 value) {
@@ -130,6 +187,7 @@ namespace scratch {
             param.type = scratch::ParameterType::MATRIX4;
             param.value = scratch::StringConverter::toString(value);
             _parameters[name] = param;
+            updateActiveShader();
         }
 
         void setVec3(const std::string &name, glm::vec3 value) {
@@ -137,16 +195,19 @@ namespace scratch {
             param.type = scratch::ParameterType::VECTOR3;
             param.value = scratch::StringConverter::toString(value);
             _parameters[name] = param;
+            updateActiveShader();
         }
 
         void removeParameter(const std::string &name) {
             _parameters.erase(name);
+            updateActiveShader();
         }
 
         void renameParameter(const std::string &oldName, const std::string &newName) {
             auto nodeHandler = _parameters.extract(oldName);
             nodeHandler.key() = newName;
             _parameters.insert(std::move(nodeHandler));
+            updateActiveShader();
         }
 
         void setupTextures() {
@@ -171,29 +232,44 @@ namespace scratch {
                     number = std::to_string(heightNr++); // transfer unsigned int to stream
 
                 // now set the sampler to the correct texture unit
-                glUniform1i(glGetUniformLocation(_shader->getShaderId(), ("material." + name + number).c_str()), i);
+                glUniform1i(glGetUniformLocation(getActiveShader()->getShaderId(), ("material." + name + number).c_str()), i);
                 // and finally bind the texture
-                glBindTexture(GL_TEXTURE_2D, _textures[i].id);
+                glBindTexture(GL_TEXTURE_2D, scratch::TextureManager::getGlTexture(_textures[i].id));
+                glBindSampler(i, scratch::TextureManager::getSampler(_textures[i].id));
+            }
+        }
+
+        // Sampler objects override the state of whatever texture is bound to the unit next, passes that
+        // expect a texture's own filtering mustn't find ours left behind
+        void clearTextures() {
+            scratch::TextureManager::unbindSamplers(0, static_cast<unsigned int>(_textures.size()));
+        }
+
+        // Lets texture streaming know how large this material appears on screen
+        void requestTextureCoverage(float screenFraction) const {
+            for (const auto &texture : _textures) {
+                scratch::TextureManager::requestScreenCoverage(texture.id, screenFraction);
             }
         }
 
         void setupStateParameters() {
+            scratch::Shader *shader = getActiveShader();
             for (auto const &[key, val] : _parameters) {
                 switch (val.type) {
                     case BOOL:
-                        _shader->setBool(key, scratch::StringConverter::parsebool(val.value));
+                        shader->setBool(key, scratch::StringConverter::parsebool(val.value));
                         break;
                     case INT:
-                        _shader->setInt(key, scratch::StringConverter::parseint(val.value));
+                        shader->setInt(key, scratch::StringConverter::parseint(val.value));
                         break;
                     case FLOAT:
-                        _shader->setFloat(key, scratch::StringConverter::parsefloat(val.value));
+                        shader->setFloat(key, scratch::StringConverter::parsefloat(val.value));
                         break;
                     case VECTOR3:
-                        _shader->setVec3(key, scratch::StringConverter::parsevec3(val.value));
+                        shader->setVec3(key, scratch::StringConverter::parsevec3(val.value));
                         break;
                     case MATRIX4:
-                        _shader->setMat4(key, scratch::StringConverter::parsemat4(val.value));
+                        shader->setMat4(key, scratch::StringConverter::parsemat4(val.value));
                         break;
                     default:
                     SCRATCH_ASSERT_NEVER("Unknown Param Type");
@@ -203,22 +279,23 @@ namespace scratch {
         }
 
         void clearParameters() {
+            scratch::Shader *shader = getActiveShader();
             for (auto const &[key, val] : _parameters) {
                 switch (val.type) {
                     case BOOL:
-                        _shader->setBool(key, false);
+                        shader->setBool(key, false);
                         break;
                     case INT:
-                        _shader->setInt(key, 0);
+                        shader->setInt(key, 0);
                         break;
                     case FLOAT:
-                        _shader->setFloat(key, 0);
+                        shader->setFloat(key, 0);
                         break;
                     case VECTOR3:
-                        _shader->setVec3(key, glm::vec3(0));
+                        shader->setVec3(key, glm::vec3(0));
                         break;
                     case MATRIX4:
-                        _shader->setMat4(key, glm::mat4(1));
+                        shader->setMat4(key, glm::mat4(1));
                         break;
                     default:
                     SCRATCH_ASSERT_NEVER("Unknown Param Type");
@@ -298,56 +375,18 @@ namespace scratch {
                 param.value = (*itr)["value"].GetString();
                 _parameters[key] = param;
             }
-
+            updateActiveShader();
         }
 
 
         void addTexture(const std::string path, const std::string typeName) {
             Texture texture;
-            texture.id = textureFromFile(path);
+            texture.id = scratch::TextureManager::requestTexture(path,
+                                                                 scratch::TextureManager::roleFromTypeName(typeName));
             texture.type = typeName;
             texture.path = path;
             _textures.push_back(texture);
-        }
-
-        // TODO: move to TextureManager/ResourceManager
-        unsigned int textureFromFile(const std::string &path, bool gamma = false) {
-            return textureFromFile(path, gamma, GL_REPEAT);
-        }
-
-        unsigned int textureFromFile(const std::string &path, bool gamma, int wrapMode) {
-            std::string filename = std::string(path);
-
-            unsigned int textureId;
-            glGenTextures(1, &textureId);
-
-            int width, height, nrComponents;
-            unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-            if (data) {
-                GLenum format;
-                if (nrComponents == 1)
-                    format = GL_RED;
-                else if (nrComponents == 3)
-                    format = GL_RGB;
-                else if (nrComponents == 4)
-                    format = GL_RGBA;
-
-                glBindTexture(GL_TEXTURE_2D, textureId);
-                glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-                glGenerateMipmap(GL_TEXTURE_2D);
-
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapMode);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapMode);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-                stbi_image_free(data);
-            } else {
-                std::cout << "Texture failed to load at path: " << path << std::endl;
-                stbi_image_free(data);
-            }
-
-            return textureId;
+            updateActiveShader();
         }
     };
 } // namespace scratch
\ No newline at end of file
@@ -9,25 +9,39 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
 #include <utility>
 #include <vector>
 
 #include "shader.h"
+#include "graphics/bounds.h"
+#include "graphics/geometry_pool.h"
+#include "graphics/index_data.h"
 #include "graphics/material.hpp"
+#include "graphics/model_import_settings.h"
+#include "graphics/vertex.h"
 
 namespace scratch {
 
-    struct Vertex {
-        // position
-        glm::vec3 position;
-        // texCoords
-        glm::vec2 texCoords;
-        // normal
-        glm::vec3 normal;
-        // tangent
-        glm::vec3 tangent;
-        // bitangent
-        glm::vec3 bitangent;
+    // A range of the index buffer drawing the mesh at one level of detail
+    struct MeshLod {
+        size_t firstIndex;
+        size_t indexCount;
+        // Simplification error relative to the mesh extent, 0 for the full resolution mesh
+        float error;
+    };
+
+    // CPU side mesh contents produced at import, before they are uploaded
+    struct MeshData {
+        std::vector<Vertex> vertices;
+        // Every level of detail back to back, described by lods
+        std::vector<unsigned int> indices;
+        std::vector<MeshLod> lods;
+        Bounds bounds;
+        // bone weights indexed like vertices, empty for meshes without a skeleton
+        std::vector<SkinningVertex> skinning;
+        // skinned meshes only, see Skeleton::jointBounds
+        std::vector<Bounds> jointBounds;
     };
 
     class Mesh {
@@ -35,32 +49,99 @@ namespace scratch {
 
         /*  Functions  */
         // constructor
-        Mesh(std::vector<Vertex> vertices,
-             std::vector<unsigned int> indices,
+        Mesh(MeshData meshData,
              std::shared_ptr<Material> material,
-             const unsigned int materialIndex) {
-            this->_vertices = std::move(vertices);
-            this->_indices = std::move(indices);
+             const unsigned int materialIndex,
+             const MeshRetentionPolicy retentionPolicy = DISCARD_CPU_DATA) {
+            // narrow the indices to 16 bits when the vertex count allows it
+            this->_indices = IndexData(meshData.indices, meshData.vertices.size());
+            this->_vertices = std::move(meshData.vertices);
+            this->_skinning = std::move(meshData.skinning);
+            this->_lods = std::move(meshData.lods);
+            if (_lods.empty()) {
+                _lods.push_back({0, meshData.indices.size(), 0.0f});
+            }
+            this->_bounds = meshData.bounds;
+            this->_skinned = !_skinning.empty();
             this->_material = material;
             this->_materialIndex = materialIndex;
+            this->_retentionPolicy = retentionPolicy;
+            this->_indexType = _indices.getType();
 
-            // now that we have all the required data, set the vertex buffers and its attribute pointers.
+            // now that we have all the required data, copy it into the shared geometry buffers.
             setupMesh();
+            releaseCpuData();
+        }
+
+        // The pool allocation is owned by exactly one mesh, so meshes can only be moved
+        Mesh(const Mesh &other) = delete;
+
+        Mesh &operator=(const Mesh &other) = delete;
+
+        Mesh(Mesh &&other) noexcept {
+            *this = std::move(other);
         }
 
-        // render the mesh
-        void draw() {
+        Mesh &operator=(Mesh &&other) noexcept {
+            if (this != &other) {
+                GeometryPool::release(_geometry);
+                _vertices = std::move(other._vertices);
+                _skinning = std::move(other._skinning);
+                _positions = std::move(other._positions);
+                _indices = std::move(other._indices);
+                _lods = std::move(other._lods);
+                _bounds = other._bounds;
+                _skinned = other._skinned;
+                _material = std::move(other._material);
+                _materialIndex = other._materialIndex;
+                _retentionPolicy = other._retentionPolicy;
+                _indexType = other._indexType;
+                _geometry = std::exchange(other._geometry, GeometryAllocation());
+            }
+            return *this;
+        }
+
+        ~Mesh() {
+            GeometryPool::release(_geometry);
+        }
+
+        // render the mesh, lod 0 being full resolution. Depth only passes can draw just the positions.
+        void draw(unsigned int lod = 0, VertexStream stream = FULL_VERTEX_STREAM) const {
+            if (!_geometry.isValid()) {
+                return;
+            }
+            const MeshLod &range = getLod(lod);
+            const size_t byteOffset = (_geometry.firstIndex + range.firstIndex) * IndexData::getIndexTypeSize(_indexType);
             // draw mesh
-            glBindVertexArray(_vao);
-            glDrawElements(GL_TRIANGLES, _indices.size(), GL_UNSIGNED_INT, 0);
+            GeometryPool::bind(_indexType, stream);
+            glDrawElementsBaseVertex(GL_TRIANGLES, range.indexCount, _indexType, (void *) byteOffset,
+                                     static_cast<GLint>(_geometry.firstVertex));
             glBindVertexArray(0);
         }
 
+        // Indirect command drawing one level of detail, baseInstance selects the draw's per draw data
+        DrawElementsIndirectCommand getDrawCommand(unsigned int lod, unsigned int baseInstance) const {
+            const MeshLod &range = getLod(lod);
+            return {static_cast<GLuint>(range.indexCount), 1,
+                    static_cast<GLuint>(_geometry.firstIndex + range.firstIndex),
+                    static_cast<GLint>(_geometry.firstVertex), baseInstance};
+        }
+
+        bool isUploaded() const {
+            return _geometry.isValid();
+        }
+
+        // Added to gl_VertexID to find a vertex's bone weights in the pool's skinning buffer
+        GLint getSkinningOffset() const {
+            return _geometry.getSkinningOffset();
+        }
+
         void setMaterial(const std::shared_ptr<Material> &material) {
             _material = material;
         }
 
-        std::shared_ptr<Material> getMaterial() const {
+        // by reference, copying would bump the shared count from every thread building the render queue
+        const std::shared_ptr<Material> &getMaterial() const {
             return _material;
         }
 
@@ -68,54 +149,107 @@ namespace scratch {
             return _materialIndex;
         }
 
+        GLenum getIndexType() const {
+            return _indexType;
+        }
+
+        unsigned int getLodCount() const {
+            return static_cast<unsigned int>(_lods.size());
+        }
+
+        const std::vector<MeshLod> &getLods() const {
+            return _lods;
+        }
+
+        const Bounds &getBounds() const {
+            return _bounds;
+        }
+
+        // Whether the vertices are weighted to the model's skeleton, only then does an animation move them
+        bool isSkinned() const {
+            return _skinned;
+        }
+
+        MeshRetentionPolicy getRetentionPolicy() const {
+            return _retentionPolicy;
+        }
+
+        // CPU side geometry, only available when the retention policy kept it
+        bool hasCpuGeometry() const {
+            return _retentionPolicy != DISCARD_CPU_DATA;
+        }
+
+        size_t getCpuVertexCount() const {
+            return _retentionPolicy == RETAIN_ALL ? _vertices.size() : _positions.size();
+        }
+
+        glm::vec3 getCpuVertexPosition(size_t vertexIndex) const {
+            return _retentionPolicy == RETAIN_ALL ? _vertices[vertexIndex].position : _positions[vertexIndex];
+        }
+
+        const std::vector<Vertex> &getCpuVertices() const {
+            return _vertices;
+        }
+
+        // Indexed like getCpuVertices, empty for meshes that aren't skinned
+        const std::vector<SkinningVertex> &getCpuSkinning() const {
+            return _skinning;
+        }
+
+        // Indices for every level of detail, see getLods for the ranges
+        const IndexData &getCpuIndices() const {
+            return _indices;
+        }
+
     private:
         /*  Mesh Data  */
         std::vector<Vertex> _vertices;
-        std::vector<unsigned int> _indices;
+        std::vector<SkinningVertex> _skinning;
+        std::vector<glm::vec3> _positions;
+        IndexData _indices;
+        std::vector<MeshLod> _lods;
+        Bounds _bounds;
+        bool _skinned = false;
         std::shared_ptr<Material> _material;
-        unsigned int _materialIndex;
-        unsigned int _vao;
+        unsigned int _materialIndex = 0;
+        MeshRetentionPolicy _retentionPolicy = DISCARD_CPU_DATA;
 
         /*  Render data  */
-        unsigned int _vbo, _ebo;
+        GeometryAllocation _geometry;
+        GLenum _indexType = GL_UNSIGNED_INT;
+
+        const MeshLod &getLod(unsigned int lod) const {
+            return _lods[std::min<size_t>(lod, _lods.size() - 1)];
+        }
 
         /*  Functions    */
-        // initializes all the buffer objects/arrays
+        // copies the geometry into the shared buffers
         void setupMesh() {
-            // create buffers/arrays
-            glGenVertexArrays(1, &_vao);
-            glGenBuffers(1, &_vbo);
-            glGenBuffers(1, &_ebo);
-
-            glBindVertexArray(_vao);
-            // load data into vertex buffers
-            glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-            // A great thing about structs is that their memory layout is sequential for all its items.
-            // The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
-            // again translates to 3/2 floats which translates to a byte array.
-            glBufferData(GL_ARRAY_BUFFER, _vertices.size() * sizeof(Vertex), &_vertices[0], GL_STATIC_DRAW);
-
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, _indices.size() * sizeof(unsigned int), &_indices[0], GL_STATIC_DRAW);
-
-            // set the vertex attribute pointers
-            // vertex Positions
-            glEnableVertexAttribArray(0);
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) 0);
-            // vertex normals
-            glEnableVertexAttribArray(1);
-            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, normal));
-            // vertex texture coords
-            glEnableVertexAttribArray(2);
-            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, texCoords));
-            // vertex tangent
-            glEnableVertexAttribArray(3);
-            glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, tangent));
-            // vertex bitangent
-            glEnableVertexAttribArray(4);
-            glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, bitangent));
+            _geometry = GeometryPool::allocate(_vertices, _skinning, _indices);
+        }
 
-            glBindVertexArray(0);
+        // drops whatever the retention policy doesn't need now that the GPU has its own copy
+        void releaseCpuData() {
+            switch (_retentionPolicy) {
+                case DISCARD_CPU_DATA:
+                    std::vector<Vertex>().swap(_vertices);
+                    std::vector<SkinningVertex>().swap(_skinning);
+                    _indices.clear();
+                    break;
+                case RETAIN_POSITIONS_AND_INDICES:
+                    _positions.reserve(_vertices.size());
+                    for (const auto &vertex : _vertices) {
+                        _positions.push_back(vertex.position);
+                    }
+                    std::vector<Vertex>().swap(_vertices);
+                    std::vector<SkinningVertex>().swap(_skinning);
+                    break;
+                case RETAIN_ALL:
+                    break;
+                default:
+                SCRATCH_ASSERT_NEVER("Unknown Retention Policy");
+                    break;
+            }
         }
     };
 } // namespace scratch
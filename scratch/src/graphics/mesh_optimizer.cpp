@@ -0,0 +1,167 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include <cmath>
+#include <limits>
+
+#include "mesh_optimizer.h"
+
+void scratch::MeshOptimizer::calculateTangents(std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices) {
+    std::vector<glm::vec3> tangents(vertices.size(), glm::vec3(0.0f));
+    std::vector<glm::vec3> bitangents(vertices.size(), glm::vec3(0.0f));
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const Vertex &v0 = vertices[indices[i]];
+        const Vertex &v1 = vertices[indices[i + 1]];
+        const Vertex &v2 = vertices[indices[i + 2]];
+        glm::vec3 edge1 = v1.position - v0.position;
+        glm::vec3 edge2 = v2.position - v0.position;
+        glm::vec2 deltaUv1 = v1.texCoords - v0.texCoords;
+        glm::vec2 deltaUv2 = v2.texCoords - v0.texCoords;
+        float determinant = deltaUv1.x * deltaUv2.y - deltaUv2.x * deltaUv1.y;
+        if (std::abs(determinant) < std::numeric_limits<float>::epsilon()) {
+            // degenerate UVs don't say anything about the tangent direction
+            continue;
+        }
+        float inverse = 1.0f / determinant;
+        glm::vec3 tangent = (edge1 * deltaUv2.y - edge2 * deltaUv1.y) * inverse;
+        glm::vec3 bitangent = (edge2 * deltaUv1.x - edge1 * deltaUv2.x) * inverse;
+        for (size_t corner = 0; corner < 3; ++corner) {
+            tangents[indices[i + corner]] += tangent;
+            bitangents[indices[i + corner]] += bitangent;
+        }
+    }
+
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        Vertex &vertex = vertices[i];
+        glm::vec3 normal = vertex.normal;
+        // Gram-Schmidt against the normal
+        glm::vec3 tangent = tangents[i] - normal * glm::dot(normal, tangents[i]);
+        if (glm::length(tangent) < 1e-6f) {
+            // no usable UVs, any vector perpendicular to the normal will do
+            glm::vec3 axis = std::abs(normal.x) < 0.9f ? glm::vec3(1, 0, 0) : glm::vec3(0, 1, 0);
+            tangent = glm::cross(normal, axis);
+        }
+        tangent = glm::normalize(tangent);
+        float handedness = glm::dot(glm::cross(normal, tangent), bitangents[i]) < 0.0f ? -1.0f : 1.0f;
+        vertex.tangent = tangent;
+        vertex.bitangent = glm::cross(normal, tangent) * handedness;
+    }
+}
+
+void scratch::MeshOptimizer::optimizeVertexCache(std::vector<unsigned int> &indices, size_t vertexCount,
+                                                 unsigned int cacheSize) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0) {
+        return;
+    }
+
+    // triangles touching each vertex
+    std::vector<unsigned int> offsets(vertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        offsets[indices[i] + 1]++;
+    }
+    for (size_t i = 0; i < vertexCount; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+    std::vector<unsigned int> adjacentTriangles(triangleCount * 3);
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        adjacentTriangles[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+    }
+
+    std::vector<unsigned int> liveTriangles(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        liveTriangles[i] = offsets[i + 1] - offsets[i];
+    }
+    std::vector<unsigned int> cacheTimestamps(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> deadEnd;
+    std::vector<unsigned int> candidates;
+    std::vector<unsigned int> result;
+    result.reserve(triangleCount * 3);
+
+    unsigned int timestamp = cacheSize + 1;
+    size_t cursor = 0;
+    long fanningVertex = 0;
+    while (fanningVertex >= 0) {
+        candidates.clear();
+        for (unsigned int i = offsets[fanningVertex]; i < offsets[fanningVertex + 1]; ++i) {
+            unsigned int triangle = adjacentTriangles[i];
+            if (emitted[triangle]) {
+                continue;
+            }
+            for (size_t corner = 0; corner < 3; ++corner) {
+                unsigned int vertex = indices[triangle * 3 + corner];
+                result.push_back(vertex);
+                deadEnd.push_back(vertex);
+                candidates.push_back(vertex);
+                liveTriangles[vertex]--;
+                if (timestamp - cacheTimestamps[vertex] > cacheSize) {
+                    cacheTimestamps[vertex] = timestamp++;
+                }
+            }
+            emitted[triangle] = true;
+        }
+
+        // prefer the candidate still in cache that will stay there while its remaining triangles are emitted
+        long nextVertex = -1;
+        int bestPriority = -1;
+        for (unsigned int vertex : candidates) {
+            if (liveTriangles[vertex] == 0) {
+                continue;
+            }
+            int priority = 0;
+            if (timestamp - cacheTimestamps[vertex] + 2 * liveTriangles[vertex] <= cacheSize) {
+                priority = static_cast<int>(timestamp - cacheTimestamps[vertex]);
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                nextVertex = vertex;
+            }
+        }
+        // otherwise back out through recently used vertices, then fall back to scanning
+        while (nextVertex < 0 && !deadEnd.empty()) {
+            unsigned int vertex = deadEnd.back();
+            deadEnd.pop_back();
+            if (liveTriangles[vertex] > 0) {
+                nextVertex = vertex;
+            }
+        }
+        while (nextVertex < 0 && cursor < vertexCount) {
+            if (liveTriangles[cursor] > 0) {
+                nextVertex = static_cast<long>(cursor);
+            }
+            cursor++;
+        }
+        fanningVertex = nextVertex;
+    }
+
+    // anything past the last whole triangle is left where it was
+    result.insert(result.end(), indices.begin() + triangleCount * 3, indices.end());
+    indices = std::move(result);
+}
+
+void scratch::MeshOptimizer::optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<SkinningVertex> &skinning,
+                                                 std::vector<unsigned int> &indices) {
+    const unsigned int unused = std::numeric_limits<unsigned int>::max();
+    const bool skinned = !skinning.empty();
+    std::vector<unsigned int> remap(vertices.size(), unused);
+    std::vector<Vertex> reordered;
+    std::vector<SkinningVertex> reorderedSkinning;
+    reordered.reserve(vertices.size());
+    reorderedSkinning.reserve(skinning.size());
+    for (auto &index : indices) {
+        if (remap[index] == unused) {
+            remap[index] = static_cast<unsigned int>(reordered.size());
+            reordered.push_back(vertices[index]);
+            if (skinned) {
+                reorderedSkinning.push_back(skinning[index]);
+            }
+        }
+        index = remap[index];
+    }
+    vertices = std::move(reordered);
+    skinning = std::move(reorderedSkinning);
+}
@@ -0,0 +1,28 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "mesh.hpp"
+
+namespace scratch {
+    // Import time mesh processing. Everything here is CPU only and safe to run on worker threads.
+    class MeshOptimizer {
+    public:
+        // Per vertex tangent frames from UV derivatives, orthogonalized against the vertex normal
+        static void calculateTangents(std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices);
+
+        // Reorders triangles for post transform cache hits (Tipsify, Sander et al. 2007)
+        static void optimizeVertexCache(std::vector<unsigned int> &indices, size_t vertexCount,
+                                        unsigned int cacheSize = 16);
+
+        // Reorders vertices by first use so fetches walk the vertex buffer linearly, dropping unused vertices.
+        // Every index range in indices is remapped, so it can hold several levels of detail. Skinning, when not
+        // empty, is indexed like vertices and reordered with them.
+        static void optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<SkinningVertex> &skinning,
+                                        std::vector<unsigned int> &indices);
+    };
+}
@@ -0,0 +1,373 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+#include "mesh_simplifier.h"
+#include "bounds.h"
+
+namespace {
+    // Symmetric 4x4 matrix summing squared distances to a set of planes, normalized by the total weight
+    struct Quadric {
+        double a2 = 0, b2 = 0, c2 = 0, d2 = 0;
+        double ab = 0, ac = 0, ad = 0;
+        double bc = 0, bd = 0, cd = 0;
+        double weight = 0;
+
+        void addPlane(const glm::dvec3 &normal, double distance, double planeWeight) {
+            a2 += planeWeight * normal.x * normal.x;
+            b2 += planeWeight * normal.y * normal.y;
+            c2 += planeWeight * normal.z * normal.z;
+            d2 += planeWeight * distance * distance;
+            ab += planeWeight * normal.x * normal.y;
+            ac += planeWeight * normal.x * normal.z;
+            ad += planeWeight * normal.x * distance;
+            bc += planeWeight * normal.y * normal.z;
+            bd += planeWeight * normal.y * distance;
+            cd += planeWeight * normal.z * distance;
+            weight += planeWeight;
+        }
+
+        void add(const Quadric &other) {
+            a2 += other.a2;
+            b2 += other.b2;
+            c2 += other.c2;
+            d2 += other.d2;
+            ab += other.ab;
+            ac += other.ac;
+            ad += other.ad;
+            bc += other.bc;
+            bd += other.bd;
+            cd += other.cd;
+            weight += other.weight;
+        }
+
+        // Mean squared distance from the point to the accumulated planes
+        double evaluate(const glm::vec3 &point) const {
+            if (weight <= 0) {
+                return 0;
+            }
+            double x = point.x, y = point.y, z = point.z;
+            double result = a2 * x * x + b2 * y * y + c2 * z * z + d2
+                            + 2 * (ab * x * y + ac * x * z + ad * x + bc * y * z + bd * y + cd * z);
+            return std::max(result, 0.0) / weight;
+        }
+    };
+
+    enum VertexKind : uint8_t {
+        MANIFOLD,
+        // two wedges on a seam running through the vertex, only moves along the seam with both wedges
+        SEAM,
+        // open borders and the ends and crossings of seams, never moved
+        LOCKED
+    };
+
+    const unsigned int NO_WEDGE = ~0u;
+
+    struct Collapse {
+        unsigned int from;
+        unsigned int to;
+        // the other wedge of a seam vertex and where it goes, NO_WEDGE otherwise
+        unsigned int siblingFrom;
+        unsigned int siblingTo;
+        double error;
+    };
+
+    // The vertices a triangle used for a directed edge between two positions
+    struct EdgeWedges {
+        unsigned int from;
+        unsigned int to;
+    };
+
+    uint64_t edgeKey(unsigned int a, unsigned int b) {
+        return (static_cast<uint64_t>(a) << 32) | b;
+    }
+
+    // Directed edges between canonical positions, keeping the vertices the first triangle along each used
+    void buildEdgeWedges(const std::vector<unsigned int> &indices, const std::vector<unsigned int> &canonical,
+                         std::unordered_map<uint64_t, EdgeWedges> &edges) {
+        edges.clear();
+        edges.reserve(indices.size());
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            for (int e = 0; e < 3; ++e) {
+                unsigned int a = indices[i + e];
+                unsigned int b = indices[i + (e + 1) % 3];
+                edges.emplace(edgeKey(canonical[a], canonical[b]), EdgeWedges{a, b});
+            }
+        }
+    }
+
+    struct PositionHasher {
+        size_t operator()(const glm::vec3 &position) const {
+            uint32_t bits[3];
+            std::memcpy(bits, &position, sizeof(bits));
+            return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+        }
+    };
+
+    // Triangles touching each vertex, stored as one flat array indexed through offsets
+    struct Adjacency {
+        std::vector<unsigned int> offsets;
+        std::vector<unsigned int> triangles;
+
+        void build(const std::vector<unsigned int> &indices, size_t vertexCount) {
+            offsets.assign(vertexCount + 1, 0);
+            for (unsigned int index : indices) {
+                offsets[index + 1]++;
+            }
+            for (size_t i = 0; i < vertexCount; ++i) {
+                offsets[i + 1] += offsets[i];
+            }
+            triangles.resize(indices.size());
+            std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); ++i) {
+                triangles[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+            }
+        }
+    };
+
+    glm::vec3 triangleNormal(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c) {
+        return glm::cross(b - a, c - a);
+    }
+
+    // Moving `from` onto `to` must not turn any remaining triangle around `from` inside out
+    bool collapseFlipsTriangle(unsigned int from, unsigned int to,
+                               const std::vector<glm::vec3> &positions,
+                               const std::vector<unsigned int> &indices,
+                               const Adjacency &adjacency) {
+        for (unsigned int i = adjacency.offsets[from]; i < adjacency.offsets[from + 1]; ++i) {
+            unsigned int triangle = adjacency.triangles[i];
+            unsigned int corners[3] = {indices[triangle * 3], indices[triangle * 3 + 1], indices[triangle * 3 + 2]};
+            if (corners[0] == to || corners[1] == to || corners[2] == to) {
+                // this triangle degenerates and gets removed
+                continue;
+            }
+            glm::vec3 before = triangleNormal(positions[corners[0]], positions[corners[1]], positions[corners[2]]);
+            for (auto &corner : corners) {
+                if (corner == from) {
+                    corner = to;
+                }
+            }
+            glm::vec3 after = triangleNormal(positions[corners[0]], positions[corners[1]], positions[corners[2]]);
+            if (glm::dot(before, after) <= 0.0f) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+std::vector<unsigned int> scratch::MeshSimplifier::simplify(const std::vector<glm::vec3> &positions,
+                                                            const std::vector<unsigned int> &indices,
+                                                            size_t targetIndexCount,
+                                                            float targetError,
+                                                            float *resultError) {
+    std::vector<unsigned int> result = indices;
+    size_t vertexCount = positions.size();
+    if (resultError != nullptr) {
+        *resultError = 0.0f;
+    }
+    if (vertexCount == 0 || result.size() <= targetIndexCount) {
+        return result;
+    }
+
+    // Vertices sharing a position but not an index are wedges, either side of a UV or normal seam or
+    // separate surfaces that only touch
+    std::vector<unsigned int> canonical(vertexCount);
+    std::vector<unsigned int> wedgeCount(vertexCount, 0);
+    std::unordered_map<glm::vec3, unsigned int, PositionHasher> firstAtPosition;
+    firstAtPosition.reserve(vertexCount);
+    for (unsigned int i = 0; i < vertexCount; ++i) {
+        auto inserted = firstAtPosition.emplace(positions[i], i);
+        canonical[i] = inserted.first->second;
+        wedgeCount[canonical[i]]++;
+    }
+
+    // An edge without a matching edge in the opposite direction is an open border. One whose triangles
+    // either side use different wedges is a seam, and gets counted at both its ends from both sides.
+    std::unordered_map<uint64_t, EdgeWedges> edgeWedges;
+    buildEdgeWedges(result, canonical, edgeWedges);
+    std::vector<bool> border(vertexCount, false);
+    std::vector<unsigned int> seamEdges(vertexCount, 0);
+    for (size_t i = 0; i < result.size(); i += 3) {
+        for (int e = 0; e < 3; ++e) {
+            unsigned int a = result[i + e];
+            unsigned int b = result[i + (e + 1) % 3];
+            auto reverse = edgeWedges.find(edgeKey(canonical[b], canonical[a]));
+            if (reverse == edgeWedges.end()) {
+                border[canonical[a]] = true;
+                border[canonical[b]] = true;
+            } else if (reverse->second.from != b || reverse->second.to != a) {
+                seamEdges[canonical[a]]++;
+                seamEdges[canonical[b]]++;
+            }
+        }
+    }
+
+    // Wedges that no seam edge separates can move on their own, a seam can only slide along itself where
+    // exactly two wedges meet two seam edges
+    std::vector<VertexKind> kinds(vertexCount, MANIFOLD);
+    for (unsigned int i = 0; i < vertexCount; ++i) {
+        unsigned int position = canonical[i];
+        if (border[position]) {
+            kinds[i] = LOCKED;
+        } else if (seamEdges[position] == 0) {
+            kinds[i] = MANIFOLD;
+        } else if (wedgeCount[position] == 2 && seamEdges[position] == 4) {
+            kinds[i] = SEAM;
+        } else {
+            kinds[i] = LOCKED;
+        }
+    }
+
+    // Area weighted plane quadrics, shared between all wedges of a position
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < result.size(); i += 3) {
+        glm::dvec3 p0 = glm::dvec3(positions[result[i]]);
+        glm::dvec3 p1 = glm::dvec3(positions[result[i + 1]]);
+        glm::dvec3 p2 = glm::dvec3(positions[result[i + 2]]);
+        glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+        double doubleArea = glm::length(normal);
+        if (doubleArea <= 0) {
+            continue;
+        }
+        normal /= doubleArea;
+        double distance = -glm::dot(normal, p0);
+        Quadric plane;
+        plane.addPlane(normal, distance, doubleArea * 0.5);
+        for (int c = 0; c < 3; ++c) {
+            quadrics[canonical[result[i + c]]].add(plane);
+        }
+    }
+
+    // Errors are squared world distances, scale the limit by the mesh size so it is resolution independent
+    std::vector<glm::vec3> usedPositions;
+    usedPositions.reserve(vertexCount);
+    for (unsigned int i = 0; i < vertexCount; ++i) {
+        if (canonical[i] == i) {
+            usedPositions.push_back(positions[i]);
+        }
+    }
+    float meshScale = std::max(scratch::Bounds::fromPoints(usedPositions).getRadius(), 1e-6f);
+    double errorLimit = static_cast<double>(targetError) * meshScale;
+    errorLimit *= errorLimit;
+    double worstError = 0;
+
+    Adjacency adjacency;
+    std::vector<Collapse> collapses;
+    std::vector<unsigned int> remap(vertexCount);
+    std::vector<bool> touched(vertexCount);
+
+    // Moving from onto to along one side of an edge, with a seam vertex's other wedge following along the other
+    auto addCollapse = [&](unsigned int from, unsigned int to) {
+        unsigned int siblingFrom = NO_WEDGE;
+        unsigned int siblingTo = NO_WEDGE;
+        if (kinds[from] == SEAM) {
+            auto reverse = edgeWedges.find(edgeKey(canonical[to], canonical[from]));
+            if (reverse == edgeWedges.end() || reverse->second.to == from) {
+                // not along the seam, moving one wedge would tear the other side open
+                return;
+            }
+            siblingFrom = reverse->second.to;
+            siblingTo = reverse->second.from;
+        } else if (kinds[from] != MANIFOLD) {
+            return;
+        }
+        Quadric combined = quadrics[canonical[from]];
+        combined.add(quadrics[canonical[to]]);
+        collapses.push_back({from, to, siblingFrom, siblingTo, combined.evaluate(positions[to])});
+    };
+    auto markOneRing = [&](unsigned int vertex) {
+        for (unsigned int t = adjacency.offsets[vertex]; t < adjacency.offsets[vertex + 1]; ++t) {
+            unsigned int triangle = adjacency.triangles[t];
+            touched[result[triangle * 3]] = true;
+            touched[result[triangle * 3 + 1]] = true;
+            touched[result[triangle * 3 + 2]] = true;
+        }
+    };
+
+    while (result.size() > targetIndexCount) {
+        adjacency.build(result, vertexCount);
+        buildEdgeWedges(result, canonical, edgeWedges);
+
+        collapses.clear();
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int e = 0; e < 3; ++e) {
+                unsigned int a = result[i + e];
+                unsigned int b = result[i + (e + 1) % 3];
+                // in either direction along the edge
+                addCollapse(a, b);
+                addCollapse(b, a);
+            }
+        }
+        if (collapses.empty()) {
+            break;
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse &left, const Collapse &right) {
+            return left.error < right.error;
+        });
+
+        for (unsigned int i = 0; i < vertexCount; ++i) {
+            remap[i] = i;
+        }
+        std::fill(touched.begin(), touched.end(), false);
+
+        // each collapse removes roughly two triangles
+        size_t trianglesToRemove = (result.size() - targetIndexCount) / 3;
+        size_t trianglesRemoved = 0;
+        size_t collapseCount = 0;
+        for (const auto &collapse : collapses) {
+            if (collapse.error > errorLimit || trianglesRemoved >= trianglesToRemove) {
+                break;
+            }
+            bool seam = collapse.siblingFrom != NO_WEDGE;
+            if (touched[collapse.from] || touched[collapse.to] ||
+                (seam && (touched[collapse.siblingFrom] || touched[collapse.siblingTo]))) {
+                continue;
+            }
+            if (collapseFlipsTriangle(collapse.from, collapse.to, positions, result, adjacency) ||
+                (seam && collapseFlipsTriangle(collapse.siblingFrom, collapse.siblingTo, positions, result,
+                                               adjacency))) {
+                continue;
+            }
+            remap[collapse.from] = collapse.to;
+            quadrics[canonical[collapse.to]].add(quadrics[canonical[collapse.from]]);
+            worstError = std::max(worstError, collapse.error);
+            // lock the one-ring so no other collapse this pass invalidates the flip test above
+            markOneRing(collapse.from);
+            if (seam) {
+                remap[collapse.siblingFrom] = collapse.siblingTo;
+                markOneRing(collapse.siblingFrom);
+            }
+            trianglesRemoved += 2;
+            collapseCount++;
+        }
+        if (collapseCount == 0) {
+            break;
+        }
+
+        size_t writeIndex = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            unsigned int a = remap[result[i]];
+            unsigned int b = remap[result[i + 1]];
+            unsigned int c = remap[result[i + 2]];
+            if (a == b || b == c || c == a) {
+                continue;
+            }
+            result[writeIndex++] = a;
+            result[writeIndex++] = b;
+            result[writeIndex++] = c;
+        }
+        result.resize(writeIndex);
+    }
+
+    if (resultError != nullptr) {
+        *resultError = static_cast<float>(std::sqrt(worstError) / meshScale);
+    }
+    return result;
+}
@@ -0,0 +1,25 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace scratch {
+    // Quadric error edge collapse simplifier. Produces a new index buffer over the same vertices,
+    // so every level of detail can share the original vertex buffer.
+    class MeshSimplifier {
+    public:
+        // Collapses edges until the index count reaches targetIndexCount or the next collapse would move the
+        // surface further than targetError (relative to the mesh extent). Open borders are never moved and
+        // UV or normal seams only slide along themselves, both sides at once, so texture seams and silhouettes
+        // stay intact.
+        static std::vector<unsigned int> simplify(const std::vector<glm::vec3> &positions,
+                                                  const std::vector<unsigned int> &indices,
+                                                  size_t targetIndexCount,
+                                                  float targetError,
+                                                  float *resultError = nullptr);
+    };
+}
@@ -1,3 +1,5 @@
+#include <cmath>
+#include <cstdint>
 #include <string>
 #include <iostream>
 #include <vector>
@@ -7,20 +9,24 @@
 #include <assimp/postprocess.h>
 
 #include "model.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
+#include "main.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 
 #include <stb_image.h>
 
-unsigned int textureFromFile(const std::string &path, const std::string &directory, bool gamma = false);
+glm::vec3 convertVector3(const aiVector3D &aiVec3);
 
-unsigned int textureFromFile(const std::string &path, const std::string &directory, bool gamma, int wrapMode);
+glm::quat convertQuaternion(const aiQuaternion &aiQuat);
 
-glm::vec3 convertVector3(aiVector3D aiVec3);
+glm::mat4 convertMatrix(const aiMatrix4x4 &aiMat);
 
-scratch::Model::Model(unsigned int id, const std::string &path) {
+scratch::Model::Model(unsigned int id, const std::string &path, const ModelImportSettings &importSettings) {
     _id = id;
     _modelPath = path;
+    _importSettings = importSettings;
     loadModel(path);
 }
 
@@ -31,8 +37,13 @@ std::vector<scratch::Mesh> &scratch::Model::getMeshes() {
 void scratch::Model::loadModel(const std::string &path) {
     Assimp::Importer import;
     // Import scene data (Triangulate = Make all faces 3 indices(x,y,z))
+    // Tangents are calculated per mesh on the worker threads instead of by assimp
+    // Vertices keep at most the four bones the vertex format has room for
+    // Many formats store three vertices per face, identical ones are welded so the vertex cache optimizer has
+    // something to reuse and the simplifier only sees real attribute seams
     const aiScene *scene = import.ReadFile(path,
-                                           aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+                                           aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenSmoothNormals |
+                                           aiProcess_JoinIdenticalVertices | aiProcess_LimitBoneWeights);
 
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
         std::cout << "ERROR::ASSIMP::" << import.GetErrorString() << std::endl;
@@ -45,19 +56,132 @@ void scratch::Model::loadModel(const std::string &path) {
         _materials.push_back(transformMaterial(scene->mMaterials[i]));
     }
 
-    processNode(scene->mRootNode, scene);
+    std::vector<const aiMesh *> sceneMeshes;
+    collectMeshes(scene->mRootNode, scene, sceneMeshes);
+    std::unordered_map<std::string, int> jointIndices = loadSkeleton(scene, sceneMeshes);
+    loadAnimations(scene, jointIndices);
+
+    // Convert every mesh on the job system, each job writing only its own slot
+    std::vector<MeshData> convertedMeshes(sceneMeshes.size());
+    scratch::ScratchManagers->jobSystem->parallelFor(sceneMeshes.size(), [&](size_t i) {
+        convertedMeshes[i] = processMesh(sceneMeshes[i], jointIndices);
+    });
+
+    // GL buffers can only be created on the main thread
+    _meshes.reserve(_meshes.size() + sceneMeshes.size());
+    for (size_t i = 0; i < sceneMeshes.size(); ++i) {
+        const std::vector<Bounds> &jointBounds = convertedMeshes[i].jointBounds;
+        for (size_t joint = 0; joint < jointBounds.size(); ++joint) {
+            if (!jointBounds[joint].isEmpty()) {
+                _skeleton.jointBounds[joint].encapsulate(jointBounds[joint].getMin());
+                _skeleton.jointBounds[joint].encapsulate(jointBounds[joint].getMax());
+            }
+        }
+        unsigned int materialIndex = sceneMeshes[i]->mMaterialIndex;
+        _meshes.emplace_back(std::move(convertedMeshes[i]), _materials[materialIndex], materialIndex,
+                             _importSettings.retentionPolicy);
+    }
 }
 
-void scratch::Model::processNode(aiNode *node, const aiScene *scene) {
+void scratch::Model::collectMeshes(const aiNode *node, const aiScene *scene, std::vector<const aiMesh *> &meshes) {
     // process all the node's meshes (if any)
     for (unsigned int i = 0; i < node->mNumMeshes; i++) {
-        aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
-        Mesh convertedMesh = processMesh(mesh, scene);
-        _meshes.push_back(convertedMesh);
+        meshes.push_back(scene->mMeshes[node->mMeshes[i]]);
     }
     // then do the same for each of its children
     for (unsigned int i = 0; i < node->mNumChildren; i++) {
-        processNode(node->mChildren[i], scene);
+        collectMeshes(node->mChildren[i], scene, meshes);
+    }
+}
+
+std::unordered_map<std::string, int> scratch::Model::loadSkeleton(const aiScene *scene,
+                                                                const std::vector<const aiMesh *> &meshes) {
+    _skeleton = Skeleton();
+    std::unordered_map<std::string, int> jointIndices;
+    bool rigged = scene->mNumAnimations > 0;
+    for (const aiMesh *mesh : meshes) {
+        rigged = rigged || mesh->HasBones();
+    }
+    if (!rigged) {
+        return jointIndices;
+    }
+
+    addJoint(scene->mRootNode, -1, jointIndices);
+    // filled in from each mesh's weights once they're converted
+    _skeleton.jointBounds.assign(_skeleton.getJointCount(), Bounds());
+    _skeleton.rootTransform = glm::inverse(convertMatrix(scene->mRootNode->mTransformation));
+    // a bone shared by several meshes has the same offset in each
+    for (const aiMesh *mesh : meshes) {
+        for (unsigned int i = 0; i < mesh->mNumBones; ++i) {
+            const aiBone *bone = mesh->mBones[i];
+            auto found = jointIndices.find(bone->mName.C_Str());
+            if (found != jointIndices.end()) {
+                _skeleton.inverseBindMatrices[found->second] = convertMatrix(bone->mOffsetMatrix);
+            }
+        }
+    }
+    if (_skeleton.getJointCount() > UINT16_MAX) {
+        std::cout << "WARNING::MODEL::" << _modelPath << " has more joints than vertices can reference" << std::endl;
+    }
+    return jointIndices;
+}
+
+void scratch::Model::addJoint(const aiNode *node, int parent, std::unordered_map<std::string, int> &jointIndices) {
+    int joint = static_cast<int>(_skeleton.getJointCount());
+    aiVector3D scale;
+    aiQuaternion rotation;
+    aiVector3D translation;
+    node->mTransformation.Decompose(scale, rotation, translation);
+    _skeleton.jointNames.emplace_back(node->mName.C_Str());
+    _skeleton.parents.push_back(parent);
+    _skeleton.bindPose.push_back({convertVector3(translation), convertQuaternion(rotation), convertVector3(scale)});
+    _skeleton.inverseBindMatrices.emplace_back(1.0f);
+    // bones and channels refer to nodes by name, the first node with a name wins
+    jointIndices.emplace(node->mName.C_Str(), joint);
+    for (unsigned int i = 0; i < node->mNumChildren; i++) {
+        addJoint(node->mChildren[i], joint, jointIndices);
+    }
+}
+
+void scratch::Model::loadAnimations(const aiScene *scene, const std::unordered_map<std::string, int> &jointIndices) {
+    _animations.clear();
+    if (jointIndices.empty()) {
+        return;
+    }
+    for (unsigned int i = 0; i < scene->mNumAnimations; ++i) {
+        const aiAnimation *animation = scene->mAnimations[i];
+        // assimp counts in ticks, files that don't say how fast they tick are usually 25 a second
+        double ticksPerSecond = animation->mTicksPerSecond > 0.0 ? animation->mTicksPerSecond : 25.0;
+        AnimationClip clip;
+        clip.name = animation->mName.C_Str();
+        if (clip.name.empty()) {
+            clip.name = "Animation " + std::to_string(i);
+        }
+        clip.duration = static_cast<float>(animation->mDuration / ticksPerSecond);
+        clip.channels.resize(_skeleton.getJointCount());
+        for (unsigned int c = 0; c < animation->mNumChannels; ++c) {
+            const aiNodeAnim *nodeAnimation = animation->mChannels[c];
+            auto found = jointIndices.find(nodeAnimation->mNodeName.C_Str());
+            if (found == jointIndices.end()) {
+                continue;
+            }
+            JointChannel &channel = clip.channels[found->second];
+            for (unsigned int k = 0; k < nodeAnimation->mNumPositionKeys; ++k) {
+                channel.translationTimes.push_back(
+                        static_cast<float>(nodeAnimation->mPositionKeys[k].mTime / ticksPerSecond));
+                channel.translations.push_back(convertVector3(nodeAnimation->mPositionKeys[k].mValue));
+            }
+            for (unsigned int k = 0; k < nodeAnimation->mNumRotationKeys; ++k) {
+                channel.rotationTimes.push_back(
+                        static_cast<float>(nodeAnimation->mRotationKeys[k].mTime / ticksPerSecond));
+                channel.rotations.push_back(convertQuaternion(nodeAnimation->mRotationKeys[k].mValue));
+            }
+            for (unsigned int k = 0; k < nodeAnimation->mNumScalingKeys; ++k) {
+                channel.scaleTimes.push_back(static_cast<float>(nodeAnimation->mScalingKeys[k].mTime / ticksPerSecond));
+                channel.scales.push_back(convertVector3(nodeAnimation->mScalingKeys[k].mValue));
+            }
+        }
+        _animations.push_back(std::move(clip));
     }
 }
 
@@ -93,53 +217,168 @@ void scratch::Model::attachMaterialTextures(const std::shared_ptr<scratch::Mater
     }
 }
 
-scratch::Mesh scratch::Model::processMesh(aiMesh *mesh, const aiScene *scene) {
+scratch::MeshData scratch::Model::processMesh(const aiMesh *mesh,
+                                              const std::unordered_map<std::string, int> &jointIndices) const {
     // data to fill
-    std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
-    std::vector<Texture> textures;
+    MeshData meshData;
+    std::vector<Vertex> &vertices = meshData.vertices;
+    std::vector<unsigned int> &indices = meshData.indices;
 
     // Walk through each of the mesh's vertices
+    vertices.resize(mesh->mNumVertices);
     for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
-        Vertex vertex{};
+        Vertex &vertex = vertices[i];
         // positions
         vertex.position = convertVector3(mesh->mVertices[i]);
         // normals
         vertex.normal = convertVector3(mesh->mNormals[i]);
         // texture coordinates
         if (mesh->HasTextureCoords(0)) {
-            glm::vec2 vec;
             // a vertex can contain up to 8 different texture coordinates. We thus make the assumption that we won't
             // use models where a vertex can have multiple texture coordinates so we always take the first set (0).
-            vec.x = mesh->mTextureCoords[0][i].x;
-            vec.y = mesh->mTextureCoords[0][i].y;
-            vertex.texCoords = vec;
-        } else
+            vertex.texCoords = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
+        } else {
             vertex.texCoords = glm::vec2(0.0f, 0.0f);
-        if (mesh->HasTangentsAndBitangents()) {
-            // tangent
-            vertex.tangent = convertVector3(mesh->mTangents[i]);
-            // bitangent
-            vertex.bitangent = convertVector3(mesh->mBitangents[i]);
         }
-        vertices.push_back(vertex);
     }
-    // now wak through each of the mesh's faces (a face is a mesh its triangle) and retrieve the corresponding vertex indices.
+
+    // now walk through each of the mesh's faces and retrieve the corresponding vertex indices.
+    // Triangulation can still leave points and lines behind, those aren't drawn as triangles.
+    size_t triangleCount = 0;
     for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
-        aiFace face = mesh->mFaces[i];
-        // retrieve all indices of the face and store them in the indices vector
-        for (unsigned int j = 0; j < face.mNumIndices; j++)
-            indices.push_back(face.mIndices[j]);
+        if (mesh->mFaces[i].mNumIndices == 3) {
+            triangleCount++;
+        }
+    }
+    indices.resize(triangleCount * 3);
+    size_t writeIndex = 0;
+    for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
+        const aiFace &face = mesh->mFaces[i];
+        if (face.mNumIndices != 3) {
+            continue;
+        }
+        indices[writeIndex++] = face.mIndices[0];
+        indices[writeIndex++] = face.mIndices[1];
+        indices[writeIndex++] = face.mIndices[2];
+    }
+
+    // before any reordering, bone weights refer to vertices by their index in the file
+    if (mesh->HasBones() && !jointIndices.empty()) {
+        addBoneWeights(mesh, jointIndices, meshData);
+    }
+
+    scratch::MeshOptimizer::calculateTangents(vertices, indices);
+    scratch::MeshOptimizer::optimizeVertexCache(indices, vertices.size());
+
+    meshData.lods.push_back({0, indices.size(), 0.0f});
+    if (_importSettings.generateLods) {
+        generateLods(meshData);
+    }
+
+    // reorder vertices last so every level of detail is remapped together
+    scratch::MeshOptimizer::optimizeVertexFetch(vertices, meshData.skinning, indices);
+    for (const auto &vertex : vertices) {
+        meshData.bounds.encapsulate(vertex.position);
+    }
+
+    return meshData;
+}
+
+void scratch::Model::addBoneWeights(const aiMesh *mesh, const std::unordered_map<std::string, int> &jointIndices,
+                                    scratch::MeshData &meshData) const {
+    const std::vector<Vertex> &vertices = meshData.vertices;
+    std::vector<SkinningVertex> &skinning = meshData.skinning;
+    skinning.resize(vertices.size());
+    std::vector<glm::vec4> weights(vertices.size(), glm::vec4(0.0f));
+    for (unsigned int i = 0; i < mesh->mNumBones; ++i) {
+        const aiBone *bone = mesh->mBones[i];
+        auto found = jointIndices.find(bone->mName.C_Str());
+        if (found == jointIndices.end()) {
+            continue;
+        }
+        for (unsigned int w = 0; w < bone->mNumWeights; ++w) {
+            const aiVertexWeight &vertexWeight = bone->mWeights[w];
+            glm::vec4 &vertexWeights = weights[vertexWeight.mVertexId];
+            // the lightest slot makes way, empty ones being the lightest of all
+            int slot = 0;
+            for (int k = 1; k < 4; ++k) {
+                if (vertexWeights[k] < vertexWeights[slot]) {
+                    slot = k;
+                }
+            }
+            if (vertexWeight.mWeight > vertexWeights[slot]) {
+                vertexWeights[slot] = vertexWeight.mWeight;
+                skinning[vertexWeight.mVertexId].boneIndices[slot] = static_cast<uint16_t>(found->second);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        SkinningVertex &vertex = skinning[i];
+        const glm::vec4 &vertexWeights = weights[i];
+        float total = vertexWeights.x + vertexWeights.y + vertexWeights.z + vertexWeights.w;
+        if (total <= 0.0f) {
+            // the root's palette matrix is identity in the bind pose, so unweighted vertices stay as modelled
+            vertex.boneIndices[0] = 0;
+            vertex.boneWeights[0] = 255;
+            continue;
+        }
+        // rounding to bytes can miss 255 by a little, the heaviest bone takes up the difference
+        int heaviest = 0;
+        int sum = 0;
+        for (int k = 0; k < 4; ++k) {
+            vertex.boneWeights[k] = static_cast<uint8_t>(std::lround(vertexWeights[k] / total * 255.0f));
+            sum += vertex.boneWeights[k];
+            if (vertexWeights[k] > vertexWeights[heaviest]) {
+                heaviest = k;
+            }
+        }
+        vertex.boneWeights[heaviest] = static_cast<uint8_t>(vertex.boneWeights[heaviest] + 255 - sum);
+    }
+
+    meshData.jointBounds.assign(_skeleton.getJointCount(), Bounds());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        for (int k = 0; k < 4; ++k) {
+            if (skinning[i].boneWeights[k] > 0) {
+                meshData.jointBounds[skinning[i].boneIndices[k]].encapsulate(vertices[i].position);
+            }
+        }
+    }
+}
+
+void scratch::Model::generateLods(scratch::MeshData &meshData) const {
+    std::vector<glm::vec3> positions;
+    positions.reserve(meshData.vertices.size());
+    for (const auto &vertex : meshData.vertices) {
+        positions.push_back(vertex.position);
     }
 
-    // return a mesh object created from the extracted mesh data
-    return Mesh(vertices, indices, _materials[mesh->mMaterialIndex], mesh->mMaterialIndex);
+    std::vector<unsigned int> previousLevel = meshData.indices;
+    while (meshData.lods.size() < _importSettings.lodLevels) {
+        size_t targetIndexCount = static_cast<size_t>(previousLevel.size() / 3 * _importSettings.lodReduction) * 3;
+        float error = 0.0f;
+        std::vector<unsigned int> level = scratch::MeshSimplifier::simplify(positions, previousLevel,
+                                                                           targetIndexCount,
+                                                                           _importSettings.lodMaxError, &error);
+        // stop once the error limit or locked seams keep the simplifier from making real progress
+        if (level.empty() || level.size() > previousLevel.size() * 9 / 10) {
+            break;
+        }
+        scratch::MeshOptimizer::optimizeVertexCache(level, positions.size());
+        meshData.lods.push_back({meshData.indices.size(), level.size(), error});
+        meshData.indices.insert(meshData.indices.end(), level.begin(), level.end());
+        previousLevel = std::move(level);
+    }
 }
 
 const std::string &scratch::Model::getModelPath() const {
     return _modelPath;
 }
 
+const scratch::ModelImportSettings &scratch::Model::getImportSettings() const {
+    return _importSettings;
+}
+
 void scratch::Model::serialize(rapidjson::PrettyWriter<rapidjson::StringBuffer> &writer) {
     writer.StartObject();
 
@@ -149,6 +388,19 @@ void scratch::Model::serialize(rapidjson::PrettyWriter<rapidjson::StringBuffer>
     writer.String("modelPath");
     writer.String(_modelPath.c_str(), static_cast<rapidjson::SizeType>(_modelPath.length()));
 
+    writer.String("retentionPolicy");
+    std::string retentionPolicy = RETENTION_POLICY_TO_STRING.find(_importSettings.retentionPolicy)->second;
+    writer.String(retentionPolicy.c_str(), static_cast<rapidjson::SizeType>(retentionPolicy.length()));
+
+    writer.String("generateLods");
+    writer.Bool(_importSettings.generateLods);
+    writer.String("lodLevels");
+    writer.Uint(_importSettings.lodLevels);
+    writer.String("lodReduction");
+    writer.Double(_importSettings.lodReduction);
+    writer.String("lodMaxError");
+    writer.Double(_importSettings.lodMaxError);
+
     writer.String("materialIds");
     writer.StartArray();
     for (auto material : _materials) {
@@ -162,6 +414,29 @@ void scratch::Model::serialize(rapidjson::PrettyWriter<rapidjson::StringBuffer>
 void scratch::Model::deserialize(const rapidjson::Value &object) {
     _id = object["id"].GetUint();
     _modelPath = object["modelPath"].GetString();
+    // scenes saved before import settings existed fall back to the defaults
+    if (object.HasMember("retentionPolicy") && object["retentionPolicy"].IsString()) {
+        auto policy = STRING_TO_RETENTION_POLICY.find(object["retentionPolicy"].GetString());
+        if (policy != STRING_TO_RETENTION_POLICY.end()) {
+            _importSettings.retentionPolicy = policy->second;
+        } else {
+            std::cout << "WARNING::MODEL::" << _modelPath << " has unknown retention policy "
+                      << object["retentionPolicy"].GetString() << ", using the default" << std::endl;
+        }
+    }
+    // each lod setting is optional on its own, a missing or mistyped one keeps its default
+    if (object.HasMember("generateLods") && object["generateLods"].IsBool()) {
+        _importSettings.generateLods = object["generateLods"].GetBool();
+    }
+    if (object.HasMember("lodLevels") && object["lodLevels"].IsUint()) {
+        _importSettings.lodLevels = object["lodLevels"].GetUint();
+    }
+    if (object.HasMember("lodReduction") && object["lodReduction"].IsNumber()) {
+        _importSettings.lodReduction = object["lodReduction"].GetFloat();
+    }
+    if (object.HasMember("lodMaxError") && object["lodMaxError"].IsNumber()) {
+        _importSettings.lodMaxError = object["lodMaxError"].GetFloat();
+    }
     this->loadModel(_modelPath);
 }
 
@@ -182,6 +457,14 @@ const std::vector<std::shared_ptr<scratch::Material>> &scratch::Model::getMateri
     return _materials;
 }
 
+const scratch::Skeleton &scratch::Model::getSkeleton() const {
+    return _skeleton;
+}
+
+const std::vector<scratch::AnimationClip> &scratch::Model::getAnimations() const {
+    return _animations;
+}
+
 void scratch::Model::swapMaterial(const unsigned int index, const std::shared_ptr<scratch::Material> newMaterial) {
     for (auto &mesh : _meshes) {
         if (mesh.getMaterialIndex() == index) {
@@ -191,10 +474,22 @@ void scratch::Model::swapMaterial(const unsigned int index, const std::shared_pt
     _materials[index] = newMaterial;
 }
 
-glm::vec3 convertVector3(aiVector3D aiVec3) {
+glm::vec3 convertVector3(const aiVector3D &aiVec3) {
     auto newVec3 = glm::vec3(0);
     newVec3.x = aiVec3.x;
     newVec3.y = aiVec3.y;
     newVec3.z = aiVec3.z;
     return newVec3;
-}
\ No newline at end of file
+}
+
+glm::quat convertQuaternion(const aiQuaternion &aiQuat) {
+    return glm::quat(aiQuat.w, aiQuat.x, aiQuat.y, aiQuat.z);
+}
+
+glm::mat4 convertMatrix(const aiMatrix4x4 &aiMat) {
+    // assimp's matrices are row major, glm's column major
+    return glm::mat4(aiMat.a1, aiMat.b1, aiMat.c1, aiMat.d1,
+                     aiMat.a2, aiMat.b2, aiMat.c2, aiMat.d2,
+                     aiMat.a3, aiMat.b3, aiMat.c3, aiMat.d3,
+                     aiMat.a4, aiMat.b4, aiMat.c4, aiMat.d4);
+}
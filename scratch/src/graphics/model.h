@@ -4,20 +4,25 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <unordered_map>
 #include <vector>
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include "animation/animation_clip.h"
+#include "animation/skeleton.h"
 #include "graphics/mesh.hpp"
 #include "graphics/material.hpp"
+#include "graphics/model_import_settings.h"
 #include <include/rapidjson/document.h>
 
 
 namespace scratch {
     class Model {
     public:
-        Model(unsigned int id, const std::string &path);
+        Model(unsigned int id, const std::string &path,
+              const ModelImportSettings &importSettings = ModelImportSettings());
 
         Model();
 
@@ -27,6 +32,8 @@ namespace scratch {
 
         const std::string &getModelPath() const;
 
+        const ModelImportSettings &getImportSettings() const;
+
         void serialize(rapidjson::PrettyWriter<rapidjson::StringBuffer> &writer);
 
         void deserialize(const rapidjson::Value &object);
@@ -37,6 +44,11 @@ namespace scratch {
 
         void swapMaterial(const unsigned int index, const std::shared_ptr<scratch::Material> newMaterial);
 
+        // Empty unless the file has bones or animations
+        const Skeleton &getSkeleton() const;
+
+        const std::vector<AnimationClip> &getAnimations() const;
+
     private:
         unsigned int _id;
 
@@ -45,15 +57,34 @@ namespace scratch {
         std::vector<std::shared_ptr<Material>> _materials;
         std::string _directory;
         std::string _modelPath;
+        ModelImportSettings _importSettings;
+        Skeleton _skeleton;
+        std::vector<AnimationClip> _animations;
 
         /*  Functions   */
         void loadModel(const std::string &path);
 
-        void processNode(aiNode *node, const aiScene *scene);
+        // Flattens the node hierarchy into the order its meshes are stored in _meshes
+        void collectMeshes(const aiNode *node, const aiScene *scene, std::vector<const aiMesh *> &meshes);
 
         std::shared_ptr<scratch::Material> scratch::Model::transformMaterial(aiMaterial *assimpMaterial);
 
-        Mesh processMesh(aiMesh *mesh, const aiScene *scene);
+        // Every node becomes a joint, parents first, so animated nodes no vertex is weighted to still move their
+        // children. Returns the joint of each node name.
+        std::unordered_map<std::string, int> loadSkeleton(const aiScene *scene, const std::vector<const aiMesh *> &meshes);
+
+        void addJoint(const aiNode *node, int parent, std::unordered_map<std::string, int> &jointIndices);
+
+        void loadAnimations(const aiScene *scene, const std::unordered_map<std::string, int> &jointIndices);
+
+        // CPU only conversion, safe to run on worker threads
+        MeshData processMesh(const aiMesh *mesh, const std::unordered_map<std::string, int> &jointIndices) const;
+
+        // Keeps the four heaviest bones of every vertex, renormalized
+        void addBoneWeights(const aiMesh *mesh, const std::unordered_map<std::string, int> &jointIndices,
+                            MeshData &meshData) const;
+
+        void generateLods(MeshData &meshData) const;
 
         void scratch::Model::attachMaterialTextures(const std::shared_ptr<scratch::Material> material,
                                                     const aiMaterial *assimpMaterial,
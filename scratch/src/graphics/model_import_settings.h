@@ -0,0 +1,36 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <map>
+#include <string>
+
+namespace scratch {
+    // What a mesh keeps in CPU memory once its vertex and index buffers have been uploaded
+    enum MeshRetentionPolicy {
+        DISCARD_CPU_DATA,
+        RETAIN_POSITIONS_AND_INDICES,
+        RETAIN_ALL
+    };
+    const std::map<MeshRetentionPolicy, std::string> RETENTION_POLICY_TO_STRING{
+            {DISCARD_CPU_DATA,             "DISCARD_CPU_DATA"},
+            {RETAIN_POSITIONS_AND_INDICES, "RETAIN_POSITIONS_AND_INDICES"},
+            {RETAIN_ALL,                   "RETAIN_ALL"}};
+    const std::map<std::string, MeshRetentionPolicy> STRING_TO_RETENTION_POLICY{
+            {"DISCARD_CPU_DATA",             DISCARD_CPU_DATA},
+            {"RETAIN_POSITIONS_AND_INDICES", RETAIN_POSITIONS_AND_INDICES},
+            {"RETAIN_ALL",                   RETAIN_ALL}};
+
+    struct ModelImportSettings {
+        MeshRetentionPolicy retentionPolicy = DISCARD_CPU_DATA;
+        // Build a chain of simplified index buffers for every mesh
+        bool generateLods = false;
+        // Maximum number of levels including the full resolution mesh
+        unsigned int lodLevels = 4;
+        // Fraction of the previous level's triangles each level aims for
+        float lodReduction = 0.5f;
+        // Largest surface deviation a level may introduce, relative to the mesh extent
+        float lodMaxError = 0.05f;
+    };
+}
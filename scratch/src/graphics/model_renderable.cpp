@@ -42,3 +42,10 @@ const std::vector<std::shared_ptr<scratch::Material>> &scratch::ModelRenderable:
     return _model->getMaterials();
 }
 
+const scratch::Skeleton &scratch::ModelRenderable::getSkeleton() const {
+    return _model->getSkeleton();
+}
+
+const std::vector<scratch::AnimationClip> &scratch::ModelRenderable::getAnimations() const {
+    return _model->getAnimations();
+}
@@ -22,6 +22,10 @@ namespace scratch {
 
         virtual const std::vector<std::shared_ptr<scratch::Material>> &getMaterials() const override;
 
+        const scratch::Skeleton &getSkeleton() const override;
+
+        const std::vector<scratch::AnimationClip> &getAnimations() const override;
+
 
         void serialize(rapidjson::PrettyWriter<rapidjson::StringBuffer> &writer) override;
 
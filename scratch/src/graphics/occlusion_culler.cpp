@@ -0,0 +1,298 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include "occlusion_culler.h"
+#include "frame_ring_buffer.h"
+
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <iostream>
+
+// ARB_indirect_parameters isn't in every generated loader
+#ifndef GL_PARAMETER_BUFFER_ARB
+#define GL_PARAMETER_BUFFER_ARB 0x80EE
+#endif
+
+namespace {
+    typedef void (GLAPIENTRY *MultiDrawElementsIndirectCountFunction)(GLenum mode, GLenum type, const void *indirect,
+                                                                      GLintptr drawCount, GLsizei maxDrawCount,
+                                                                      GLsizei stride);
+
+    MultiDrawElementsIndirectCountFunction multiDrawElementsIndirectCount = nullptr;
+
+    const GLuint CULL_GROUP_SIZE = 64;
+    const GLuint PYRAMID_GROUP_SIZE = 8;
+    // storage buffer bindings, after the LightClusters ones
+    const GLuint CULL_ITEM_BINDING = 5;
+    const GLuint INPUT_COMMAND_BINDING = 6;
+    const GLuint OUTPUT_COMMAND_BINDING = 7;
+    const GLuint BATCH_COUNT_BINDING = 8;
+}
+
+bool scratch::OcclusionCuller::isSupported() {
+    return GLAD_GL_VERSION_4_3;
+}
+
+void scratch::OcclusionCuller::initialize() {
+    if (!isSupported()) {
+        _enabled = false;
+        return;
+    }
+    // core in 4.6, the extension name otherwise
+    if (GLAD_GL_VERSION_4_6) {
+        multiDrawElementsIndirectCount = reinterpret_cast<MultiDrawElementsIndirectCountFunction>(
+                glfwGetProcAddress("glMultiDrawElementsIndirectCount"));
+    } else if (glfwExtensionSupported("GL_ARB_indirect_parameters")) {
+        multiDrawElementsIndirectCount = reinterpret_cast<MultiDrawElementsIndirectCountFunction>(
+                glfwGetProcAddress("glMultiDrawElementsIndirectCountARB"));
+    }
+    _compact = multiDrawElementsIndirectCount != nullptr;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &_storageAlignment);
+
+    _copyShader = std::make_unique<ComputeShader>("./assets/shaders/hiz-copy.comp");
+    _reduceShader = std::make_unique<ComputeShader>("./assets/shaders/hiz-reduce.comp");
+    _cullShader = std::make_unique<ComputeShader>("./assets/shaders/occlusion-cull.comp");
+    if (!_copyShader->isValid() || !_reduceShader->isValid() || !_cullShader->isValid()) {
+        std::cout << "Occlusion culling shaders failed to build, culling is disabled" << std::endl;
+        _enabled = false;
+    }
+}
+
+void scratch::OcclusionCuller::shutdown() {
+    _copyShader.reset();
+    _reduceShader.reset();
+    _cullShader.reset();
+    glDeleteTextures(1, &_depthTexture);
+    glDeleteTextures(1, &_pyramidTexture);
+    glDeleteFramebuffers(1, &_depthFramebuffer);
+    for (GLuint *buffer : {&_cullItemBuffer, &_inputCommandBuffer, &_outputCommandBuffer, &_batchCountBuffer}) {
+        glDeleteBuffers(1, buffer);
+        *buffer = 0;
+    }
+    _outputCommandCapacity = 0;
+    _batchCountCapacity = 0;
+    _depthTexture = 0;
+    _pyramidTexture = 0;
+    _depthFramebuffer = 0;
+    _capacityWidth = 0;
+    _capacityHeight = 0;
+    _pyramidWidth = 0;
+    _pyramidHeight = 0;
+    _hasPyramid = false;
+}
+
+void scratch::OcclusionCuller::setEnabled(bool enabled) {
+    _enabled = enabled && _cullShader && _cullShader->isValid();
+    // the pyramid stops being kept up to date while disabled
+    _hasPyramid = false;
+}
+
+bool scratch::OcclusionCuller::isEnabled() {
+    return _enabled;
+}
+
+bool scratch::OcclusionCuller::isReady() {
+    return _enabled && _hasPyramid;
+}
+
+void scratch::OcclusionCuller::cull(const std::vector<DrawElementsIndirectCommand> &commands,
+                                    const std::vector<Bounds> &bounds,
+                                    const std::vector<std::pair<size_t, size_t>> &batches) {
+    _batches = batches;
+    std::vector<CullItem> cullItems(commands.size());
+    for (size_t batch = 0; batch < batches.size(); ++batch) {
+        for (size_t command = batches[batch].first; command < batches[batch].first + batches[batch].second; ++command) {
+            CullItem &cullItem = cullItems[command];
+            cullItem.boundsMin = glm::vec4(bounds[command].getMin(), 1.0f);
+            cullItem.boundsMax = glm::vec4(bounds[command].getMax(), 1.0f);
+            cullItem.batch = static_cast<uint32_t>(batch);
+            cullItem.firstCommand = static_cast<uint32_t>(batches[batch].first);
+        }
+    }
+
+    // what the CPU writes goes through the ring like every other per frame stream, what the shader writes stays
+    // in buffers of its own that only need their counts cleared
+    bindFrameStorage(_cullItemBuffer, CULL_ITEM_BINDING, cullItems.data(), cullItems.size() * sizeof(CullItem));
+    bindFrameStorage(_inputCommandBuffer, INPUT_COMMAND_BINDING, commands.data(),
+                     commands.size() * sizeof(DrawElementsIndirectCommand));
+    reserveStorage(_outputCommandBuffer, _outputCommandCapacity, OUTPUT_COMMAND_BINDING,
+                   commands.size() * sizeof(DrawElementsIndirectCommand));
+    reserveStorage(_batchCountBuffer, _batchCountCapacity, BATCH_COUNT_BINDING, batches.size() * sizeof(uint32_t));
+    if (!batches.empty()) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, _batchCountBuffer);
+        glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 0,
+                             static_cast<GLsizeiptr>(batches.size() * sizeof(uint32_t)), GL_RED_INTEGER,
+                             GL_UNSIGNED_INT, nullptr);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    _cullShader->use();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _pyramidTexture);
+    // a sampler object left on the unit would override the texture's own state
+    glBindSampler(0, 0);
+    _cullShader->setInt("depthPyramid", 0);
+    _cullShader->setMat4("pyramidViewProjection", _pyramidViewProjection);
+    _cullShader->setVec2("pyramidSize", glm::vec2(_pyramidWidth, _pyramidHeight));
+    _cullShader->setInt("pyramidLevels", _pyramidLevels);
+    _cullShader->setBool("hasPyramid", _hasPyramid);
+    _cullShader->setBool("compact", _compact);
+    _cullShader->setUnsignedInt("itemCount", static_cast<unsigned int>(commands.size()));
+    glDispatchCompute(ComputeShader::groupsFor(static_cast<GLuint>(commands.size()), CULL_GROUP_SIZE), 1, 1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    // the draws read what the shader wrote as commands and parameters
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _outputCommandBuffer);
+    if (_compact) {
+        glBindBuffer(GL_PARAMETER_BUFFER_ARB, _batchCountBuffer);
+    }
+}
+
+void scratch::OcclusionCuller::drawBatch(size_t batch, GLenum indexType) {
+    const auto &[firstCommand, commandCount] = _batches[batch];
+    void *offset = (void *) (firstCommand * sizeof(DrawElementsIndirectCommand));
+    if (_compact) {
+        multiDrawElementsIndirectCount(GL_TRIANGLES, indexType, offset,
+                                       static_cast<GLintptr>(batch * sizeof(uint32_t)),
+                                       static_cast<GLsizei>(commandCount), 0);
+    } else {
+        glMultiDrawElementsIndirect(GL_TRIANGLES, indexType, offset, static_cast<GLsizei>(commandCount), 0);
+    }
+}
+
+void scratch::OcclusionCuller::buildPyramid(const glm::mat4 &viewProjection, int width, int height, int maxWidth,
+                                            int maxHeight) {
+    if (!_enabled || width <= 0 || height <= 0) {
+        return;
+    }
+    // only a window resize reallocates, render scale changes just cover less of the textures
+    maxWidth = std::max(maxWidth, width);
+    maxHeight = std::max(maxHeight, height);
+    if (maxWidth != _capacityWidth || maxHeight != _capacityHeight) {
+        createPyramid(maxWidth, maxHeight);
+    }
+    int levels = getLevelCount(width, height);
+
+    // depth attachments can't be read by shaders, blit to a texture that can
+    GLint sourceFramebuffer = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &sourceFramebuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(sourceFramebuffer));
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _depthFramebuffer);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(sourceFramebuffer));
+
+    _copyShader->use();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _depthTexture);
+    glBindSampler(0, 0);
+    _copyShader->setInt("depthTexture", 0);
+    _copyShader->setIVec2("size", glm::ivec2(width, height));
+    glBindImageTexture(1, _pyramidTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    glDispatchCompute(ComputeShader::groupsFor(width, PYRAMID_GROUP_SIZE),
+                      ComputeShader::groupsFor(height, PYRAMID_GROUP_SIZE), 1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    _reduceShader->use();
+    for (int level = 1; level < levels; ++level) {
+        glm::ivec2 sourceSize(std::max(width >> (level - 1), 1), std::max(height >> (level - 1), 1));
+        glm::ivec2 destinationSize(std::max(width >> level, 1), std::max(height >> level, 1));
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        glBindImageTexture(0, _pyramidTexture, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+        glBindImageTexture(1, _pyramidTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        _reduceShader->setIVec2("sourceSize", sourceSize);
+        _reduceShader->setIVec2("destinationSize", destinationSize);
+        glDispatchCompute(ComputeShader::groupsFor(destinationSize.x, PYRAMID_GROUP_SIZE),
+                          ComputeShader::groupsFor(destinationSize.y, PYRAMID_GROUP_SIZE), 1);
+    }
+    // next frame samples the pyramid as a texture
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    _pyramidWidth = width;
+    _pyramidHeight = height;
+    _pyramidLevels = levels;
+    _pyramidViewProjection = viewProjection;
+    _hasPyramid = true;
+}
+
+void scratch::OcclusionCuller::createPyramid(int width, int height) {
+    glDeleteTextures(1, &_depthTexture);
+    glDeleteTextures(1, &_pyramidTexture);
+
+    // has to match the default framebuffer's format for the blit
+    glGenTextures(1, &_depthTexture);
+    glBindTexture(GL_TEXTURE_2D, _depthTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH24_STENCIL8, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glGenTextures(1, &_pyramidTexture);
+    glBindTexture(GL_TEXTURE_2D, _pyramidTexture);
+    glTexStorage2D(GL_TEXTURE_2D, getLevelCount(width, height), GL_R32F, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (_depthFramebuffer == 0) {
+        glGenFramebuffers(1, &_depthFramebuffer);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, _depthFramebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, _depthTexture, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    _capacityWidth = width;
+    _capacityHeight = height;
+    _hasPyramid = false;
+}
+
+int scratch::OcclusionCuller::getLevelCount(int width, int height) {
+    int levels = 1;
+    for (int size = std::max(width, height); size > 1; size /= 2) {
+        levels++;
+    }
+    return levels;
+}
+
+void scratch::OcclusionCuller::bindFrameStorage(GLuint &fallbackBuffer, GLuint binding, const void *data,
+                                                size_t byteSize) {
+    GLintptr offset = byteSize > 0 ? FrameRingBuffer::write(data, byteSize, static_cast<size_t>(_storageAlignment))
+                                   : -1;
+    if (offset >= 0) {
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, FrameRingBuffer::getBuffer(), offset,
+                          static_cast<GLsizeiptr>(byteSize));
+        return;
+    }
+    uploadStorage(fallbackBuffer, binding, data, byteSize);
+}
+
+void scratch::OcclusionCuller::reserveStorage(GLuint &buffer, size_t &capacity, GLuint binding, size_t byteSize) {
+    // never empty so the binding stays valid
+    byteSize = std::max<size_t>(byteSize, sizeof(uint32_t));
+    if (buffer == 0) {
+        glGenBuffers(1, &buffer);
+    }
+    if (byteSize > capacity) {
+        // room to grow into, so a few more draws next frame don't reallocate again
+        capacity = std::max(byteSize, capacity * 2);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(capacity), nullptr, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer);
+}
+
+void scratch::OcclusionCuller::uploadStorage(GLuint &buffer, GLuint binding, const void *data, size_t byteSize) {
+    if (buffer == 0) {
+        glGenBuffers(1, &buffer);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    // without the ring, orphans last frame's contents, never empty so the binding stays valid
+    glBufferData(GL_SHADER_STORAGE_BUFFER, std::max<size_t>(byteSize, sizeof(uint32_t)), data, GL_STREAM_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer);
+}
@@ -0,0 +1,111 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+#include "bounds.h"
+#include "compute_shader.h"
+#include "geometry_pool.h"
+
+namespace scratch {
+    // GPU occlusion culling for the multi-draw path. After each frame the depth buffer is reduced into a
+    // hierarchical depth pyramid holding the farthest depth per texel. The next frame a compute shader projects
+    // every draw's bounds with last frame's camera and drops it when the pyramid shows something nearer
+    // covering all of it. Survivors are packed to the front of their batch's command range and the counts fed to
+    // glMultiDrawElementsIndirectCount, without the extension culled commands just get no instances. Nothing is
+    // read back to the CPU. Since the pyramid is a frame old, something revealed this frame can be missing for
+    // a frame.
+    class OcclusionCuller {
+    public:
+        // Compute shaders and image load/store, 4.3
+        static bool isSupported();
+
+        static void initialize();
+
+        static void shutdown();
+
+        static void setEnabled(bool enabled);
+
+        static bool isEnabled();
+
+        // Whether a pyramid from a previous frame is there to test against
+        static bool isReady();
+
+        // Culls commands, one per bounds, grouped into batches given as command ranges. Leaves the culled
+        // commands bound as the draw indirect buffer, see drawBatch.
+        static void cull(const std::vector<DrawElementsIndirectCommand> &commands,
+                         const std::vector<Bounds> &bounds, const std::vector<std::pair<size_t, size_t>> &batches);
+
+        // Draws the commands of batch that survived cull
+        static void drawBatch(size_t batch, GLenum indexType);
+
+        // Reduces the bound framebuffer's depth into the pyramid, call once the frame's depth is complete.
+        // width and height are the rendered part of the framebuffer, maxWidth and maxHeight the most it can
+        // be. The pyramid is allocated at the most and built in its corner so a changing render scale doesn't
+        // reallocate it, see DynamicResolution.
+        static void buildPyramid(const glm::mat4 &viewProjection, int width, int height, int maxWidth,
+                                 int maxHeight);
+
+    private:
+        // std430 mirror of CullItem in occlusion-cull.comp
+        struct CullItem {
+            glm::vec4 boundsMin;
+            glm::vec4 boundsMax;
+            uint32_t batch;
+            uint32_t firstCommand;
+            uint32_t padding[2];
+        };
+
+        inline static bool _enabled = true;
+        inline static bool _compact = false;
+
+        inline static std::unique_ptr<ComputeShader> _copyShader;
+        inline static std::unique_ptr<ComputeShader> _reduceShader;
+        inline static std::unique_ptr<ComputeShader> _cullShader;
+
+        // depth copied out of the framebuffer, which can't be sampled directly
+        inline static GLuint _depthTexture = 0;
+        inline static GLuint _depthFramebuffer = 0;
+        inline static GLuint _pyramidTexture = 0;
+        // size the textures were allocated at
+        inline static int _capacityWidth = 0;
+        inline static int _capacityHeight = 0;
+        // the part of them the last pyramid covers, and how many of its levels that fills
+        inline static int _pyramidWidth = 0;
+        inline static int _pyramidHeight = 0;
+        inline static int _pyramidLevels = 0;
+        inline static bool _hasPyramid = false;
+        inline static glm::mat4 _pyramidViewProjection = glm::mat4(1.0f);
+
+        // only used when the FrameRingBuffer is unavailable or full
+        inline static GLuint _cullItemBuffer = 0;
+        inline static GLuint _inputCommandBuffer = 0;
+        // written by the cull shader, kept on the GPU and only reallocated when outgrown
+        inline static GLuint _outputCommandBuffer = 0;
+        inline static size_t _outputCommandCapacity = 0;
+        inline static GLuint _batchCountBuffer = 0;
+        inline static size_t _batchCountCapacity = 0;
+        inline static GLint _storageAlignment = 256;
+        inline static std::vector<std::pair<size_t, size_t>> _batches;
+
+        static void createPyramid(int width, int height);
+
+        // Levels down to one texel for a first level of width by height
+        static int getLevelCount(int width, int height);
+
+        // Writes the frame's input through the FrameRingBuffer, or streams fallbackBuffer when the ring can't
+        // take it
+        static void bindFrameStorage(GLuint &fallbackBuffer, GLuint binding, const void *data, size_t byteSize);
+
+        static void uploadStorage(GLuint &buffer, GLuint binding, const void *data, size_t byteSize);
+
+        // Grows buffer to hold at least byteSize, keeping it otherwise, and binds it
+        static void reserveStorage(GLuint &buffer, size_t &capacity, GLuint binding, size_t byteSize);
+    };
+}
@@ -0,0 +1,72 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include "post_process_chain.h"
+
+#include <algorithm>
+
+void scratch::PostProcessChain::initialize() {
+    _shader = std::make_shared<Shader>(0, "./assets/shaders/post-process.vert", "./assets/shaders/post-process.frag");
+    _shader->waitUntilReady();
+    glGenVertexArrays(1, &_vertexArray);
+}
+
+void scratch::PostProcessChain::setExposure(float exposure) {
+    _exposure = std::max(exposure, 0.0f);
+}
+
+float scratch::PostProcessChain::getExposure() {
+    return _exposure;
+}
+
+void scratch::PostProcessChain::setToneMapper(ToneMapper toneMapper) {
+    _toneMapper = toneMapper;
+}
+
+scratch::ToneMapper scratch::PostProcessChain::getToneMapper() {
+    return _toneMapper;
+}
+
+void scratch::PostProcessChain::setFxaaEnabled(bool enabled) {
+    _fxaaEnabled = enabled;
+}
+
+bool scratch::PostProcessChain::isFxaaEnabled() {
+    return _fxaaEnabled;
+}
+
+void scratch::PostProcessChain::apply(const RenderTarget &sceneTarget, int sceneWidth, int sceneHeight,
+                                      int outputWidth, int outputHeight) {
+    // the variant compiles on first use, until then the chain runs without FXAA
+    Shader *shader = _fxaaEnabled ? _shader->getVariant(FXAA_FEATURE) : _shader.get();
+    if (!shader->isReady()) {
+        shader = _shader.get();
+    }
+    shader->use();
+    glActiveTexture(GL_TEXTURE0);
+    // a sampler object left on the unit would override the target's own single level, linear filtering
+    glBindSampler(0, 0);
+    glBindTexture(GL_TEXTURE_2D, sceneTarget.getColorTexture());
+    shader->setInt("sceneColor", 0);
+    glm::vec2 texelSize = glm::vec2(1.0f / static_cast<float>(sceneTarget.getWidth()),
+                                    1.0f / static_cast<float>(sceneTarget.getHeight()));
+    shader->setVec2("sceneTexelSize", texelSize);
+    shader->setVec2("sceneScale", glm::vec2(sceneWidth, sceneHeight) * texelSize);
+    // last texel centre inside the scene, so filtering never reaches the unused part of the target
+    shader->setVec2("sceneMax", (glm::vec2(sceneWidth, sceneHeight) - 0.5f) * texelSize);
+    shader->setBool("upscale", sceneWidth != outputWidth || sceneHeight != outputHeight);
+    shader->setFloat("exposure", _exposure);
+    shader->setInt("toneMapper", static_cast<int>(_toneMapper));
+
+    glBindVertexArray(_vertexArray);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void scratch::PostProcessChain::shutdown() {
+    _shader.reset();
+    glDeleteVertexArrays(1, &_vertexArray);
+    _vertexArray = 0;
+}
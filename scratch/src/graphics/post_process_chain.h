@@ -0,0 +1,57 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <glad/glad.h>
+
+#include <memory>
+
+#include "render_target.h"
+#include "shader.h"
+
+namespace scratch {
+    // Curves taking scene radiance to the displayable range, values match toneMapper in post-process.frag
+    enum ToneMapper {
+        REINHARD_TONE_MAPPER = 0,
+        ACES_TONE_MAPPER = 1
+    };
+
+    // Takes the HDR scene to the window. Exposure, tone mapping, sRGB encoding and, when enabled, FXAA all run
+    // in a single fullscreen pass, each stage a function in post-process.frag rather than a target of its own,
+    // so the scene is read once and nothing in between is written out. Optional stages are shader variants.
+    // The scene can cover less than the whole target, the pass upscales it to the window with a Catmull-Rom
+    // filter, sharper than bilinear for the same handful of fetches.
+    class PostProcessChain {
+    public:
+        static void initialize();
+
+        static void setExposure(float exposure);
+
+        static float getExposure();
+
+        static void setToneMapper(ToneMapper toneMapper);
+
+        static ToneMapper getToneMapper();
+
+        static void setFxaaEnabled(bool enabled);
+
+        static bool isFxaaEnabled();
+
+        // Draws the bottom left sceneWidth x sceneHeight of sceneTarget's color over the bound framebuffer, which
+        // is outputWidth x outputHeight. Depth testing should be off.
+        static void apply(const RenderTarget &sceneTarget, int sceneWidth, int sceneHeight, int outputWidth,
+                          int outputHeight);
+
+        static void shutdown();
+
+    private:
+        inline static float _exposure = 1.0f;
+        inline static ToneMapper _toneMapper = ACES_TONE_MAPPER;
+        inline static bool _fxaaEnabled = true;
+
+        inline static std::shared_ptr<Shader> _shader;
+        // core profile draws need one bound, the fullscreen triangle comes from gl_VertexID
+        inline static GLuint _vertexArray = 0;
+    };
+}
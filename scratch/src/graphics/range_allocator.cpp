@@ -0,0 +1,74 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include <iterator>
+
+#include "range_allocator.h"
+
+scratch::RangeAllocator::RangeAllocator(size_t capacity) : _capacity(0), _used(0) {
+    grow(capacity);
+}
+
+size_t scratch::RangeAllocator::allocate(size_t size) {
+    if (size == 0) {
+        return INVALID_OFFSET;
+    }
+    for (auto range = _freeRanges.begin(); range != _freeRanges.end(); ++range) {
+        if (range->second < size) {
+            continue;
+        }
+        size_t offset = range->first;
+        size_t remaining = range->second - size;
+        _freeRanges.erase(range);
+        if (remaining > 0) {
+            _freeRanges[offset + size] = remaining;
+        }
+        _used += size;
+        return offset;
+    }
+    return INVALID_OFFSET;
+}
+
+void scratch::RangeAllocator::free(size_t offset, size_t size) {
+    if (size == 0) {
+        return;
+    }
+    _used -= size;
+    auto inserted = _freeRanges.emplace(offset, size).first;
+
+    // merge with the following range
+    auto next = std::next(inserted);
+    if (next != _freeRanges.end() && inserted->first + inserted->second == next->first) {
+        inserted->second += next->second;
+        _freeRanges.erase(next);
+    }
+    // and with the preceding one
+    if (inserted != _freeRanges.begin()) {
+        auto previous = std::prev(inserted);
+        if (previous->first + previous->second == inserted->first) {
+            previous->second += inserted->second;
+            _freeRanges.erase(inserted);
+        }
+    }
+}
+
+void scratch::RangeAllocator::grow(size_t newCapacity) {
+    if (newCapacity <= _capacity) {
+        return;
+    }
+    size_t oldCapacity = _capacity;
+    size_t added = newCapacity - oldCapacity;
+    _capacity = newCapacity;
+    // hand the new space out through free so it merges with a free tail
+    _used += added;
+    free(oldCapacity, added);
+}
+
+size_t scratch::RangeAllocator::getCapacity() const {
+    return _capacity;
+}
+
+size_t scratch::RangeAllocator::getUsed() const {
+    return _used;
+}
@@ -0,0 +1,36 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <cstddef>
+#include <map>
+
+namespace scratch {
+    // First fit allocator over [0, capacity), used to sub-allocate large GPU buffers.
+    // Only does the bookkeeping, the owner creates and resizes the actual storage.
+    class RangeAllocator {
+    public:
+        static const size_t INVALID_OFFSET = static_cast<size_t>(-1);
+
+        explicit RangeAllocator(size_t capacity = 0);
+
+        // Returns INVALID_OFFSET when no free range is large enough
+        size_t allocate(size_t size);
+
+        void free(size_t offset, size_t size);
+
+        // Adds free space at the end, capacity can only grow
+        void grow(size_t newCapacity);
+
+        size_t getCapacity() const;
+
+        size_t getUsed() const;
+
+    private:
+        // offset -> size of each free range, neighbouring ranges are always merged
+        std::map<size_t, size_t> _freeRanges;
+        size_t _capacity;
+        size_t _used;
+    };
+}
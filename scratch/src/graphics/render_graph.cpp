@@ -0,0 +1,245 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include "render_graph.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "render_target_pool.h"
+
+scratch::RenderGraph::PassBuilder::PassBuilder(RenderGraph &graph, size_t pass) : _graph(graph), _pass(pass) {
+}
+
+void scratch::RenderGraph::PassBuilder::read(RenderGraphResource resource) {
+    _graph._passes[_pass].reads.push_back(resource);
+}
+
+void scratch::RenderGraph::PassBuilder::write(RenderGraphResource resource) {
+    _graph._passes[_pass].writes.push_back(resource);
+}
+
+void scratch::RenderGraph::PassBuilder::setRenderTarget(RenderGraphResource resource, const RenderPassState &state) {
+    Pass &pass = _graph._passes[_pass];
+    pass.hasRenderTarget = true;
+    pass.renderTarget = resource;
+    pass.state = state;
+    pass.writes.push_back(resource);
+}
+
+void scratch::RenderGraph::PassBuilder::setSideEffect() {
+    _graph._passes[_pass].sideEffect = true;
+}
+
+scratch::RenderGraph::PassResources::PassResources(const RenderGraph &graph) : _graph(graph) {
+}
+
+const scratch::RenderTarget &scratch::RenderGraph::PassResources::getTarget(RenderGraphResource resource) const {
+    return *_graph._resources[resource].target;
+}
+
+scratch::RenderGraphResource scratch::RenderGraph::importBackbuffer(int width, int height) {
+    _resources.push_back({"Backbuffer", BACKBUFFER_RESOURCE, {width, height, GL_RGBA8, true}, nullptr});
+    return static_cast<RenderGraphResource>(_resources.size() - 1);
+}
+
+scratch::RenderGraphResource scratch::RenderGraph::importExternal(const std::string &name) {
+    _resources.push_back({name, EXTERNAL_RESOURCE, {0, 0, GL_NONE, false}, nullptr});
+    return static_cast<RenderGraphResource>(_resources.size() - 1);
+}
+
+scratch::RenderGraphResource scratch::RenderGraph::createTarget(const std::string &name,
+                                                                const RenderGraphTargetDesc &desc) {
+    _resources.push_back({name, TRANSIENT_RESOURCE, desc, nullptr});
+    return static_cast<RenderGraphResource>(_resources.size() - 1);
+}
+
+void scratch::RenderGraph::addPass(const std::string &name, const SetupFunction &setup,
+                                   const ExecuteFunction &execute) {
+    Pass pass;
+    pass.name = name;
+    pass.execute = execute;
+    _passes.push_back(pass);
+    PassBuilder builder(*this, _passes.size() - 1);
+    setup(builder);
+}
+
+void scratch::RenderGraph::execute() {
+    _executedPasses.clear();
+    std::vector<size_t> order = compile();
+
+    // the last pass touching each transient, which hands it back to the pool
+    std::vector<size_t> lastUse(_resources.size(), 0);
+    for (size_t position = 0; position < order.size(); ++position) {
+        const Pass &pass = _passes[order[position]];
+        for (const auto *uses : {&pass.reads, &pass.writes}) {
+            for (RenderGraphResource resource : *uses) {
+                lastUse[resource] = position;
+            }
+        }
+    }
+
+    for (size_t position = 0; position < order.size(); ++position) {
+        const Pass &pass = _passes[order[position]];
+        for (const auto *uses : {&pass.reads, &pass.writes}) {
+            for (RenderGraphResource resource : *uses) {
+                Resource &used = _resources[resource];
+                if (used.type == TRANSIENT_RESOURCE && used.target == nullptr) {
+                    used.target = RenderTargetPool::acquire(used.desc.width, used.desc.height,
+                                                            used.desc.colorFormat, used.desc.hasDepth);
+                }
+            }
+        }
+
+        beginPass(pass);
+        pass.execute(PassResources(*this));
+        _executedPasses.push_back(pass.name);
+
+        for (const auto *uses : {&pass.reads, &pass.writes}) {
+            for (RenderGraphResource resource : *uses) {
+                // back in the pool, a later transient of the same size and format can reuse it this frame
+                if (lastUse[resource] == position) {
+                    _resources[resource].target.reset();
+                }
+            }
+        }
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_TRUE);
+    glDepthFunc(GL_LESS);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
+const std::vector<std::string> &scratch::RenderGraph::getExecutedPasses() const {
+    return _executedPasses;
+}
+
+std::vector<size_t> scratch::RenderGraph::compile() const {
+    auto writes = [this](size_t pass, RenderGraphResource resource) {
+        const std::vector<RenderGraphResource> &passWrites = _passes[pass].writes;
+        return std::find(passWrites.begin(), passWrites.end(), resource) != passWrites.end();
+    };
+
+    // walk back from what leaves the graph to everything it depends on
+    std::vector<bool> needed(_passes.size(), false);
+    std::vector<size_t> stack;
+    for (size_t pass = 0; pass < _passes.size(); ++pass) {
+        bool writesBackbuffer = std::any_of(_passes[pass].writes.begin(), _passes[pass].writes.end(),
+                                            [this](RenderGraphResource resource) {
+                                                return _resources[resource].type == BACKBUFFER_RESOURCE;
+                                            });
+        if (_passes[pass].sideEffect || writesBackbuffer) {
+            needed[pass] = true;
+            stack.push_back(pass);
+        }
+    }
+    while (!stack.empty()) {
+        size_t pass = stack.back();
+        stack.pop_back();
+        // readers need every writer, writers need the ones before them since they draw on top
+        for (size_t other = 0; other < _passes.size(); ++other) {
+            if (needed[other] || other == pass) {
+                continue;
+            }
+            bool dependency = false;
+            for (RenderGraphResource resource : _passes[pass].reads) {
+                dependency = dependency || writes(other, resource);
+            }
+            for (RenderGraphResource resource : _passes[pass].writes) {
+                dependency = dependency || (other < pass && writes(other, resource));
+            }
+            if (dependency) {
+                needed[other] = true;
+                stack.push_back(other);
+            }
+        }
+    }
+
+    // edges between the survivors, then a topological sort preferring the order passes were added in
+    std::vector<std::vector<size_t>> dependents(_passes.size());
+    std::vector<size_t> dependencyCount(_passes.size(), 0);
+    for (size_t pass = 0; pass < _passes.size(); ++pass) {
+        for (size_t other = 0; other < _passes.size(); ++other) {
+            if (!needed[pass] || !needed[other] || other == pass) {
+                continue;
+            }
+            bool before = false;
+            for (RenderGraphResource resource : _passes[other].reads) {
+                before = before || (writes(pass, resource) && !writes(other, resource));
+            }
+            for (RenderGraphResource resource : _passes[other].writes) {
+                before = before || (pass < other && writes(pass, resource));
+            }
+            if (before) {
+                dependents[pass].push_back(other);
+                dependencyCount[other]++;
+            }
+        }
+    }
+
+    std::vector<size_t> order;
+    std::vector<bool> scheduled(_passes.size(), false);
+    size_t neededCount = static_cast<size_t>(std::count(needed.begin(), needed.end(), true));
+    while (order.size() < neededCount) {
+        size_t next = _passes.size();
+        for (size_t pass = 0; pass < _passes.size(); ++pass) {
+            if (needed[pass] && !scheduled[pass] && dependencyCount[pass] == 0) {
+                next = pass;
+                break;
+            }
+        }
+        if (next == _passes.size()) {
+            std::cout << "Render graph has a cycle, running the remaining passes in the order they were added"
+                      << std::endl;
+            for (size_t pass = 0; pass < _passes.size(); ++pass) {
+                if (needed[pass] && !scheduled[pass]) {
+                    order.push_back(pass);
+                }
+            }
+            break;
+        }
+        scheduled[next] = true;
+        order.push_back(next);
+        for (size_t dependent : dependents[next]) {
+            dependencyCount[dependent]--;
+        }
+    }
+    return order;
+}
+
+void scratch::RenderGraph::beginPass(const Pass &pass) {
+    if (pass.hasRenderTarget) {
+        const Resource &target = _resources[pass.renderTarget];
+        if (target.type == TRANSIENT_RESOURCE) {
+            target.target->bind();
+        } else {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(0, 0, target.desc.width, target.desc.height);
+        }
+    }
+    const RenderPassState &state = pass.state;
+    if (state.viewportWidth > 0 && state.viewportHeight > 0) {
+        glViewport(0, 0, state.viewportWidth, state.viewportHeight);
+    }
+
+    // masks apply to clears too, so clear before setting them
+    if (state.clearColor || state.clearDepth) {
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDepthMask(GL_TRUE);
+        glClearColor(state.clearColorValue.x, state.clearColorValue.y, state.clearColorValue.z,
+                     state.clearColorValue.w);
+        glClear((state.clearColor ? GL_COLOR_BUFFER_BIT : 0) | (state.clearDepth ? GL_DEPTH_BUFFER_BIT : 0));
+    }
+    if (state.depthTest) {
+        glEnable(GL_DEPTH_TEST);
+    } else {
+        glDisable(GL_DEPTH_TEST);
+    }
+    glDepthMask(state.depthWrite ? GL_TRUE : GL_FALSE);
+    glDepthFunc(state.depthFunc);
+    GLboolean colorWrite = state.colorWrite ? GL_TRUE : GL_FALSE;
+    glColorMask(colorWrite, colorWrite, colorWrite, colorWrite);
+}
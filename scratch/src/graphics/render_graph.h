@@ -0,0 +1,140 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "render_target.h"
+
+namespace scratch {
+    // Handle to a target or other resource a graph's passes read and write
+    typedef unsigned int RenderGraphResource;
+
+    // Size and format of a transient target, see RenderTargetPool
+    struct RenderGraphTargetDesc {
+        int width;
+        int height;
+        GLenum colorFormat;
+        bool hasDepth;
+    };
+
+    // Fixed function state a pass runs with, the graph sets it up before the pass executes
+    struct RenderPassState {
+        bool depthTest = true;
+        bool depthWrite = true;
+        GLenum depthFunc = GL_LESS;
+        bool colorWrite = true;
+        bool clearColor = false;
+        bool clearDepth = false;
+        glm::vec4 clearColorValue = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        // 0 covers the whole target
+        int viewportWidth = 0;
+        int viewportHeight = 0;
+    };
+
+    // One frame's passes, built fresh each time. Passes declare what they read and write and the graph works out
+    // the rest on execute:
+    // - passes whose results never reach the backbuffer or a pass marked as having side effects are culled
+    // - the rest run writers before readers, several writers of one resource in the order they were added
+    // - transient targets are taken from RenderTargetPool right before their first use and handed back right
+    //   after their last, so targets of the same size and format whose lifetimes don't overlap share memory
+    // - each pass's render target is bound and its RenderPassState applied, then reset to the defaults at the end
+    class RenderGraph {
+    public:
+        class PassBuilder {
+        public:
+            void read(RenderGraphResource resource);
+
+            // For resources the pass updates without drawing into them, e.g. external ones
+            void write(RenderGraphResource resource);
+
+            // The framebuffer the pass draws into, bound with state before it executes
+            void setRenderTarget(RenderGraphResource resource, const RenderPassState &state = RenderPassState());
+
+            // Keeps the pass even though nothing in the graph reads what it writes, e.g. readbacks
+            void setSideEffect();
+
+        private:
+            friend class RenderGraph;
+
+            RenderGraph &_graph;
+            size_t _pass;
+
+            PassBuilder(RenderGraph &graph, size_t pass);
+        };
+
+        // What a pass can reach while executing
+        class PassResources {
+        public:
+            // The pooled target behind a transient resource, only valid during passes that use it
+            const RenderTarget &getTarget(RenderGraphResource resource) const;
+
+        private:
+            friend class RenderGraph;
+
+            const RenderGraph &_graph;
+
+            explicit PassResources(const RenderGraph &graph);
+        };
+
+        typedef std::function<void(PassBuilder &)> SetupFunction;
+        typedef std::function<void(const PassResources &)> ExecuteFunction;
+
+        // The default framebuffer, writing it counts as a side effect
+        RenderGraphResource importBackbuffer(int width, int height);
+
+        // Something the graph doesn't own, only tracked for ordering, e.g. the shadow map array
+        RenderGraphResource importExternal(const std::string &name);
+
+        RenderGraphResource createTarget(const std::string &name, const RenderGraphTargetDesc &desc);
+
+        // Setup runs straight away to declare the pass's resources, execute runs later if the pass survives
+        void addPass(const std::string &name, const SetupFunction &setup, const ExecuteFunction &execute);
+
+        void execute();
+
+        // Passes run by the last execute, in order
+        const std::vector<std::string> &getExecutedPasses() const;
+
+    private:
+        enum ResourceType {
+            TRANSIENT_RESOURCE,
+            BACKBUFFER_RESOURCE,
+            EXTERNAL_RESOURCE
+        };
+
+        struct Resource {
+            std::string name;
+            ResourceType type;
+            RenderGraphTargetDesc desc;
+            std::shared_ptr<RenderTarget> target;
+        };
+
+        struct Pass {
+            std::string name;
+            ExecuteFunction execute;
+            std::vector<RenderGraphResource> reads;
+            std::vector<RenderGraphResource> writes;
+            bool hasRenderTarget = false;
+            RenderGraphResource renderTarget = 0;
+            RenderPassState state;
+            bool sideEffect = false;
+        };
+
+        std::vector<Resource> _resources;
+        std::vector<Pass> _passes;
+        std::vector<std::string> _executedPasses;
+
+        // Surviving passes in execution order
+        std::vector<size_t> compile() const;
+
+        void beginPass(const Pass &pass);
+    };
+}
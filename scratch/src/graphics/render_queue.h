@@ -0,0 +1,18 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <vector>
+
+#include "draw_item.h"
+
+namespace scratch {
+    // Everything to draw in a frame, see SceneManager::buildRenderQueue
+    struct RenderQueue {
+        // every mesh instance, shadow cascades cull these themselves
+        std::vector<DrawItem> items;
+        // the items inside the camera frustum by sortKey, so nearest first
+        std::vector<const DrawItem *> visibleItems;
+    };
+}
@@ -5,6 +5,8 @@
 #include "render_system.h"
 
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
 #include <optional>
 #include <imgui.h>
@@ -13,6 +15,16 @@
 #include <ImGuizmo.h>
 #include <utilities/assert.h>
 #include "main.h"
+#include "geometry_pool.h"
+#include "dynamic_resolution.h"
+#include "frame_ring_buffer.h"
+#include "light_clusters.h"
+#include "occlusion_culler.h"
+#include "post_process_chain.h"
+#include "render_graph.h"
+#include "render_target_pool.h"
+#include "shadow_maps.h"
+#include "texture_manager.h"
 
 
 void GLAPIENTRY messageCallback(GLenum source,
@@ -92,12 +104,49 @@ void RenderSystem::setup() {
     glViewport(0, 0, width, height);
     glEnable(GL_DEPTH_TEST);
 
-    // Enable Gamma correction (physically correct colors)
-    glEnable(GL_FRAMEBUFFER_SRGB);
-
     glEnable(GL_DEBUG_OUTPUT);
     glDebugMessageCallback(messageCallback, nullptr);
 
+    scratch::GeometryPool::initialize();
+    scratch::FrameRingBuffer::initialize();
+    scratch::TextureManager::initialize();
+    // batched shaders need to know how textures reach them before anything compiles
+    std::vector<std::string> globalDefines;
+    switch (scratch::TextureManager::getBindingMode()) {
+        case scratch::BINDLESS_TEXTURES:
+            globalDefines.emplace_back("SCRATCH_BINDLESS_TEXTURES");
+            break;
+        case scratch::TEXTURE_ARRAYS:
+            globalDefines.emplace_back("SCRATCH_TEXTURE_ARRAYS");
+            break;
+        default:
+            break;
+    }
+    // point and spot lights need the cluster storage buffers, older contexts only get the directional light
+    if (scratch::LightClusters::isSupported()) {
+        globalDefines.emplace_back("SCRATCH_CLUSTERED_LIGHTING");
+    } else {
+        std::cout << "Storage buffers unavailable, point and spot lights are disabled" << std::endl;
+    }
+    // skinning reads the bone palette from a storage buffer too, without one rigged models keep their bind pose
+    if (GLAD_GL_VERSION_4_3) {
+        globalDefines.emplace_back("SCRATCH_SKINNING");
+    }
+    scratch::Shader::setGlobalDefines(globalDefines);
+    _fallbackShader = std::make_shared<scratch::Shader>(0, "./assets/shaders/fallback.vert",
+                                                        "./assets/shaders/fallback.frag");
+    _fallbackShader->waitUntilReady();
+    _depthShader = std::make_shared<scratch::Shader>(0, "./assets/shaders/depth.vert", "./assets/shaders/depth.frag");
+    _depthShader->waitUntilReady();
+    if (GLAD_GL_VERSION_4_3) {
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &_storageAlignment);
+        _depthBatchedShader = std::make_shared<scratch::Shader>(0, "./assets/shaders/depth-batched.vert",
+                                                                "./assets/shaders/depth.frag");
+    }
+    scratch::OcclusionCuller::initialize();
+    // the scene is lit in linear HDR, this pass is what encodes sRGB now
+    scratch::PostProcessChain::initialize();
+
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
@@ -113,40 +162,543 @@ void RenderSystem::setup() {
     ImGui_ImplOpenGL3_Init(glslVersion);
 }
 
-void RenderSystem::render(const std::vector<scratch::Mesh> &renderQueue, scratch::DirectionalLight &directionalLight) {
-    // Background Fill Color
-    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+void RenderSystem::render(const scratch::FramePacket &framePacket) {
+    const scratch::RenderQueue &renderQueue = framePacket.renderQueue;
+    const scratch::DirectionalLight &directionalLight = framePacket.directionalLight;
+    const glm::mat4 &view = framePacket.view;
+    const glm::mat4 &projection = framePacket.projection;
+    glm::vec3 viewPosition = framePacket.camera.getPosition();
+
+    int width, height;
+    glfwGetWindowSize(scratch::MainWindow, &width, &height);
+    // everything up to post-processing runs at the render resolution
+    float renderScale = scratch::DynamicResolution::isEnabled() ? scratch::DynamicResolution::getRenderScale()
+                                                                : _renderScale;
+    int renderWidth = std::max(static_cast<int>(std::lround(width * renderScale)), 1);
+    int renderHeight = std::max(static_cast<int>(std::lround(height * renderScale)), 1);
+    scratch::DynamicResolution::beginFrame();
+
+    // culled and sorted front to back while the queue was built
+    const std::vector<const scratch::DrawItem *> &visibleItems = renderQueue.visibleItems;
+
+    unsigned int querySlot = _sampleQueryFrame % 2;
+    if (_sampleQueries[0][0] == 0) {
+        glGenQueries(4, &_sampleQueries[0][0]);
+    }
+    readSampleQueries(querySlot);
+
+    // bound for the whole frame, every pass skins with the same matrices
+    if (!framePacket.bonePalette.empty() && GLAD_GL_VERSION_4_3) {
+        bindFrameStorage(BONE_PALETTE_BINDING, _paletteBuffer, framePacket.bonePalette.data(),
+                         framePacket.bonePalette.size() * sizeof(glm::mat4));
+        scratch::GeometryPool::bindSkinning();
+    }
+
+    scratch::RenderGraph graph;
+    scratch::RenderGraphResource backbuffer = graph.importBackbuffer(width, height);
+    scratch::RenderGraphResource lightClusters = graph.importExternal("Light Clusters");
+    scratch::RenderGraphResource shadowMap = graph.importExternal("Shadow Map");
+    // window sized so the scale can change every frame without reallocating, the scene only fills a corner
+    scratch::RenderGraphResource scene = graph.createTarget("Scene", {width, height, GL_RGBA16F, true});
+
+    if (scratch::LightClusters::isSupported()) {
+        graph.addPass("Light Clusters", [&](scratch::RenderGraph::PassBuilder &builder) {
+            builder.write(lightClusters);
+        }, [&](const scratch::RenderGraph::PassResources &) {
+            scratch::LightClusters::build(framePacket.pointLights, framePacket.spotLights, view, projection,
+                                          renderWidth, renderHeight, *scratch::ScratchManagers->jobSystem);
+        });
+    }
+
+    if (scratch::ShadowMaps::getCascadeCount() > 0) {
+        graph.addPass("Shadows", [&](scratch::RenderGraph::PassBuilder &builder) {
+            builder.write(shadowMap);
+        }, [&](const scratch::RenderGraph::PassResources &) {
+            scratch::ShadowMaps::update(view, projection, directionalLight.getDirection());
+            renderShadows(renderQueue.items, renderWidth, renderHeight);
+        });
+    }
+
+    scratch::RenderPassState sceneState;
+    sceneState.clearColor = true;
+    sceneState.clearColorValue = glm::vec4(0.1f, 0.1f, 0.1f, 1.0f);
+    sceneState.clearDepth = true;
+    sceneState.viewportWidth = renderWidth;
+    sceneState.viewportHeight = renderHeight;
+    if (_depthPrepassEnabled) {
+        graph.addPass("Depth Pre-pass", [&](scratch::RenderGraph::PassBuilder &builder) {
+            scratch::RenderPassState prepassState = sceneState;
+            prepassState.colorWrite = false;
+            builder.setRenderTarget(scene, prepassState);
+        }, [&](const scratch::RenderGraph::PassResources &) {
+            glBeginQuery(GL_SAMPLES_PASSED, _sampleQueries[querySlot][0]);
+            renderDepthPrepass(visibleItems, view, projection);
+            glEndQuery(GL_SAMPLES_PASSED);
+        });
+        // depth is final, shading only has to match it
+        sceneState.clearDepth = false;
+        sceneState.clearColor = false;
+        sceneState.depthFunc = GL_EQUAL;
+        sceneState.depthWrite = false;
+    }
+
+    graph.addPass("Opaque", [&](scratch::RenderGraph::PassBuilder &builder) {
+        builder.read(lightClusters);
+        builder.read(shadowMap);
+        builder.setRenderTarget(scene, sceneState);
+    }, [&](const scratch::RenderGraph::PassResources &) {
+        glBeginQuery(GL_SAMPLES_PASSED, _sampleQueries[querySlot][1]);
+        renderOpaque(visibleItems, view, projection, viewPosition, directionalLight);
+        glEndQuery(GL_SAMPLES_PASSED);
+    });
+
+    if (scratch::OcclusionCuller::isEnabled()) {
+        // this frame's depth is what next frame's batches are tested against
+        graph.addPass("Hi-Z", [&](scratch::RenderGraph::PassBuilder &builder) {
+            builder.read(scene);
+            builder.setSideEffect();
+        }, [&](const scratch::RenderGraph::PassResources &resources) {
+            glBindFramebuffer(GL_FRAMEBUFFER, resources.getTarget(scene).getFramebuffer());
+            scratch::OcclusionCuller::buildPyramid(projection * view, renderWidth, renderHeight, width, height);
+        });
+    }
+
+    scratch::RenderPassState overlayState;
+    overlayState.depthTest = false;
+    overlayState.depthWrite = false;
+    graph.addPass("Post Process", [&](scratch::RenderGraph::PassBuilder &builder) {
+        builder.read(scene);
+        builder.setRenderTarget(backbuffer, overlayState);
+    }, [&](const scratch::RenderGraph::PassResources &resources) {
+        scratch::PostProcessChain::apply(resources.getTarget(scene), renderWidth, renderHeight, width, height);
+        // ImGui isn't timed, it always draws at the window's resolution whatever the scale
+        scratch::DynamicResolution::endFrame();
+    });
+
+    graph.addPass("ImGui", [&](scratch::RenderGraph::PassBuilder &builder) {
+        builder.setRenderTarget(backbuffer, overlayState);
+    }, [&](const scratch::RenderGraph::PassResources &) {
+        ImGui::Render();
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    });
+
+    graph.execute();
 
-    glm::mat4 view = scratch::MainCamera->getViewMatrix();
-    glm::mat4 projection = scratch::MainCamera->getProjectionMatrix();
-    glm::vec3 viewPosition = scratch::MainCamera->getPosition();
+    _sampleQueriesPending[querySlot] = true;
+    _prepassQueried[querySlot] = _depthPrepassEnabled;
+    ++_sampleQueryFrame;
+}
+
+void RenderSystem::renderOpaque(const std::vector<const scratch::DrawItem *> &visibleItems, const glm::mat4 &view,
+                                const glm::mat4 &projection, const glm::vec3 &viewPosition,
+                                const scratch::DirectionalLight &directionalLight) {
+    // Shaders reading the DrawBuffer take material data from storage buffers, so many materials share one draw
+    bool canBatch = scratch::TextureManager::getBindingMode() != scratch::BIND_PER_MATERIAL;
+    std::vector<const scratch::DrawItem *> batchedItems;
+    std::vector<const scratch::DrawItem *> materialItems;
+    std::vector<const scratch::DrawItem *> compilingItems;
+    for (const auto *drawItem : visibleItems) {
+        scratch::Shader *shader = drawItem->mesh->getMaterial()->getActiveShader();
+        if (!shader->isReady()) {
+            compilingItems.push_back(drawItem);
+        } else if (canBatch && drawItem->mesh->isUploaded() && shader->isBatchable() &&
+                   drawItem->mesh->getMaterial()->hasBatchableTextures()) {
+            batchedItems.push_back(drawItem);
+        } else {
+            materialItems.push_back(drawItem);
+        }
+    }
+    if (_depthPrepassEnabled) {
+        // with depth already laid down order no longer saves shading, so group by material instead
+        std::stable_sort(materialItems.begin(), materialItems.end(),
+                         [](const scratch::DrawItem *a, const scratch::DrawItem *b) {
+                             return a->mesh->getMaterial()->getId() < b->mesh->getMaterial()->getId();
+                         });
+    }
+    if (!batchedItems.empty()) {
+        renderBatches(batchedItems, view, projection, viewPosition, directionalLight);
+    }
+    if (!compilingItems.empty()) {
+        renderWithFallback(compilingItems, view, projection);
+    }
 
     std::optional<scratch::Material> currentMaterial = {};
-    for (auto mesh : renderQueue) {
+    scratch::Shader *currentShader = nullptr;
+    for (const auto *item : materialItems) {
+        const scratch::DrawItem &drawItem = *item;
+        const scratch::Mesh &mesh = *drawItem.mesh;
         if (!currentMaterial.has_value() || mesh.getMaterial()->getId() != currentMaterial.value().getId()) {
             if(currentMaterial.has_value()){
-                currentMaterial.value().clearParameters();
+                currentMaterial.value().deactivate();
             }
             currentMaterial = *mesh.getMaterial();
             currentMaterial.value().activate();
-            currentMaterial.value().getShader()->setMat4("view", view);
-            currentMaterial.value().getShader()->setMat4("projection", projection);
-            currentMaterial.value().getShader()->setVec3("viewPos", viewPosition);
-            directionalLight.applyToShader(*currentMaterial.value().getShader());
+            currentShader = currentMaterial.value().getActiveShader();
+            currentShader->setMat4("view", view);
+            currentShader->setMat4("projection", projection);
+            currentShader->setVec3("viewPos", viewPosition);
+            applyLighting(*currentShader, directionalLight);
+        }
+        currentShader->setMat4("model", drawItem.modelMatrix);
+        currentShader->setUnsignedInt("paletteOffset", drawItem.paletteOffset);
+        currentShader->setInt("skinningOffset", mesh.getSkinningOffset());
+        mesh.draw(drawItem.lod);
+    }
+    if (currentMaterial.has_value()) {
+        currentMaterial.value().deactivate();
+    }
+}
+
+void RenderSystem::renderBatches(const std::vector<const scratch::DrawItem *> &drawItems, const glm::mat4 &view,
+                                 const glm::mat4 &projection, const glm::vec3 &viewPosition,
+                                 const scratch::DirectionalLight &directionalLight) {
+    struct Batch {
+        scratch::Shader *shader;
+        GLenum indexType;
+        size_t firstCommand;
+        size_t commandCount;
+    };
+
+    std::map<std::pair<scratch::Shader *, GLenum>, std::vector<const scratch::DrawItem *>> itemsByBatch;
+    for (const auto *drawItem : drawItems) {
+        scratch::Shader *shader = drawItem->mesh->getMaterial()->getActiveShader();
+        itemsByBatch[{shader, drawItem->mesh->getIndexType()}].push_back(drawItem);
+    }
+
+    std::map<unsigned int, uint32_t> materialIndices;
+    std::vector<GpuMaterial> materials;
+    std::vector<DrawData> draws;
+    std::vector<scratch::DrawElementsIndirectCommand> commands;
+    std::vector<scratch::Bounds> commandBounds;
+    std::vector<std::pair<size_t, size_t>> commandRanges;
+    std::vector<Batch> batches;
+    draws.reserve(drawItems.size());
+    commands.reserve(drawItems.size());
+    commandBounds.reserve(drawItems.size());
+    for (const auto &[key, items] : itemsByBatch) {
+        batches.push_back({key.first, key.second, commands.size(), items.size()});
+        commandRanges.emplace_back(commands.size(), items.size());
+        for (const auto *drawItem : items) {
+            const std::shared_ptr<scratch::Material> material = drawItem->mesh->getMaterial();
+            auto found = materialIndices.find(material->getId());
+            if (found == materialIndices.end()) {
+                found = materialIndices.emplace(material->getId(), static_cast<uint32_t>(materials.size())).first;
+                materials.push_back(packMaterial(*material));
+            }
+            DrawData draw = {};
+            draw.model = drawItem->modelMatrix;
+            draw.materialIndex = found->second;
+            draw.paletteOffset = drawItem->paletteOffset;
+            draw.skinningOffset = drawItem->mesh->getSkinningOffset();
+            // the draw's base instance is its index into the draw buffer
+            commands.push_back(drawItem->mesh->getDrawCommand(drawItem->lod, static_cast<GLuint>(draws.size())));
+            commandBounds.push_back(drawItem->bounds);
+            draws.push_back(draw);
         }
-        mesh.draw();
     }
 
-    ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    scratch::GeometryPool::reserveDrawIndices(draws.size());
+    bindFrameStorage(0, _drawBuffer, draws.data(), draws.size() * sizeof(DrawData));
+    bindFrameStorage(1, _materialBuffer, materials.data(), materials.size() * sizeof(GpuMaterial));
+    // the culler writes its own command buffer and leaves it bound
+    bool occlusionCulled = scratch::OcclusionCuller::isEnabled();
+    GLintptr commandOffset = 0;
+    if (occlusionCulled) {
+        scratch::OcclusionCuller::cull(commands, commandBounds, commandRanges);
+    } else {
+        commandOffset = bindFrameCommands(commands);
+    }
+
+    bool textureArrays = scratch::TextureManager::getBindingMode() == scratch::TEXTURE_ARRAYS;
+    GLint arrayUnits[scratch::TextureManager::MAX_ARRAY_PAGES];
+    unsigned int arrayPageCount = 0;
+    if (textureArrays) {
+        arrayPageCount = scratch::TextureManager::bindArrayPages(0);
+        for (unsigned int i = 0; i < scratch::TextureManager::MAX_ARRAY_PAGES; ++i) {
+            arrayUnits[i] = static_cast<GLint>(i);
+        }
+    }
+
+    for (size_t batchIndex = 0; batchIndex < batches.size(); ++batchIndex) {
+        const Batch &batch = batches[batchIndex];
+        batch.shader->use();
+        batch.shader->setMat4("view", view);
+        batch.shader->setMat4("projection", projection);
+        batch.shader->setVec3("viewPos", viewPosition);
+        applyLighting(*batch.shader, directionalLight);
+        if (textureArrays) {
+            glUniform1iv(glGetUniformLocation(batch.shader->getShaderId(), "textureArrays"),
+                         scratch::TextureManager::MAX_ARRAY_PAGES, arrayUnits);
+            batch.shader->setInt("textureArrayCount", static_cast<int>(arrayPageCount));
+        }
+        scratch::GeometryPool::bind(batch.indexType);
+        if (occlusionCulled) {
+            scratch::OcclusionCuller::drawBatch(batchIndex, batch.indexType);
+        } else {
+            glMultiDrawElementsIndirect(GL_TRIANGLES, batch.indexType,
+                                        (void *) (commandOffset +
+                                                  batch.firstCommand * sizeof(scratch::DrawElementsIndirectCommand)),
+                                        static_cast<GLsizei>(batch.commandCount), 0);
+        }
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    scratch::TextureManager::unbindSamplers(0, arrayPageCount);
+}
+
+void RenderSystem::renderShadows(const std::vector<scratch::DrawItem> &renderQueue, int viewportWidth,
+                                 int viewportHeight) {
+    bool batched = canBatchDepth() && !renderQueue.empty();
+    if (batched) {
+        // every cascade picks its casters out of the same draw data, indexed like the queue
+        std::vector<DrawData> draws(renderQueue.size());
+        for (size_t i = 0; i < renderQueue.size(); ++i) {
+            draws[i].model = renderQueue[i].modelMatrix;
+            draws[i].paletteOffset = renderQueue[i].paletteOffset;
+            draws[i].skinningOffset = renderQueue[i].mesh->getSkinningOffset();
+        }
+        scratch::GeometryPool::reserveDrawIndices(draws.size());
+        bindFrameStorage(0, _drawBuffer, draws.data(), draws.size() * sizeof(DrawData));
+    } else {
+        _depthShader->use();
+    }
+    for (unsigned int cascade = 0; cascade < scratch::ShadowMaps::getCascadeCount(); ++cascade) {
+        const scratch::ShadowCascade &shadowCascade = scratch::ShadowMaps::getCascade(cascade);
+        scratch::ShadowMaps::beginCascade(cascade);
+        std::vector<const scratch::DrawItem *> casters = cullDrawItems(renderQueue, shadowCascade.frustum);
+        if (batched) {
+            renderDepthBatched(casters, renderQueue.data(), shadowCascade.view, shadowCascade.projection);
+            continue;
+        }
+        _depthShader->setMat4("view", shadowCascade.view);
+        _depthShader->setMat4("projection", shadowCascade.projection);
+        for (const auto *drawItem : casters) {
+            _depthShader->setMat4("model", drawItem->modelMatrix);
+            _depthShader->setUnsignedInt("paletteOffset", drawItem->paletteOffset);
+            _depthShader->setInt("skinningOffset", drawItem->mesh->getSkinningOffset());
+            drawItem->mesh->draw(drawItem->lod, scratch::POSITION_STREAM);
+        }
+    }
+    scratch::ShadowMaps::end(viewportWidth, viewportHeight);
+}
+
+void RenderSystem::renderDepthPrepass(const std::vector<const scratch::DrawItem *> &drawItems,
+                                      const glm::mat4 &view, const glm::mat4 &projection) {
+    if (canBatchDepth() && !drawItems.empty()) {
+        std::vector<DrawData> draws(drawItems.size());
+        for (size_t i = 0; i < drawItems.size(); ++i) {
+            draws[i].model = drawItems[i]->modelMatrix;
+            draws[i].paletteOffset = drawItems[i]->paletteOffset;
+            draws[i].skinningOffset = drawItems[i]->mesh->getSkinningOffset();
+        }
+        scratch::GeometryPool::reserveDrawIndices(draws.size());
+        bindFrameStorage(0, _drawBuffer, draws.data(), draws.size() * sizeof(DrawData));
+        renderDepthBatched(drawItems, nullptr, view, projection);
+        return;
+    }
+    _depthShader->use();
+    _depthShader->setMat4("view", view);
+    _depthShader->setMat4("projection", projection);
+    for (const auto *drawItem : drawItems) {
+        _depthShader->setMat4("model", drawItem->modelMatrix);
+        _depthShader->setUnsignedInt("paletteOffset", drawItem->paletteOffset);
+        _depthShader->setInt("skinningOffset", drawItem->mesh->getSkinningOffset());
+        drawItem->mesh->draw(drawItem->lod, scratch::POSITION_STREAM);
+    }
+}
+
+void RenderSystem::renderDepthBatched(const std::vector<const scratch::DrawItem *> &drawItems,
+                                      const scratch::DrawItem *drawDataBase, const glm::mat4 &view,
+                                      const glm::mat4 &projection) {
+    // short indexed commands first, then 32 bit ones, one multi-draw each
+    std::vector<scratch::DrawElementsIndirectCommand> commands;
+    commands.reserve(drawItems.size());
+    size_t shortCommandCount = 0;
+    for (GLenum indexType : {GL_UNSIGNED_SHORT, GL_UNSIGNED_INT}) {
+        for (size_t i = 0; i < drawItems.size(); ++i) {
+            const scratch::DrawItem &drawItem = *drawItems[i];
+            // meshes missing from the pool wouldn't draw through the uniform path either
+            if (drawItem.mesh->getIndexType() != indexType || !drawItem.mesh->isUploaded()) {
+                continue;
+            }
+            auto drawIndex = static_cast<GLuint>(drawDataBase != nullptr ? &drawItem - drawDataBase : i);
+            commands.push_back(drawItem.mesh->getDrawCommand(drawItem.lod, drawIndex));
+        }
+        if (indexType == GL_UNSIGNED_SHORT) {
+            shortCommandCount = commands.size();
+        }
+    }
+    if (commands.empty()) {
+        return;
+    }
+
+    _depthBatchedShader->use();
+    _depthBatchedShader->setMat4("view", view);
+    _depthBatchedShader->setMat4("projection", projection);
+    GLintptr commandOffset = bindFrameCommands(commands);
+    if (shortCommandCount > 0) {
+        scratch::GeometryPool::bind(GL_UNSIGNED_SHORT, scratch::POSITION_STREAM);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, (void *) commandOffset,
+                                    static_cast<GLsizei>(shortCommandCount), 0);
+    }
+    if (commands.size() > shortCommandCount) {
+        scratch::GeometryPool::bind(GL_UNSIGNED_INT, scratch::POSITION_STREAM);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                    (void *) (commandOffset +
+                                              shortCommandCount * sizeof(scratch::DrawElementsIndirectCommand)),
+                                    static_cast<GLsizei>(commands.size() - shortCommandCount), 0);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+bool RenderSystem::canBatchDepth() {
+    return _depthBatchedShader != nullptr && _depthBatchedShader->isReady() && _depthBatchedShader->isBatchable();
+}
+
+void RenderSystem::readSampleQueries(unsigned int slot) {
+    if (!_sampleQueriesPending[slot]) {
+        return;
+    }
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(_sampleQueries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == GL_FALSE) {
+        // the queries get reissued this frame, skipping one sample is better than waiting on the GPU
+        return;
+    }
+    GLuint64 shadedSamples = 0;
+    glGetQueryObjectui64v(_sampleQueries[slot][1], GL_QUERY_RESULT, &shadedSamples);
+    _depthPrepassStats.shadedSamples = shadedSamples;
+    _depthPrepassStats.prepassSamples = 0;
+    if (_prepassQueried[slot]) {
+        GLuint64 prepassSamples = 0;
+        glGetQueryObjectui64v(_sampleQueries[slot][0], GL_QUERY_RESULT, &prepassSamples);
+        _depthPrepassStats.prepassSamples = prepassSamples;
+    }
+    _sampleQueriesPending[slot] = false;
+}
+
+void RenderSystem::setDepthPrepassEnabled(bool enabled) {
+    _depthPrepassEnabled = enabled;
+}
+
+bool RenderSystem::isDepthPrepassEnabled() {
+    return _depthPrepassEnabled;
+}
+
+void RenderSystem::setRenderScale(float renderScale) {
+    _renderScale = std::clamp(renderScale, MIN_RENDER_SCALE, 1.0f);
+}
+
+float RenderSystem::getRenderScale() {
+    return _renderScale;
+}
+
+const RenderSystem::DepthPrepassStats &RenderSystem::getDepthPrepassStats() {
+    return _depthPrepassStats;
+}
+
+std::vector<const scratch::DrawItem *> RenderSystem::cullDrawItems(const std::vector<scratch::DrawItem> &renderQueue,
+                                                                   const scratch::Frustum &frustum) {
+    std::vector<const scratch::DrawItem *> visibleItems;
+    visibleItems.reserve(renderQueue.size());
+    for (const auto &drawItem : renderQueue) {
+        if (frustum.intersects(drawItem.bounds)) {
+            visibleItems.push_back(&drawItem);
+        }
+    }
+    return visibleItems;
+}
+
+void RenderSystem::renderWithFallback(const std::vector<const scratch::DrawItem *> &drawItems, const glm::mat4 &view,
+                                      const glm::mat4 &projection) {
+    _fallbackShader->use();
+    _fallbackShader->setMat4("view", view);
+    _fallbackShader->setMat4("projection", projection);
+    for (const auto *drawItem : drawItems) {
+        _fallbackShader->setMat4("model", drawItem->modelMatrix);
+        _fallbackShader->setUnsignedInt("paletteOffset", drawItem->paletteOffset);
+        _fallbackShader->setInt("skinningOffset", drawItem->mesh->getSkinningOffset());
+        drawItem->mesh->draw(drawItem->lod);
+    }
+}
+
+void RenderSystem::applyLighting(scratch::Shader &shader, const scratch::DirectionalLight &directionalLight) {
+    directionalLight.applyToShader(shader);
+    if (scratch::LightClusters::isSupported()) {
+        scratch::LightClusters::applyToShader(shader);
+    }
+    scratch::ShadowMaps::applyToShader(shader);
+}
+
+RenderSystem::GpuMaterial RenderSystem::packMaterial(const scratch::Material &material) {
+    // first texture of each role wins, like texture_*1 in the per material shaders
+    std::map<scratch::TextureRole, unsigned int> handles;
+    for (const auto &texture : material.getTextures()) {
+        handles.emplace(scratch::TextureManager::roleFromTypeName(texture.type), texture.id);
+    }
+    auto reference = [&handles](scratch::TextureRole role) {
+        auto found = handles.find(role);
+        unsigned int handle = found != handles.end() ? found->second : scratch::TextureManager::getPlaceholder(role);
+        return scratch::TextureManager::getShaderReference(handle);
+    };
+
+    GpuMaterial gpuMaterial = {};
+    gpuMaterial.diffuse = reference(scratch::DIFFUSE_TEXTURE);
+    gpuMaterial.specular = reference(scratch::SPECULAR_TEXTURE);
+    gpuMaterial.normal = reference(scratch::NORMAL_TEXTURE);
+
+    const auto &parameters = material.getParameters();
+    auto shininess = parameters.find("material.shininess");
+    if (shininess != parameters.end()) {
+        gpuMaterial.shininess = scratch::StringConverter::parsefloat(shininess->second.value);
+    }
+    return gpuMaterial;
+}
+
+void RenderSystem::streamBuffer(GLenum target, GLuint &buffer, const void *data, size_t byteSize) {
+    if (buffer == 0) {
+        glGenBuffers(1, &buffer);
+    }
+    glBindBuffer(target, buffer);
+    glBufferData(target, byteSize, data, GL_STREAM_DRAW);
+    glBindBuffer(target, 0);
+}
+
+void RenderSystem::bindFrameStorage(GLuint binding, GLuint &fallbackBuffer, const void *data, size_t byteSize) {
+    GLintptr offset = scratch::FrameRingBuffer::write(data, byteSize, static_cast<size_t>(_storageAlignment));
+    if (offset >= 0) {
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, scratch::FrameRingBuffer::getBuffer(), offset,
+                          static_cast<GLsizeiptr>(byteSize));
+        return;
+    }
+    streamBuffer(GL_SHADER_STORAGE_BUFFER, fallbackBuffer, data, byteSize);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, fallbackBuffer);
+}
+
+GLintptr RenderSystem::bindFrameCommands(const std::vector<scratch::DrawElementsIndirectCommand> &commands) {
+    size_t byteSize = commands.size() * sizeof(scratch::DrawElementsIndirectCommand);
+    // commands only have to be 4 byte aligned
+    GLintptr offset = scratch::FrameRingBuffer::write(commands.data(), byteSize, sizeof(GLuint));
+    if (offset >= 0) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, scratch::FrameRingBuffer::getBuffer());
+        return offset;
+    }
+    streamBuffer(GL_DRAW_INDIRECT_BUFFER, _indirectBuffer, commands.data(), byteSize);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _indirectBuffer);
+    return 0;
 }
 
 void RenderSystem::startFrame() {
+    scratch::FrameRingBuffer::beginFrame();
     int width, height;
     glfwGetWindowSize(scratch::MainWindow, &width, &height);
     glViewport(0, 0, width, height);
 
+    // Stream in whatever textures finished decoding, within this frame's upload budget
+    scratch::TextureManager::setViewportHeight(height);
+    scratch::TextureManager::update();
+
     // Start the Dear ImGui frame
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
@@ -155,6 +707,38 @@ void RenderSystem::startFrame() {
 }
 
 void RenderSystem::endFrame() {
+    // everything reading this frame's ring slot has been submitted
+    scratch::FrameRingBuffer::endFrame();
     // Flip Buffers and Draw
     glfwSwapBuffers(scratch::MainWindow);
+    scratch::RenderTargetPool::endFrame();
+}
+
+void RenderSystem::shutdown() {
+    glDeleteBuffers(1, &_drawBuffer);
+    glDeleteBuffers(1, &_materialBuffer);
+    glDeleteBuffers(1, &_indirectBuffer);
+    glDeleteBuffers(1, &_paletteBuffer);
+    _drawBuffer = 0;
+    _materialBuffer = 0;
+    _paletteBuffer = 0;
+    if (_sampleQueries[0][0] != 0) {
+        glDeleteQueries(4, &_sampleQueries[0][0]);
+        std::fill(&_sampleQueries[0][0], &_sampleQueries[0][0] + 4, 0);
+        _sampleQueriesPending[0] = false;
+        _sampleQueriesPending[1] = false;
+    }
+    _indirectBuffer = 0;
+    _fallbackShader.reset();
+    _depthShader.reset();
+    _depthBatchedShader.reset();
+    scratch::OcclusionCuller::shutdown();
+    scratch::PostProcessChain::shutdown();
+    scratch::DynamicResolution::shutdown();
+    scratch::RenderTargetPool::shutdown();
+    scratch::ShadowMaps::shutdown();
+    scratch::LightClusters::shutdown();
+    scratch::TextureManager::shutdown();
+    scratch::FrameRingBuffer::shutdown();
+    scratch::GeometryPool::shutdown();
 }
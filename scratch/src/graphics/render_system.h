@@ -2,7 +2,14 @@
 
 
 #include <lights/directional_light.h>
+#include <lights/point_light.h>
+#include <lights/spot_light.h>
 #include "mesh.hpp"
+#include "draw_item.h"
+#include "frame_packet.h"
+#include "render_queue.h"
+#include "frustum.h"
+#include "shader.h"
 
 class RenderSystem {
 public:
@@ -10,7 +17,128 @@ public:
 
     static void startFrame();
 
-    static void render(const std::vector<scratch::Mesh> &renderQueue, scratch::DirectionalLight &directionalLight);
+    // Draws a snapshot of the scene, reading nothing but the packet so the scene can change meanwhile
+    static void render(const scratch::FramePacket &framePacket);
 
     static void endFrame();
+
+    static void shutdown();
+
+    // Fragments passing the depth test in each pass, read back a couple of frames late to avoid stalling.
+    // The pre-pass passes about what shading would without it, so the difference is the saving.
+    struct DepthPrepassStats {
+        uint64_t prepassSamples;
+        uint64_t shadedSamples;
+    };
+
+    // Lays down depth for every visible opaque first so the shading pass only runs for the nearest fragment
+    static void setDepthPrepassEnabled(bool enabled);
+
+    static bool isDepthPrepassEnabled();
+
+    static const DepthPrepassStats &getDepthPrepassStats();
+
+    static constexpr float MIN_RENDER_SCALE = 0.25f;
+
+    // Fraction of the window size the scene is rendered at before post-processing scales it up, lower to
+    // trade sharpness for frame time. DynamicResolution picks the scale instead while it's enabled.
+    static void setRenderScale(float renderScale);
+
+    static float getRenderScale();
+
+private:
+    // std430 mirror of GpuMaterial in lit-batched.frag, textures as TextureManager shader references
+    struct GpuMaterial {
+        glm::uvec2 diffuse;
+        glm::uvec2 specular;
+        glm::uvec2 normal;
+        float shininess;
+        uint32_t padding;
+    };
+
+    // std430 mirror of DrawData in lit-batched.vert
+    struct DrawData {
+        glm::mat4 model;
+        uint32_t materialIndex;
+        uint32_t paletteOffset = scratch::DrawItem::NO_PALETTE;
+        // see Mesh::getSkinningOffset
+        int32_t skinningOffset = 0;
+        uint32_t padding;
+    };
+
+    // storage binding the vertex shaders read the frame's skinning matrices from
+    static const GLuint BONE_PALETTE_BINDING = 9;
+
+    // stands in for materials whose shader is still compiling
+    inline static std::shared_ptr<scratch::Shader> _fallbackShader;
+    // positions only, for shadow casters and the depth pre-pass
+    inline static std::shared_ptr<scratch::Shader> _depthShader;
+    // the same reading model matrices from the DrawBuffer, 4.3+ only
+    inline static std::shared_ptr<scratch::Shader> _depthBatchedShader;
+    inline static GLint _storageAlignment = 256;
+
+    inline static float _renderScale = 1.0f;
+
+    inline static bool _depthPrepassEnabled = true;
+    // GL_SAMPLES_PASSED queries for the pre-pass and the shading pass, double buffered across frames
+    inline static GLuint _sampleQueries[2][2] = {};
+    inline static bool _sampleQueriesPending[2] = {};
+    inline static bool _prepassQueried[2] = {};
+    inline static unsigned int _sampleQueryFrame = 0;
+    inline static DepthPrepassStats _depthPrepassStats = {};
+
+    // only used when the frame ring buffer is unavailable or full
+    inline static GLuint _drawBuffer = 0;
+    inline static GLuint _materialBuffer = 0;
+    inline static GLuint _indirectBuffer = 0;
+    inline static GLuint _paletteBuffer = 0;
+
+    // The shading pass: batches, materials whose shaders are still compiling, then per material draws
+    static void renderOpaque(const std::vector<const scratch::DrawItem *> &visibleItems, const glm::mat4 &view,
+                             const glm::mat4 &projection, const glm::vec3 &viewPosition,
+                             const scratch::DirectionalLight &directionalLight);
+
+    // Draws everything using a batchable shader with one multi-draw per shader and index width
+    static void renderBatches(const std::vector<const scratch::DrawItem *> &drawItems, const glm::mat4 &view,
+                              const glm::mat4 &projection, const glm::vec3 &viewPosition,
+                              const scratch::DirectionalLight &directionalLight);
+
+    // Depth for every shadow cascade, each drawing only the casters inside its own frustum
+    static void renderShadows(const std::vector<scratch::DrawItem> &renderQueue, int viewportWidth,
+                              int viewportHeight);
+
+    static void renderDepthPrepass(const std::vector<const scratch::DrawItem *> &drawItems, const glm::mat4 &view,
+                                   const glm::mat4 &projection);
+
+    // Multi-draws depth for the items from the bound DrawBuffer, one call per index width. Item i reads draw data
+    // i, or its index from drawDataBase when the draw data was written for a whole array of items.
+    static void renderDepthBatched(const std::vector<const scratch::DrawItem *> &drawItems,
+                                   const scratch::DrawItem *drawDataBase, const glm::mat4 &view,
+                                   const glm::mat4 &projection);
+
+    static bool canBatchDepth();
+
+    // Collects the results of the queries issued two frames ago into the stats if they're in
+    static void readSampleQueries(unsigned int slot);
+
+    static std::vector<const scratch::DrawItem *> cullDrawItems(const std::vector<scratch::DrawItem> &renderQueue,
+                                                                const scratch::Frustum &frustum);
+
+    static void renderWithFallback(const std::vector<const scratch::DrawItem *> &drawItems, const glm::mat4 &view,
+                                   const glm::mat4 &projection);
+
+    // Uniforms every lit shader takes, whichever path draws it
+    static void applyLighting(scratch::Shader &shader, const scratch::DirectionalLight &directionalLight);
+
+    static GpuMaterial packMaterial(const scratch::Material &material);
+
+    // Respecifies the buffer's whole store, orphaning last frame's contents
+    static void streamBuffer(GLenum target, GLuint &buffer, const void *data, size_t byteSize);
+
+    // Writes this frame's data to the frame ring buffer and binds the range to the storage binding, streaming
+    // fallbackBuffer instead when the ring can't take it
+    static void bindFrameStorage(GLuint binding, GLuint &fallbackBuffer, const void *data, size_t byteSize);
+
+    // Same for indirect commands, bound as the draw indirect buffer. Returns the offset of the first command.
+    static GLintptr bindFrameCommands(const std::vector<scratch::DrawElementsIndirectCommand> &commands);
 };
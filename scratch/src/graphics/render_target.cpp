@@ -0,0 +1,85 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include "render_target.h"
+
+#include <iostream>
+
+scratch::RenderTarget::RenderTarget(int width, int height, GLenum colorFormat, bool hasDepth) {
+    _width = width;
+    _height = height;
+    _colorFormat = colorFormat;
+
+    // nothing is uploaded, so the pixel format only has to be valid for the internal format
+    glGenTextures(1, &_colorTexture);
+    glBindTexture(GL_TEXTURE_2D, _colorTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(colorFormat), width, height, 0, GL_RGBA, GL_FLOAT, nullptr);
+    // linear so a scaled target can be stretched over the window
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    if (hasDepth) {
+        glGenTextures(1, &_depthTexture);
+        glBindTexture(GL_TEXTURE_2D, _depthTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0, GL_DEPTH_STENCIL,
+                     GL_UNSIGNED_INT_24_8, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _colorTexture, 0);
+    if (hasDepth) {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, _depthTexture, 0);
+    }
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "Render target " << width << "x" << height << " is incomplete" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+scratch::RenderTarget::~RenderTarget() {
+    glDeleteFramebuffers(1, &_framebuffer);
+    glDeleteTextures(1, &_colorTexture);
+    glDeleteTextures(1, &_depthTexture);
+}
+
+void scratch::RenderTarget::bind() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+    glViewport(0, 0, _width, _height);
+}
+
+int scratch::RenderTarget::getWidth() const {
+    return _width;
+}
+
+int scratch::RenderTarget::getHeight() const {
+    return _height;
+}
+
+GLenum scratch::RenderTarget::getColorFormat() const {
+    return _colorFormat;
+}
+
+bool scratch::RenderTarget::hasDepth() const {
+    return _depthTexture != 0;
+}
+
+GLuint scratch::RenderTarget::getFramebuffer() const {
+    return _framebuffer;
+}
+
+GLuint scratch::RenderTarget::getColorTexture() const {
+    return _colorTexture;
+}
+
+GLuint scratch::RenderTarget::getDepthTexture() const {
+    return _depthTexture;
+}
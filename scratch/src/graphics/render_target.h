@@ -0,0 +1,47 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <glad/glad.h>
+
+namespace scratch {
+    // A framebuffer with one color texture and optionally a depth-stencil texture, both sampleable afterwards
+    class RenderTarget {
+    public:
+        RenderTarget(int width, int height, GLenum colorFormat, bool hasDepth);
+
+        ~RenderTarget();
+
+        // Owns its GL objects, see RenderTargetPool for sharing them
+        RenderTarget(const RenderTarget &other) = delete;
+
+        RenderTarget &operator=(const RenderTarget &other) = delete;
+
+        // Binds for drawing and reading, with the viewport covering the whole target
+        void bind() const;
+
+        int getWidth() const;
+
+        int getHeight() const;
+
+        GLenum getColorFormat() const;
+
+        bool hasDepth() const;
+
+        GLuint getFramebuffer() const;
+
+        GLuint getColorTexture() const;
+
+        // 0 without depth
+        GLuint getDepthTexture() const;
+
+    private:
+        int _width;
+        int _height;
+        GLenum _colorFormat;
+        GLuint _framebuffer = 0;
+        GLuint _colorTexture = 0;
+        GLuint _depthTexture = 0;
+    };
+}
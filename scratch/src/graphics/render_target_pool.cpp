@@ -0,0 +1,37 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include "render_target_pool.h"
+
+#include <algorithm>
+
+std::shared_ptr<scratch::RenderTarget> scratch::RenderTargetPool::acquire(int width, int height, GLenum colorFormat,
+                                                                          bool hasDepth) {
+    for (auto &pooledTarget : _targets) {
+        const RenderTarget &target = *pooledTarget.target;
+        // the pool's own reference is the only one when nobody holds it
+        if (pooledTarget.target.use_count() == 1 && target.getWidth() == width && target.getHeight() == height &&
+            target.getColorFormat() == colorFormat && target.hasDepth() == hasDepth) {
+            pooledTarget.lastAcquiredFrame = _frame;
+            return pooledTarget.target;
+        }
+    }
+    _targets.push_back({std::make_shared<RenderTarget>(width, height, colorFormat, hasDepth), _frame});
+    return _targets.back().target;
+}
+
+void scratch::RenderTargetPool::endFrame() {
+    _targets.erase(std::remove_if(_targets.begin(), _targets.end(), [](const PooledTarget &pooledTarget) {
+        return pooledTarget.target.use_count() == 1 && _frame - pooledTarget.lastAcquiredFrame > MAX_IDLE_FRAMES;
+    }), _targets.end());
+    ++_frame;
+}
+
+size_t scratch::RenderTargetPool::getTargetCount() {
+    return _targets.size();
+}
+
+void scratch::RenderTargetPool::shutdown() {
+    _targets.clear();
+}
@@ -0,0 +1,40 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <glad/glad.h>
+
+#include <memory>
+#include <vector>
+
+#include "render_target.h"
+
+namespace scratch {
+    // Hands out render targets by size and format, reusing ones nobody holds anymore instead of reallocating
+    // every frame. Targets that go unrequested for a few frames, e.g. the old size after a resize or a render
+    // scale change, are freed.
+    class RenderTargetPool {
+    public:
+        // A matching target nobody else is holding, created when there's none
+        static std::shared_ptr<RenderTarget> acquire(int width, int height, GLenum colorFormat, bool hasDepth);
+
+        // Call once per frame, frees the targets that have been idle too long
+        static void endFrame();
+
+        static size_t getTargetCount();
+
+        static void shutdown();
+
+    private:
+        struct PooledTarget {
+            std::shared_ptr<RenderTarget> target;
+            unsigned int lastAcquiredFrame;
+        };
+
+        static const unsigned int MAX_IDLE_FRAMES = 3;
+
+        inline static std::vector<PooledTarget> _targets;
+        inline static unsigned int _frame = 0;
+    };
+}
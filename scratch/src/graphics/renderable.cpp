@@ -7,3 +7,13 @@
 unsigned int scratch::Renderable::getId() const {
     return id;
 }
+
+const scratch::Skeleton &scratch::Renderable::getSkeleton() const {
+    static const Skeleton emptySkeleton;
+    return emptySkeleton;
+}
+
+const std::vector<scratch::AnimationClip> &scratch::Renderable::getAnimations() const {
+    static const std::vector<AnimationClip> noAnimations;
+    return noAnimations;
+}
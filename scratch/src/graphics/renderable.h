@@ -6,6 +6,8 @@
 #include <include/rapidjson/prettywriter.h>
 #include <include/rapidjson/document.h>
 #include "mesh.hpp"
+#include "animation/animation_clip.h"
+#include "animation/skeleton.h"
 
 namespace scratch {
     class Renderable {
@@ -18,6 +20,11 @@ namespace scratch {
 
         virtual const std::vector<std::shared_ptr<scratch::Material>> &getMaterials() const = 0;
 
+        // Joint hierarchy the meshes are skinned to, empty for renderables that can't be animated
+        virtual const scratch::Skeleton &getSkeleton() const;
+
+        virtual const std::vector<scratch::AnimationClip> &getAnimations() const;
+
         virtual void serialize(rapidjson::PrettyWriter<rapidjson::StringBuffer> &writer) = 0;
 
         unsigned int getId() const;
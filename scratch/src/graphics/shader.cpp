@@ -1,11 +1,16 @@
 #include "shader.h"
+#include "shader_cache.h"
+#include <GLFW/glfw3.h>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
-#include <filesystem>
 #include <include/rapidjson/document.h>
 
+// KHR_parallel_shader_compile isn't in every generated loader
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
 
 scratch::Shader::Shader(const unsigned int Id, const std::string &vertexPath, const std::string fragmentPath) {
     this->_id = Id;
@@ -13,7 +18,45 @@ scratch::Shader::Shader(const unsigned int Id, const std::string &vertexPath, co
     _vertexPath = vertexPath;
     _fragmentPath = fragmentPath;
 
-    _shaderId = compileShaders();
+    compileShaders();
+}
+
+scratch::Shader::Shader(const Shader &baseShader, uint32_t features) {
+    _id = baseShader._id;
+    _vertexPath = baseShader._vertexPath;
+    _fragmentPath = baseShader._fragmentPath;
+    _features = features;
+
+    compileShaders();
+}
+
+scratch::Shader *scratch::Shader::getVariant(uint32_t features) {
+    features &= _supportedFeatures;
+    // variants don't have variants of their own
+    if (features == 0 || _features != 0) {
+        return this;
+    }
+    auto found = _variants.find(features);
+    if (found == _variants.end()) {
+        found = _variants.emplace(features, std::shared_ptr<Shader>(new Shader(*this, features))).first;
+    }
+    return found->second.get();
+}
+
+uint32_t scratch::Shader::getFeatures() const {
+    return _features;
+}
+
+uint32_t scratch::Shader::findSupportedFeatures(const std::string &source) {
+    uint32_t supported = 0;
+    for (const auto &[feature, define] : SHADER_FEATURE_TO_DEFINE) {
+        if (source.find("#ifdef " + define) != std::string::npos ||
+            source.find("#ifndef " + define) != std::string::npos ||
+            source.find("defined(" + define + ")") != std::string::npos) {
+            supported |= feature;
+        }
+    }
+    return supported;
 }
 
 void scratch::Shader::use() const {
@@ -21,38 +64,119 @@ void scratch::Shader::use() const {
 }
 
 void scratch::Shader::reload() {
-    std::cout << "Reloading shader..." << std::endl;
-    int newShaderId = compileShaders();
-
-    std::cout << "Deleting Shader: " << _shaderId << std::endl;
-    glDeleteProgram(_shaderId);
-    std::cout << "Setting new Shader ID: " << newShaderId << std::endl;
-    _shaderId = newShaderId;
-    std::cout << "Set new Shader ID: " << _shaderId << std::endl;
+    std::cout << "Reloading shader " << _vertexPath << ", " << _fragmentPath << std::endl;
+    // the current program keeps drawing until the new one is linked
+    discardPendingProgram();
+    compileShaders();
+    for (auto &[features, variant] : _variants) {
+        variant->reload();
+    }
+}
 
-    std::cout << "Finished reloading shader..." << std::endl;
+bool scratch::Shader::isReady() {
+    if (_pendingProgram != 0) {
+        GLint complete = GL_TRUE;
+        if (hasParallelCompile()) {
+            glGetProgramiv(_pendingProgram, GL_COMPLETION_STATUS_KHR, &complete);
+        }
+        // without the extension the status queries in finishCompile block, which is what waiting means there
+        if (complete == GL_TRUE) {
+            finishCompile();
+        }
+    }
+    return _shaderId != 0;
 }
 
-int scratch::Shader::compileShaders() {
-    std::cout << "Compiling shaders..." << std::endl;
-    int vertexShader = generateAndCompileShader(_vertexPath, GL_VERTEX_SHADER);
-    checkSuccessfulShaderCompilation(vertexShader);
+bool scratch::Shader::waitUntilReady() {
+    if (_pendingProgram != 0) {
+        finishCompile();
+    }
+    return _shaderId != 0;
+}
 
-    int fragmentShader = generateAndCompileShader(_fragmentPath, GL_FRAGMENT_SHADER);
-    checkSuccessfulShaderCompilation(fragmentShader);
+void scratch::Shader::compileShaders() {
+    std::string vertexSource = loadSource(_vertexPath);
+    std::string fragmentSource = loadSource(_fragmentPath);
+    if (_features == 0) {
+        _supportedFeatures = findSupportedFeatures(vertexSource) | findSupportedFeatures(fragmentSource);
+    }
 
     unsigned int shaderProgram;
     shaderProgram = glCreateProgram();
 
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
+    // A binary linked from the exact same sources by the same driver skips compiling entirely
+    std::string cacheKey = ShaderCache::makeKey({vertexSource, fragmentSource});
+    if (ShaderCache::load(cacheKey, shaderProgram)) {
+        glDeleteProgram(_shaderId);
+        _shaderId = shaderProgram;
+        _batchable = hasDrawBuffer(shaderProgram);
+        return;
+    }
+
+    std::cout << "Compiling shaders " << _vertexPath << ", " << _fragmentPath << std::endl;
+    hasParallelCompile();
+    _pendingVertexShader = generateAndCompileShader(vertexSource, GL_VERTEX_SHADER);
+    _pendingFragmentShader = generateAndCompileShader(fragmentSource, GL_FRAGMENT_SHADER);
+
+    // Linking straight away is fine, a failed compile just fails the link
+    glAttachShader(shaderProgram, _pendingVertexShader);
+    glAttachShader(shaderProgram, _pendingFragmentShader);
+    if (ShaderCache::isSupported()) {
+        glProgramParameteri(shaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glLinkProgram(shaderProgram);
 
-    checkSuccessfulShaderLink(shaderProgram);
+    _pendingProgram = shaderProgram;
+    _pendingCacheKey = cacheKey;
+}
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-    return shaderProgram;
+void scratch::Shader::finishCompile() {
+    bool compiled = checkSuccessfulShaderCompilation(_pendingVertexShader) &&
+                    checkSuccessfulShaderCompilation(_pendingFragmentShader);
+    if (!compiled || !checkSuccessfulShaderLink(_pendingProgram)) {
+        std::cout << "Keeping the previous program for " << _vertexPath << ", " << _fragmentPath << std::endl;
+        discardPendingProgram();
+        return;
+    }
+
+    glDetachShader(_pendingProgram, _pendingVertexShader);
+    glDetachShader(_pendingProgram, _pendingFragmentShader);
+    glDeleteShader(_pendingVertexShader);
+    glDeleteShader(_pendingFragmentShader);
+    ShaderCache::store(_pendingCacheKey, _pendingProgram);
+
+    glDeleteProgram(_shaderId);
+    _shaderId = _pendingProgram;
+    _batchable = hasDrawBuffer(_shaderId);
+    _pendingProgram = 0;
+    _pendingVertexShader = 0;
+    _pendingFragmentShader = 0;
+}
+
+void scratch::Shader::discardPendingProgram() {
+    if (_pendingProgram == 0) {
+        return;
+    }
+    glDeleteShader(_pendingVertexShader);
+    glDeleteShader(_pendingFragmentShader);
+    glDeleteProgram(_pendingProgram);
+    _pendingProgram = 0;
+    _pendingVertexShader = 0;
+    _pendingFragmentShader = 0;
+}
+
+bool scratch::Shader::hasParallelCompile() {
+    if (_parallelCompile < 0) {
+        _parallelCompile = 0;
+        auto maxShaderCompilerThreads = reinterpret_cast<void (GLAPIENTRY *)(GLuint)>(
+                glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+        if (glfwExtensionSupported("GL_KHR_parallel_shader_compile") && maxShaderCompilerThreads != nullptr) {
+            // let the driver pick how many threads to use
+            maxShaderCompilerThreads(0xFFFFFFFF);
+            _parallelCompile = 1;
+        }
+    }
+    return _parallelCompile == 1;
 }
 
 void scratch::Shader::setBool(const std::string &name, bool value) const {
@@ -75,17 +199,36 @@ void scratch::Shader::setMat4(const std::string &name, glm::mat4 value) const {
     glUniformMatrix4fv(glGetUniformLocation(_shaderId, name.c_str()), 1, GL_FALSE, glm::value_ptr(value));
 }
 
+void scratch::Shader::setVec2(const std::string &name, glm::vec2 value) const {
+    glUniform2f(glGetUniformLocation(_shaderId, name.c_str()), value.x, value.y);
+}
+
 void scratch::Shader::setVec3(const std::string &name, glm::vec3 value) const {
     glUniform3f(glGetUniformLocation(_shaderId, name.c_str()), value.x, value.y, value.z);
 }
 
-int scratch::Shader::generateAndCompileShader(std::string sourceFileLocation, int shaderType) {
+std::string scratch::Shader::loadSource(const std::string &sourceFileLocation) {
+    std::string shaderSource = readFileContents(sourceFileLocation);
+    std::string defines = _globalDefines;
+    for (const auto &[feature, define] : SHADER_FEATURE_TO_DEFINE) {
+        if (_features & feature) {
+            defines += "#define " + define + "\n";
+        }
+    }
+    // Defines have to come after the #version line
+    if (!defines.empty()) {
+        size_t versionEnd = shaderSource.rfind("#version", 0) == 0 ? shaderSource.find('\n') : std::string::npos;
+        size_t insertAt = versionEnd == std::string::npos ? 0 : versionEnd + 1;
+        shaderSource.insert(insertAt, defines);
+    }
+    return shaderSource;
+}
+
+int scratch::Shader::generateAndCompileShader(const std::string &shaderSource, int shaderType) {
     unsigned int shaderId;
     // Create Shader Object
     shaderId = glCreateShader(shaderType);
 
-    // Read source code into a C std::string
-    std::string shaderSource = readFileContents(sourceFileLocation);
     const char *vertexShaderSource = shaderSource.c_str();
     // Read source code into shader object
     glShaderSource(shaderId, 1, &vertexShaderSource, nullptr);
@@ -97,7 +240,6 @@ int scratch::Shader::generateAndCompileShader(std::string sourceFileLocation, in
 }
 
 std::string scratch::Shader::readFileContents(std::string filename) {
-    std::cout << std::filesystem::current_path() << std::endl;
     std::ifstream file;
     file.open(filename);
     std::stringstream fileStream;
@@ -107,7 +249,7 @@ std::string scratch::Shader::readFileContents(std::string filename) {
     return fileStream.str();
 }
 
-void scratch::Shader::checkSuccessfulShaderCompilation(int shaderId) {
+bool scratch::Shader::checkSuccessfulShaderCompilation(int shaderId) {
     // Check if shader compilation was successful
     int success;
     char infoLog[512];
@@ -116,11 +258,11 @@ void scratch::Shader::checkSuccessfulShaderCompilation(int shaderId) {
         glGetShaderInfoLog(shaderId, 512, NULL, infoLog);
         std::cout << "ERROR::scratch::SHADER::COMPILATION_FAILED\n"
                   << infoLog << std::endl;
-        throw std::runtime_error("Shader Compilation Unsuccessful");
     }
+    return success;
 }
 
-void scratch::Shader::checkSuccessfulShaderLink(int shaderProgramId) {
+bool scratch::Shader::checkSuccessfulShaderLink(int shaderProgramId) {
     // Check if shader compilation was successful
     int success;
     char infoLog[512];
@@ -129,8 +271,8 @@ void scratch::Shader::checkSuccessfulShaderLink(int shaderProgramId) {
         glGetProgramInfoLog(shaderProgramId, 512, NULL, infoLog);
         std::cout << "ERROR::scratch::SHADER::PROGRAM::LINK_FAILED\n"
                   << infoLog << std::endl;
-        throw std::runtime_error("Shader Linking Unsuccessful");
     }
+    return success;
 }
 
 void scratch::Shader::serialize(rapidjson::PrettyWriter<rapidjson::StringBuffer> &writer) {
@@ -152,7 +294,7 @@ void scratch::Shader::deserialize(const rapidjson::Value &object) {
     _id = object["id"].GetUint();
     _vertexPath = object["vertexPath"].GetString();
     _fragmentPath = object["fragmentPath"].GetString();
-    _shaderId = compileShaders();
+    compileShaders();
 }
 
 const std::string &scratch::Shader::getVertexPath() const {
@@ -172,3 +314,22 @@ unsigned int scratch::Shader::getId() const {
 }
 
 
+
+bool scratch::Shader::isBatchable() const {
+    return _batchable;
+}
+
+void scratch::Shader::setGlobalDefines(const std::vector<std::string> &defines) {
+    _globalDefines.clear();
+    for (const auto &define : defines) {
+        _globalDefines += "#define " + define + "\n";
+    }
+}
+
+bool scratch::Shader::hasDrawBuffer(unsigned int program) {
+    // program interface queries are 4.3+, older contexts never batch
+    if (!GLAD_GL_VERSION_4_3) {
+        return false;
+    }
+    return glGetProgramResourceIndex(program, GL_SHADER_STORAGE_BLOCK, "DrawBuffer") != GL_INVALID_INDEX;
+}
@@ -4,15 +4,33 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <cstdint>
+#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 #include <include/rapidjson/writer.h>
 #include <include/rapidjson/prettywriter.h>
 #include <include/rapidjson/document.h>
 
 namespace scratch {
+    // Compile time features of a shader variant, each one a #define the sources can test
+    enum ShaderFeature : uint32_t {
+        NORMAL_MAP_FEATURE = 1 << 0,
+        SPECULAR_MAP_FEATURE = 1 << 1,
+        HIGHLIGHTED_FEATURE = 1 << 2,
+        FXAA_FEATURE = 1 << 3
+    };
+    const std::map<ShaderFeature, std::string> SHADER_FEATURE_TO_DEFINE{{NORMAL_MAP_FEATURE,   "NORMAL_MAP"},
+                                                                        {SPECULAR_MAP_FEATURE, "SPECULAR_MAP"},
+                                                                        {HIGHLIGHTED_FEATURE,  "HIGHLIGHTED"},
+                                                                        {FXAA_FEATURE,         "FXAA"}};
+
+    // A vertex and fragment source pair. The shader itself is the variant without features, getVariant
+    // compiles and caches the others.
     class Shader {
     public:
-        // Read + compile shader
+        // Reads the sources and starts compiling, see isReady
         Shader(const unsigned int Id, const std::string& vertexPath, std::string fragmentPath);
 
         Shader() = default;
@@ -26,6 +44,27 @@ namespace scratch {
 
         unsigned int getId() const;
 
+        // The variant of this shader compiled with features, features the sources never test are ignored so
+        // they don't produce duplicate programs. Variants are compiled on first use and reloaded with the shader.
+        Shader *getVariant(uint32_t features);
+
+        uint32_t getFeatures() const;
+
+        // Whether the program reads per draw data from the DrawBuffer storage block, so the render system can
+        // draw it with multi-draw batches instead of per draw uniforms
+        bool isBatchable() const;
+
+        // Defines prepended to every shader compiled from now on, e.g. the texture binding mode
+        static void setGlobalDefines(const std::vector<std::string> &defines);
+
+        // Whether a linked program can be used. Compiles run in the background where the driver supports
+        // KHR_parallel_shader_compile, this polls them and swaps the program in once done. After a reload the
+        // previous program stays usable until the new one is ready.
+        bool isReady();
+
+        // Blocks until the pending compile is done, returns isReady
+        bool waitUntilReady();
+
         // Activate shader
         void use() const;
 
@@ -41,6 +80,8 @@ namespace scratch {
 
         void setMat4(const std::string &name, glm::mat4 value) const;
 
+        void setVec2(const std::string &name, glm::vec2 value) const;
+
         void setVec3(const std::string &name, glm::vec3 value) const;
 
         void serialize(rapidjson::PrettyWriter<rapidjson::StringBuffer> &writer);
@@ -50,18 +91,51 @@ namespace scratch {
 
     private:
         unsigned int _id;
-        unsigned int _shaderId;
+        unsigned int _shaderId = 0;
         std::string _vertexPath;
         std::string _fragmentPath;
+        bool _batchable = false;
+        inline static std::string _globalDefines;
+        // -1 until the driver has been asked
+        inline static int _parallelCompile = -1;
+
+        // program compiling in the background and what's needed to finish it
+        unsigned int _pendingProgram = 0;
+        unsigned int _pendingVertexShader = 0;
+        unsigned int _pendingFragmentShader = 0;
+        std::string _pendingCacheKey;
+
+        // set on variants, 0 for the shader the variants belong to
+        uint32_t _features = 0;
+        // features the sources test for, found when the base shader compiles
+        uint32_t _supportedFeatures = 0;
+        std::map<uint32_t, std::shared_ptr<Shader>> _variants;
+
+        Shader(const Shader &baseShader, uint32_t features);
+
+        static uint32_t findSupportedFeatures(const std::string &source);
 
         std::string readFileContents(std::string filename);
 
-        int compileShaders();
+        // Submits compile and link without waiting on either
+        void compileShaders();
+
+        // Checks the pending program and swaps it in when it linked, compile errors are logged and dropped
+        void finishCompile();
+
+        void discardPendingProgram();
+
+        static bool hasParallelCompile();
+
+        static bool hasDrawBuffer(unsigned int program);
+
+        bool checkSuccessfulShaderCompilation(int shaderId);
 
-        void checkSuccessfulShaderCompilation(int shaderId);
+        // File contents with the global defines added
+        std::string loadSource(const std::string &sourceFileLocation);
 
-        int generateAndCompileShader(std::string sourceFileLocation, int shaderType);
+        int generateAndCompileShader(const std::string &shaderSource, int shaderType);
 
-        void checkSuccessfulShaderLink(int shaderId);
+        bool checkSuccessfulShaderLink(int shaderId);
     };
 } // namespace scratch
\ No newline at end of file
@@ -0,0 +1,128 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "shader_cache.h"
+
+namespace {
+    const char CACHE_MAGIC[4] = {'S', 'P', 'B', '1'};
+    const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+    const uint64_t FNV_PRIME = 1099511628211ull;
+
+    std::string getGlString(GLenum name) {
+        const auto *value = reinterpret_cast<const char *>(glGetString(name));
+        return value != nullptr ? value : "";
+    }
+}
+
+void scratch::ShaderCache::setDirectory(const std::string &directory) {
+    _directory = directory;
+}
+
+std::string scratch::ShaderCache::makeKey(const std::vector<std::string> &sources) {
+    std::string keyData = getGlString(GL_VENDOR) + "\n" + getGlString(GL_RENDERER) + "\n" + getGlString(GL_VERSION);
+    for (const auto &source : sources) {
+        // length prefix so moving text between sources changes the key
+        keyData += "\n" + std::to_string(source.size()) + "\n" + source;
+    }
+    // two differently seeded 64 bit hashes, a collision would hand a program the wrong binary
+    std::stringstream key;
+    key << std::hex << std::setfill('0') << std::setw(16) << hash(keyData, FNV_OFFSET_BASIS)
+        << std::setw(16) << hash(keyData, FNV_OFFSET_BASIS ^ 0x9E3779B97F4A7C15ull);
+    return key.str();
+}
+
+bool scratch::ShaderCache::load(const std::string &key, GLuint program) {
+    if (!isSupported()) {
+        return false;
+    }
+    std::ifstream file(getPath(key), std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    std::streamoff fileSize = file.tellg();
+    file.seekg(0);
+    char magic[4];
+    GLenum binaryFormat;
+    uint32_t length;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char *>(&binaryFormat), sizeof(binaryFormat));
+    file.read(reinterpret_cast<char *>(&length), sizeof(length));
+    if (!file || std::memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0) {
+        return false;
+    }
+    // a truncated or corrupt entry is a miss, the program compiles from source and the entry is rewritten
+    std::streamoff remaining = fileSize - static_cast<std::streamoff>(file.tellg());
+    if (length == 0 || static_cast<std::streamoff>(length) > remaining) {
+        return false;
+    }
+    std::vector<char> binary(length);
+    file.read(binary.data(), length);
+    if (!file || file.gcount() != static_cast<std::streamsize>(length)) {
+        return false;
+    }
+
+    glProgramBinary(program, binaryFormat, binary.data(), static_cast<GLsizei>(length));
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    return success == GL_TRUE;
+}
+
+void scratch::ShaderCache::store(const std::string &key, GLuint program) {
+    if (!isSupported()) {
+        return;
+    }
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+    std::vector<char> binary(length);
+    GLenum binaryFormat;
+    glGetProgramBinary(program, length, nullptr, &binaryFormat, binary.data());
+
+    std::error_code error;
+    std::filesystem::create_directories(_directory, error);
+    std::ofstream file(getPath(key), std::ios::binary | std::ios::trunc);
+    auto binaryLength = static_cast<uint32_t>(length);
+    file.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    file.write(reinterpret_cast<const char *>(&binaryFormat), sizeof(binaryFormat));
+    file.write(reinterpret_cast<const char *>(&binaryLength), sizeof(binaryLength));
+    file.write(binary.data(), length);
+    if (!file) {
+        // the cache is only an optimization, next start compiles from source again
+        std::cout << "Could not write shader cache " << getPath(key) << std::endl;
+    }
+}
+
+bool scratch::ShaderCache::isSupported() {
+    if (_supported < 0) {
+        GLint formatCount = 0;
+        if (GLAD_GL_VERSION_4_1) {
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        }
+        _supported = formatCount > 0 ? 1 : 0;
+    }
+    return _supported == 1;
+}
+
+std::string scratch::ShaderCache::getPath(const std::string &key) {
+    return (std::filesystem::path(_directory) / (key + ".bin")).string();
+}
+
+uint64_t scratch::ShaderCache::hash(const std::string &data, uint64_t seed) {
+    // FNV-1a
+    uint64_t result = seed;
+    for (unsigned char character : data) {
+        result ^= character;
+        result *= FNV_PRIME;
+    }
+    return result;
+}
@@ -0,0 +1,39 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace scratch {
+    // On disk cache of linked program binaries. Keys hash the shader sources together with the driver's vendor,
+    // renderer and version strings, so a driver update or an edited source simply misses and compiles again.
+    class ShaderCache {
+    public:
+        static void setDirectory(const std::string &directory);
+
+        // Needs a current GL context for the driver strings
+        static std::string makeKey(const std::vector<std::string> &sources);
+
+        // Loads the cached binary into program, false if there is none or the driver rejects it
+        static bool load(const std::string &key, GLuint program);
+
+        // program has to be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+        static void store(const std::string &key, GLuint program);
+
+        static bool isSupported();
+
+    private:
+        inline static std::string _directory = "./shader_cache";
+        // -1 until the driver has been asked
+        inline static int _supported = -1;
+
+        static std::string getPath(const std::string &key);
+
+        static uint64_t hash(const std::string &data, uint64_t seed);
+    };
+}
@@ -0,0 +1,190 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include "shadow_maps.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <glm/gtc/matrix_transform.hpp>
+
+void scratch::ShadowMaps::setCascadeCount(unsigned int cascadeCount) {
+    _cascadeCount = std::min(cascadeCount, MAX_CASCADES);
+}
+
+unsigned int scratch::ShadowMaps::getCascadeCount() {
+    return _cascadeCount;
+}
+
+void scratch::ShadowMaps::setResolution(int resolution) {
+    _resolution = std::max(resolution, 1);
+}
+
+int scratch::ShadowMaps::getResolution() {
+    return _resolution;
+}
+
+void scratch::ShadowMaps::setShadowDistance(float shadowDistance) {
+    _shadowDistance = shadowDistance;
+}
+
+float scratch::ShadowMaps::getShadowDistance() {
+    return _shadowDistance;
+}
+
+void scratch::ShadowMaps::setSplitLambda(float splitLambda) {
+    _splitLambda = std::clamp(splitLambda, 0.0f, 1.0f);
+}
+
+float scratch::ShadowMaps::getSplitLambda() {
+    return _splitLambda;
+}
+
+void scratch::ShadowMaps::update(const glm::mat4 &view, const glm::mat4 &projection,
+                                 const glm::vec3 &lightDirection) {
+    if (_cascadeCount == 0) {
+        return;
+    }
+    if (_textureCascades != _cascadeCount || _textureResolution != _resolution) {
+        createDepthTexture();
+    }
+
+    float nearPlane = projection[3][2] / (projection[2][2] - 1.0f);
+    float farPlane = projection[3][2] / (projection[2][2] + 1.0f);
+    float shadowFar = std::min(farPlane, _shadowDistance);
+
+    // corners of the whole camera frustum, cascades slide along the edges between them
+    glm::mat4 inverseViewProjection = glm::inverse(projection * view);
+    glm::vec3 nearCorners[4];
+    glm::vec3 farCorners[4];
+    for (int corner = 0; corner < 4; ++corner) {
+        glm::vec2 ndc((corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f);
+        glm::vec4 nearCorner = inverseViewProjection * glm::vec4(ndc, -1.0f, 1.0f);
+        glm::vec4 farCorner = inverseViewProjection * glm::vec4(ndc, 1.0f, 1.0f);
+        nearCorners[corner] = glm::vec3(nearCorner) / nearCorner.w;
+        farCorners[corner] = glm::vec3(farCorner) / farCorner.w;
+    }
+
+    glm::vec3 direction = glm::normalize(lightDirection);
+    float previousSplit = nearPlane;
+    for (unsigned int cascade = 0; cascade < _cascadeCount; ++cascade) {
+        // the practical split scheme, logarithmic splits pulled towards even ones by the lambda
+        float fraction = static_cast<float>(cascade + 1) / static_cast<float>(_cascadeCount);
+        float logSplit = nearPlane * std::pow(shadowFar / nearPlane, fraction);
+        float evenSplit = nearPlane + (shadowFar - nearPlane) * fraction;
+        float split = _splitLambda * logSplit + (1.0f - _splitLambda) * evenSplit;
+
+        glm::vec3 corners[8];
+        for (int corner = 0; corner < 4; ++corner) {
+            glm::vec3 edge = farCorners[corner] - nearCorners[corner];
+            corners[corner] = nearCorners[corner] + edge * ((previousSplit - nearPlane) / (farPlane - nearPlane));
+            corners[corner + 4] = nearCorners[corner] + edge * ((split - nearPlane) / (farPlane - nearPlane));
+        }
+        _cascades[cascade] = fitCascade(corners, split, direction);
+        previousSplit = split;
+    }
+}
+
+scratch::ShadowCascade scratch::ShadowMaps::fitCascade(const glm::vec3 corners[8], float splitDepth,
+                                                       const glm::vec3 &lightDirection) {
+    // a sphere rather than a box keeps the projection the same size however the camera is turned
+    glm::vec3 center = glm::vec3(0.0f);
+    for (int corner = 0; corner < 8; ++corner) {
+        center += corners[corner];
+    }
+    center /= 8.0f;
+    float radius = 0.0f;
+    for (int corner = 0; corner < 8; ++corner) {
+        radius = std::max(radius, glm::length(corners[corner] - center));
+    }
+    radius = std::ceil(radius * 16.0f) / 16.0f;
+
+    glm::vec3 up = std::abs(lightDirection.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::mat4 lightView = glm::lookAt(center - lightDirection * (radius + _casterDistance), center, up);
+    glm::mat4 lightProjection = glm::ortho(-radius, radius, -radius, radius, 0.0f,
+                                           2.0f * radius + _casterDistance);
+
+    // move the projection so the world origin lands on a texel, then every texel stays put as the camera moves
+    glm::vec4 origin = lightProjection * lightView * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    glm::vec2 texelOrigin = glm::vec2(origin) * (static_cast<float>(_resolution) / 2.0f);
+    glm::vec2 offset = (glm::round(texelOrigin) - texelOrigin) * (2.0f / static_cast<float>(_resolution));
+    lightProjection[3][0] += offset.x;
+    lightProjection[3][1] += offset.y;
+
+    glm::mat4 lightSpaceMatrix = lightProjection * lightView;
+    return {lightView, lightProjection, lightSpaceMatrix, Frustum(lightSpaceMatrix), splitDepth};
+}
+
+const scratch::ShadowCascade &scratch::ShadowMaps::getCascade(unsigned int cascade) {
+    return _cascades[cascade];
+}
+
+void scratch::ShadowMaps::beginCascade(unsigned int cascade) {
+    glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, _depthTexture, 0, static_cast<GLint>(cascade));
+    glViewport(0, 0, _resolution, _resolution);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    // slope scaled bias against acne on surfaces facing away from the light
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(2.0f, 4.0f);
+}
+
+void scratch::ShadowMaps::end(int viewportWidth, int viewportHeight) {
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, viewportWidth, viewportHeight);
+}
+
+void scratch::ShadowMaps::applyToShader(const Shader &shader) {
+    glActiveTexture(GL_TEXTURE0 + SHADOW_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, _depthTexture);
+    glActiveTexture(GL_TEXTURE0);
+    // always set, the sampler would otherwise default to unit 0 and clash with the diffuse texture
+    shader.setInt("shadowMap", SHADOW_TEXTURE_UNIT);
+    shader.setInt("cascadeCount", static_cast<int>(_depthTexture != 0 ? _cascadeCount : 0));
+    shader.setFloat("shadowTexelSize", 1.0f / static_cast<float>(_resolution));
+    for (unsigned int cascade = 0; cascade < _cascadeCount; ++cascade) {
+        std::string index = "[" + std::to_string(cascade) + "]";
+        shader.setMat4("lightSpaceMatrices" + index, _cascades[cascade].lightSpaceMatrix);
+        shader.setFloat("cascadeSplits" + index, _cascades[cascade].splitDepth);
+    }
+}
+
+void scratch::ShadowMaps::createDepthTexture() {
+    glDeleteTextures(1, &_depthTexture);
+    glGenTextures(1, &_depthTexture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, _depthTexture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, _resolution, _resolution,
+                 static_cast<GLsizei>(_cascadeCount), 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    // linear filtering with compare mode gives a 2x2 PCF per tap for free
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    // outside the map counts as lit
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    float border[] = {1.0f, 1.0f, 1.0f, 1.0f};
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    if (_framebuffer == 0) {
+        glGenFramebuffers(1, &_framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+    _textureCascades = _cascadeCount;
+    _textureResolution = _resolution;
+}
+
+void scratch::ShadowMaps::shutdown() {
+    glDeleteTextures(1, &_depthTexture);
+    glDeleteFramebuffers(1, &_framebuffer);
+    _depthTexture = 0;
+    _framebuffer = 0;
+    _textureCascades = 0;
+    _textureResolution = 0;
+}
@@ -0,0 +1,88 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "frustum.h"
+#include "shader.h"
+
+namespace scratch {
+    // One light space orthographic projection covering a depth range of the camera frustum
+    struct ShadowCascade {
+        glm::mat4 view;
+        glm::mat4 projection;
+        // projection * view
+        glm::mat4 lightSpaceMatrix;
+        Frustum frustum;
+        // camera view depth the cascade ends at
+        float splitDepth;
+    };
+
+    // Cascaded shadow maps for the directional light. The camera frustum up to the shadow distance is split into
+    // cascades, each fit with a bounding sphere so its size doesn't change as the camera turns and snapped to
+    // whole texels so edges don't shimmer as it moves. Depth for every cascade lives in one layer of a depth
+    // texture array that lit shaders sample with PCF.
+    class ShadowMaps {
+    public:
+        static const unsigned int MAX_CASCADES = 4;
+        // after the units materials and texture array pages use
+        static const GLint SHADOW_TEXTURE_UNIT = 16;
+
+        // 0 turns shadows off
+        static void setCascadeCount(unsigned int cascadeCount);
+
+        static unsigned int getCascadeCount();
+
+        // Width and height of every cascade in texels
+        static void setResolution(int resolution);
+
+        static int getResolution();
+
+        // How far from the camera shadows are drawn, capped by the camera's far plane
+        static void setShadowDistance(float shadowDistance);
+
+        static float getShadowDistance();
+
+        // Blend between logarithmic (1) and even (0) cascade splits
+        static void setSplitLambda(float splitLambda);
+
+        static float getSplitLambda();
+
+        // Fits the cascades to the camera, recreating the depth texture if the settings changed
+        static void update(const glm::mat4 &view, const glm::mat4 &projection, const glm::vec3 &lightDirection);
+
+        static const ShadowCascade &getCascade(unsigned int cascade);
+
+        // Targets the cascade's layer with a cleared depth buffer, the caller draws the casters
+        static void beginCascade(unsigned int cascade);
+
+        // Back to the default framebuffer at the given viewport
+        static void end(int viewportWidth, int viewportHeight);
+
+        // Binds the depth texture and sets the cascade uniforms
+        static void applyToShader(const Shader &shader);
+
+        static void shutdown();
+
+    private:
+        inline static unsigned int _cascadeCount = MAX_CASCADES;
+        inline static int _resolution = 2048;
+        inline static float _shadowDistance = 50.0f;
+        inline static float _splitLambda = 0.75f;
+        // casters this far behind a cascade still land in its depth range
+        inline static float _casterDistance = 50.0f;
+
+        inline static GLuint _depthTexture = 0;
+        inline static GLuint _framebuffer = 0;
+        inline static unsigned int _textureCascades = 0;
+        inline static int _textureResolution = 0;
+        inline static ShadowCascade _cascades[MAX_CASCADES];
+
+        static void createDepthTexture();
+
+        static ShadowCascade fitCascade(const glm::vec3 corners[8], float splitDepth, const glm::vec3 &lightDirection);
+    };
+}
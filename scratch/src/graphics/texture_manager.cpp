@@ -0,0 +1,945 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include "frame_ring_buffer.h"
+#include "image_downsampler.h"
+#include "texture_manager.h"
+#include "main.h"
+
+// S3TC is an extension, not every loader generates its enums
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+namespace {
+    typedef GLuint64 (GLAPIENTRY *GetTextureSamplerHandleFunction)(GLuint texture, GLuint sampler);
+    typedef void (GLAPIENTRY *TextureHandleFunction)(GLuint64 handle);
+
+    GetTextureSamplerHandleFunction getTextureSamplerHandle = nullptr;
+    TextureHandleFunction makeTextureHandleResident = nullptr;
+    TextureHandleFunction makeTextureHandleNonResident = nullptr;
+
+    const GLsizei ARRAY_PAGE_LAYERS = 16;
+
+    // textures load with their largest resident level no bigger than this
+    const int INITIAL_RESIDENT_SIZE = 128;
+    // frames without a coverage request before a texture falls back to its initial mips
+    const unsigned int UNUSED_FRAMES = 300;
+
+    int countLevels(int width, int height) {
+        int levels = 1;
+        for (int size = std::max(width, height); size > 1; size /= 2) {
+            levels++;
+        }
+        return levels;
+    }
+
+    int getInitialMip(int width, int height, int levels) {
+        int mip = 0;
+        while (mip + 1 < levels && std::max(width >> mip, height >> mip) > INITIAL_RESIDENT_SIZE) {
+            mip++;
+        }
+        return mip;
+    }
+
+    scratch::DownsampleMode getDownsampleMode(scratch::TextureRole role) {
+        switch (role) {
+            case scratch::DIFFUSE_TEXTURE:
+                return scratch::DOWNSAMPLE_SRGB;
+            case scratch::NORMAL_TEXTURE:
+                return scratch::DOWNSAMPLE_NORMAL;
+            default:
+                return scratch::DOWNSAMPLE_LINEAR;
+        }
+    }
+
+    size_t getBytesPerTexel(GLenum internalFormat) {
+        switch (internalFormat) {
+            case GL_R8:
+                return 1;
+            case GL_RG8:
+                return 2;
+            default:
+                return 4;
+        }
+    }
+}
+
+bool scratch::TextureManager::DecodedImage::isValid() const {
+    return pixels != nullptr || compressed != nullptr;
+}
+
+const unsigned char *scratch::TextureManager::DecodedImage::getData() const {
+    return compressed ? compressed->data.data() : pixels.get();
+}
+
+size_t scratch::TextureManager::DecodedImage::getByteSize() const {
+    if (compressed) {
+        return compressed->data.size();
+    }
+    if (!levels.empty()) {
+        return levels.back().offset + levels.back().byteSize;
+    }
+    return static_cast<size_t>(width) * height * channels;
+}
+
+void scratch::TextureManager::initialize(TextureBindingMode preferredBindingMode) {
+    _cancelDecodes = false;
+    bool s3tc = glfwExtensionSupported("GL_EXT_texture_compression_s3tc");
+    _supportedBlockFormats[BC1] = s3tc;
+    _supportedBlockFormats[BC3] = s3tc;
+    // RGTC is core since 3.0, BPTC since 4.2
+    _supportedBlockFormats[BC5] = true;
+    _supportedBlockFormats[BC7] = GLAD_GL_VERSION_4_2 || glfwExtensionSupported("GL_ARB_texture_compression_bptc");
+
+    // batching needs storage buffers and multi-draw indirect, both GL 4.3
+    _bindingMode = preferredBindingMode;
+    // a handle differing between draws of one multi-draw isn't dynamically uniform, sampling through it is
+    // only defined with GL_NV_gpu_shader5 on top of the bindless extension
+    if (_bindingMode == BINDLESS_TEXTURES &&
+        (!glfwExtensionSupported("GL_NV_gpu_shader5") || !loadBindlessFunctions())) {
+        _bindingMode = TEXTURE_ARRAYS;
+    }
+    if (!GLAD_GL_VERSION_4_3) {
+        _bindingMode = BIND_PER_MATERIAL;
+    }
+
+    createPlaceholders();
+    createStagingBuffer();
+    std::cout << "Texture binding mode " << BINDING_MODE_TO_STRING.find(_bindingMode)->second << std::endl;
+}
+
+void scratch::TextureManager::shutdown() {
+    // anything still queued returns straight away, what's running is waited for
+    _cancelDecodes = true;
+    if (!_decodeJobs.isDone()) {
+        scratch::ScratchManagers->jobSystem->wait(_decodeJobs);
+    }
+    _decoded.clear();
+    _waitingForUpload.clear();
+
+    for (auto &entry : _entries) {
+        releaseGlTexture(entry);
+    }
+    _entries.clear();
+    for (auto &retired : _retiredTextures) {
+        releaseRetiredTexture(retired);
+    }
+    _retiredTextures.clear();
+    _handlesByKey.clear();
+    _placeholders.clear();
+
+    for (auto &page : _arrayPages) {
+        glDeleteTextures(1, &page.texture);
+    }
+    _arrayPages.clear();
+    _arrayPagesFull = false;
+
+    for (auto &sampler : _samplers) {
+        glDeleteSamplers(1, &sampler.second);
+    }
+    _samplers.clear();
+
+    destroyStagingBuffer();
+}
+
+unsigned int scratch::TextureManager::requestTexture(const std::string &path, TextureRole role, GLint wrapMode) {
+    std::string key = path + "#" + std::to_string(role);
+    auto existing = _handlesByKey.find(key);
+    if (existing != _handlesByKey.end()) {
+        return existing->second;
+    }
+
+    auto handle = static_cast<unsigned int>(_entries.size());
+    TextureEntry entry;
+    entry.path = path;
+    entry.role = role;
+    entry.wrapMode = wrapMode;
+    _entries.push_back(entry);
+    _handlesByKey[key] = handle;
+    getOrCreateSampler(wrapMode);
+
+    // array pages need every layer the same size, so textures there load whole and never stream
+    int topMip = _bindingMode == TEXTURE_ARRAYS ? 0 : -1;
+    queueDecode(handle, path, role, topMip);
+    return handle;
+}
+
+void scratch::TextureManager::queueDecode(unsigned int handle, const std::string &path, TextureRole role,
+                                          int topMip) {
+    // file reads and filtering take milliseconds, kept off threads that would pick them up while waiting
+    scratch::ScratchManagers->jobSystem->run([handle, path, role, topMip]() {
+        if (!_cancelDecodes) {
+            decode(handle, path, role, topMip);
+        }
+    }, &_decodeJobs, scratch::WORKER_THREAD);
+}
+
+void scratch::TextureManager::decode(unsigned int handle, const std::string &path, TextureRole role, int topMip) {
+    DecodeResult result;
+    result.handle = handle;
+    if (!loadCookedTexture(path, result.image)) {
+        unsigned char *pixels = stbi_load(path.c_str(), &result.image.width, &result.image.height,
+                                          &result.image.channels, 0);
+        result.image.pixels = std::unique_ptr<unsigned char, void (*)(void *)>(pixels, stbi_image_free);
+    }
+    if (result.image.isValid()) {
+        dropLargerMips(result.image, role, topMip);
+        if (!result.image.compressed) {
+            generateMips(result.image, role);
+        }
+        if (!result.image.isValid()) {
+            std::cout << "WARNING: out of memory building the mips of texture " << path << std::endl;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_decodedMutex);
+    _decoded.push_back(std::move(result));
+}
+
+void scratch::TextureManager::dropLargerMips(DecodedImage &image, TextureRole role, int topMip) {
+    image.fullWidth = image.width;
+    image.fullHeight = image.height;
+    int levels = image.compressed ? static_cast<int>(image.compressed->mips.size())
+                                  : countLevels(image.width, image.height);
+    if (topMip < 0) {
+        topMip = getInitialMip(image.width, image.height, levels);
+    }
+    topMip = std::min(topMip, levels - 1);
+    image.topMip = topMip;
+    if (topMip == 0) {
+        return;
+    }
+
+    if (image.compressed) {
+        // cooked files already have every level, just cut off the ones not wanted
+        scratch::CompressedTexture &texture = *image.compressed;
+        size_t removedBytes = texture.mips[topMip].offset;
+        texture.data.erase(texture.data.begin(), texture.data.begin() + removedBytes);
+        texture.mips.erase(texture.mips.begin(), texture.mips.begin() + topMip);
+        for (auto &mip : texture.mips) {
+            mip.offset -= removedBytes;
+        }
+        image.width = texture.getWidth();
+        image.height = texture.getHeight();
+        return;
+    }
+
+    scratch::DownsampleMode mode = getDownsampleMode(role);
+    std::vector<uint8_t> pixels;
+    const unsigned char *source = image.pixels.get();
+    for (int mip = 0; mip < topMip; ++mip) {
+        pixels = scratch::ImageDownsampler::halve(source, image.width, image.height, image.channels, mode,
+                                                  image.width, image.height);
+        source = pixels.data();
+    }
+    auto *smaller = static_cast<unsigned char *>(std::malloc(pixels.size()));
+    if (smaller != nullptr) {
+        std::memcpy(smaller, pixels.data(), pixels.size());
+    }
+    // a null image fails the decode like an unreadable file
+    image.pixels = std::unique_ptr<unsigned char, void (*)(void *)>(smaller, std::free);
+}
+
+void scratch::TextureManager::generateMips(DecodedImage &image, TextureRole role) {
+    int levelCount = countLevels(image.width, image.height);
+    image.levels.clear();
+    size_t byteSize = 0;
+    for (int level = 0; level < levelCount; ++level) {
+        int width = std::max(1, image.width >> level);
+        int height = std::max(1, image.height >> level);
+        size_t levelBytes = static_cast<size_t>(width) * height * image.channels;
+        image.levels.push_back({width, height, byteSize, levelBytes});
+        byteSize += levelBytes;
+    }
+
+    // one allocation for the whole chain so it stages and uploads like a cooked file
+    auto *chain = static_cast<unsigned char *>(std::malloc(byteSize));
+    if (chain == nullptr) {
+        image.pixels.reset();
+        image.levels.clear();
+        return;
+    }
+    std::memcpy(chain, image.pixels.get(), image.levels[0].byteSize);
+    scratch::DownsampleMode mode = getDownsampleMode(role);
+    for (int level = 1; level < levelCount; ++level) {
+        const ImageLevel &larger = image.levels[level - 1];
+        int width, height;
+        std::vector<uint8_t> pixels = scratch::ImageDownsampler::halve(chain + larger.offset, larger.width,
+                                                                       larger.height, image.channels, mode,
+                                                                       width, height);
+        std::memcpy(chain + image.levels[level].offset, pixels.data(), image.levels[level].byteSize);
+    }
+    image.pixels = std::unique_ptr<unsigned char, void (*)(void *)>(chain, std::free);
+}
+
+bool scratch::TextureManager::loadCookedTexture(const std::string &path, DecodedImage &image) {
+    std::filesystem::path cookedPath = std::filesystem::path(path).replace_extension(".dds");
+    std::error_code error;
+    if (cookedPath == std::filesystem::path(path) || !std::filesystem::exists(cookedPath, error)) {
+        return false;
+    }
+    // a source image edited after cooking wins over the stale cooked file
+    auto sourceTime = std::filesystem::last_write_time(path, error);
+    if (!error && sourceTime > std::filesystem::last_write_time(cookedPath, error)) {
+        return false;
+    }
+
+    auto compressed = std::make_unique<scratch::CompressedTexture>();
+    if (!scratch::DdsFile::read(cookedPath.string(), *compressed) ||
+        !_supportedBlockFormats.at(compressed->format)) {
+        return false;
+    }
+    image.width = compressed->getWidth();
+    image.height = compressed->getHeight();
+    image.compressed = std::move(compressed);
+    return true;
+}
+
+void scratch::TextureManager::update() {
+    releaseRetiredTextures();
+    updateResidency();
+    {
+        std::lock_guard<std::mutex> lock(_decodedMutex);
+        for (auto &result : _decoded) {
+            _waitingForUpload.push_back(std::move(result));
+        }
+        _decoded.clear();
+    }
+    if (_waitingForUpload.empty()) {
+        return;
+    }
+
+    // The segment written this frame must be done with on the GPU, if it isn't try again next frame instead of waiting
+    GLsync &fence = _stagingFences[_stagingSegment];
+    if (fence != nullptr) {
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            return;
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    // decoded rows are tightly packed
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    size_t budgetUsed = 0;
+    size_t stagingUsed = 0;
+    size_t processed = 0;
+    for (; processed < _waitingForUpload.size(); ++processed) {
+        DecodeResult &result = _waitingForUpload[processed];
+        TextureEntry &entry = _entries[result.handle];
+        bool streamedIn = entry.state == READY;
+        if (!result.image.isValid()) {
+            std::cout << "Texture failed to load at path: " << entry.path << std::endl;
+            // a failed stream in keeps the mips already resident
+            entry.state = streamedIn ? READY : FAILED;
+            entry.streaming = false;
+            continue;
+        }
+        // mips may have been dropped for the budget while this was decoding
+        if (streamedIn && result.image.topMip >= entry.residentMip) {
+            entry.streaming = false;
+            continue;
+        }
+
+        size_t byteSize = result.image.getByteSize();
+        // always let one texture through so anything bigger than the budget still arrives, the rest wait
+        // still marked streaming so updateResidency doesn't decode them again
+        if (budgetUsed > 0 && budgetUsed + byteSize > _uploadBudget) {
+            break;
+        }
+        entry.streaming = false;
+
+        if (_stagingMemory != nullptr && stagingUsed + byteSize <= _stagingSegmentSize) {
+            size_t offset = _stagingSegment * _stagingSegmentSize + stagingUsed;
+            std::memcpy(_stagingMemory + offset, result.image.getData(), byteSize);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _stagingBuffer);
+            upload(entry, result.image, reinterpret_cast<const void *>(offset));
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            // keep every copy starting on a 16 byte boundary
+            stagingUsed += (byteSize + 15) & ~static_cast<size_t>(15);
+        } else {
+            // no persistent mapping or too big for a segment, upload straight from the decoded pixels
+            upload(entry, result.image, result.image.getData());
+        }
+        budgetUsed += byteSize;
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    if (stagingUsed > 0) {
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        _stagingSegment = (_stagingSegment + 1) % STAGING_SEGMENTS;
+    }
+    _waitingForUpload.erase(_waitingForUpload.begin(), _waitingForUpload.begin() + processed);
+}
+
+void scratch::TextureManager::upload(TextureEntry &entry, const DecodedImage &image, const void *pixelSource) {
+    // until coverage says otherwise a new texture wants what it loaded with
+    if (entry.glTexture == 0) {
+        entry.wantedMip = image.topMip;
+    }
+    // streaming in larger mips replaces the whole texture, queued frames may still sample the old one
+    retireGlTexture(entry);
+    glGenTextures(1, &entry.glTexture);
+    glBindTexture(GL_TEXTURE_2D, entry.glTexture);
+    entry.state = READY;
+    entry.fullWidth = image.fullWidth > 0 ? image.fullWidth : image.width;
+    entry.fullHeight = image.fullHeight > 0 ? image.fullHeight : image.height;
+    entry.residentMip = image.topMip;
+
+    if (image.compressed) {
+        // cooked files carry their own mip chain
+        const scratch::CompressedTexture &texture = *image.compressed;
+        GLenum format = getCompressedFormat(texture.format, texture.srgb);
+        auto levels = static_cast<GLsizei>(texture.mips.size());
+        const auto *source = static_cast<const unsigned char *>(pixelSource);
+        if (GLAD_GL_VERSION_4_2) {
+            glTexStorage2D(GL_TEXTURE_2D, levels, format, texture.getWidth(), texture.getHeight());
+        } else {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+        }
+        for (GLsizei level = 0; level < levels; ++level) {
+            const scratch::CompressedMip &mip = texture.mips[level];
+            auto byteSize = static_cast<GLsizei>(mip.byteSize);
+            if (GLAD_GL_VERSION_4_2) {
+                glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, mip.width, mip.height, format, byteSize,
+                                          source + mip.offset);
+            } else {
+                glCompressedTexImage2D(GL_TEXTURE_2D, level, format, mip.width, mip.height, 0, byteSize,
+                                       source + mip.offset);
+            }
+        }
+        entry.internalFormat = format;
+        entry.fullLevels = image.topMip + levels;
+        entry.fullBytes = texture.data.size() << (2 * image.topMip);
+        if (_bindingMode == TEXTURE_ARRAYS) {
+            storeInArrayPage(entry, format, entry.swizzle, levels, texture.getWidth(), texture.getHeight());
+        }
+        return;
+    }
+
+    StorageFormat format = chooseStorageFormat(entry.role, image.channels);
+    // the decode job made the mips, a single level image is all there is
+    auto levels = static_cast<GLsizei>(std::max<size_t>(image.levels.size(), 1));
+    entry.internalFormat = format.internalFormat;
+    std::copy(format.swizzle, format.swizzle + 4, entry.swizzle);
+    entry.fullLevels = image.topMip + levels;
+    // a full chain is a third bigger than its top level
+    entry.fullBytes = (static_cast<size_t>(image.width) * image.height * getBytesPerTexel(format.internalFormat) * 4 / 3)
+            << (2 * image.topMip);
+    allocateStorage(format.internalFormat, format.uploadFormat, levels, image.width, image.height);
+    const auto *source = static_cast<const unsigned char *>(pixelSource);
+    if (image.levels.empty()) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, image.width, image.height, format.uploadFormat, GL_UNSIGNED_BYTE,
+                        source);
+    }
+    for (GLsizei level = 0; level < static_cast<GLsizei>(image.levels.size()); ++level) {
+        const ImageLevel &mip = image.levels[level];
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, mip.width, mip.height, format.uploadFormat, GL_UNSIGNED_BYTE,
+                        source + mip.offset);
+    }
+    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, format.swizzle);
+    if (_bindingMode == TEXTURE_ARRAYS) {
+        storeInArrayPage(entry, format.internalFormat, format.swizzle, levels, image.width, image.height);
+    }
+}
+
+void scratch::TextureManager::storeInArrayPage(TextureEntry &entry, GLenum internalFormat, const GLint *swizzle,
+                                               GLsizei levels, GLsizei width, GLsizei height) {
+    int pageIndex = -1;
+    for (size_t i = 0; i < _arrayPages.size(); ++i) {
+        const ArrayPage &page = _arrayPages[i];
+        if (page.internalFormat == internalFormat && page.width == width && page.height == height &&
+            page.levels == levels && page.wrapMode == entry.wrapMode && page.usedLayers < ARRAY_PAGE_LAYERS &&
+            std::equal(swizzle, swizzle + 4, page.swizzle)) {
+            pageIndex = static_cast<int>(i);
+            break;
+        }
+    }
+    if (pageIndex < 0) {
+        if (_arrayPages.size() >= MAX_ARRAY_PAGES) {
+            // batched shaders can't reach it, meshes using it are drawn per material instead
+            if (!_arrayPagesFull) {
+                std::cout << "WARNING: all " << MAX_ARRAY_PAGES << " texture array pages are in use, " << entry.path
+                          << " and any texture after it that needs a new page are drawn per material" << std::endl;
+                _arrayPagesFull = true;
+            }
+            return;
+        }
+        ArrayPage page = {};
+        page.internalFormat = internalFormat;
+        std::copy(swizzle, swizzle + 4, page.swizzle);
+        page.wrapMode = entry.wrapMode;
+        page.width = width;
+        page.height = height;
+        page.levels = levels;
+        glGenTextures(1, &page.texture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, page.texture);
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, internalFormat, width, height, ARRAY_PAGE_LAYERS);
+        glTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_RGBA, page.swizzle);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        _arrayPages.push_back(page);
+        pageIndex = static_cast<int>(_arrayPages.size() - 1);
+    }
+
+    ArrayPage &page = _arrayPages[pageIndex];
+    for (GLsizei level = 0; level < levels; ++level) {
+        glCopyImageSubData(entry.glTexture, GL_TEXTURE_2D, level, 0, 0, 0,
+                           page.texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, page.usedLayers,
+                           std::max(1, width >> level), std::max(1, height >> level), 1);
+    }
+    entry.arrayPage = pageIndex;
+    entry.arrayLayer = page.usedLayers++;
+
+    // per material draws still bind a plain 2D texture, a view of the layer gives them one without keeping
+    // a second copy of the pixels around
+    GLuint view;
+    glGenTextures(1, &view);
+    glTextureView(view, GL_TEXTURE_2D, page.texture, internalFormat, 0, levels, entry.arrayLayer, 1);
+    glBindTexture(GL_TEXTURE_2D, view);
+    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, page.swizzle);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    releaseGlTexture(entry);
+    entry.glTexture = view;
+}
+
+scratch::TextureManager::StorageFormat scratch::TextureManager::chooseStorageFormat(TextureRole role, int channels) {
+    GLenum uploadFormats[] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+    StorageFormat format = {GL_RGBA8, uploadFormats[std::clamp(channels, 1, 4) - 1],
+                            {GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA}};
+    // grey and grey + alpha images are spread back over rgb when sampled
+    if (channels == 1) {
+        format.swizzle[1] = GL_RED;
+        format.swizzle[2] = GL_RED;
+        format.swizzle[3] = GL_ONE;
+    } else if (channels == 2) {
+        format.swizzle[1] = GL_RED;
+        format.swizzle[2] = GL_RED;
+        format.swizzle[3] = GL_GREEN;
+    }
+
+    switch (role) {
+        case DIFFUSE_TEXTURE:
+            // color data is authored in sRGB, decode it to linear when sampling
+            format.internalFormat = GL_SRGB8_ALPHA8;
+            break;
+        case NORMAL_TEXTURE:
+            // the shaders rebuild z from x and y
+            format.internalFormat = GL_RG8;
+            format.swizzle[1] = GL_GREEN;
+            format.swizzle[2] = GL_BLUE;
+            format.swizzle[3] = GL_ALPHA;
+            break;
+        case SPECULAR_TEXTURE:
+        case HEIGHT_TEXTURE:
+            format.internalFormat = channels == 1 ? GL_R8 : channels == 2 ? GL_RG8 : GL_RGBA8;
+            break;
+    }
+    return format;
+}
+
+void scratch::TextureManager::allocateStorage(GLenum internalFormat, GLenum uploadFormat, GLsizei levels,
+                                              GLsizei width, GLsizei height) {
+    if (GLAD_GL_VERSION_4_2) {
+        glTexStorage2D(GL_TEXTURE_2D, levels, internalFormat, width, height);
+        return;
+    }
+    for (GLsizei level = 0; level < levels; ++level) {
+        glTexImage2D(GL_TEXTURE_2D, level, static_cast<GLint>(internalFormat), width, height, 0, uploadFormat,
+                     GL_UNSIGNED_BYTE, nullptr);
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+}
+
+GLuint scratch::TextureManager::getOrCreateSampler(GLint wrapMode) {
+    auto existing = _samplers.find(wrapMode);
+    if (existing != _samplers.end()) {
+        return existing->second;
+    }
+    GLuint sampler;
+    glGenSamplers(1, &sampler);
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, wrapMode);
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, wrapMode);
+    glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    _samplers[wrapMode] = sampler;
+    return sampler;
+}
+
+GLenum scratch::TextureManager::getCompressedFormat(BlockFormat format, bool srgb) {
+    switch (format) {
+        case BC1:
+            return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case BC3:
+            return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case BC5:
+            return GL_COMPRESSED_RG_RGTC2;
+        case BC7:
+            return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+    }
+    return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+}
+
+scratch::TextureManager::TextureEntry &scratch::TextureManager::resolve(unsigned int handle) {
+    TextureEntry &entry = _entries[handle];
+    if (entry.state == READY) {
+        return entry;
+    }
+    return _entries[_placeholders[entry.role]];
+}
+
+unsigned int scratch::TextureManager::getGlTexture(unsigned int handle) {
+    return resolve(handle).glTexture;
+}
+
+void scratch::TextureManager::updateResidency() {
+    _frame++;
+    if (_bindingMode == TEXTURE_ARRAYS) {
+        return;
+    }
+
+    // what every texture would like from last frame's coverage, the smallest level still covering it
+    size_t wantedBytes = 0;
+    for (auto &entry : _entries) {
+        if (entry.state != READY) {
+            continue;
+        }
+        if (entry.requestedPixels > 0.0f) {
+            entry.coveragePixels = entry.requestedPixels;
+            entry.lastRequestedFrame = _frame;
+            float texels = static_cast<float>(std::max(entry.fullWidth, entry.fullHeight));
+            int mip = 0;
+            while (mip + 1 < entry.fullLevels && texels / static_cast<float>(1 << (mip + 1)) >= entry.coveragePixels) {
+                mip++;
+            }
+            entry.wantedMip = mip;
+        } else if (_frame - entry.lastRequestedFrame > UNUSED_FRAMES) {
+            entry.coveragePixels = 0.0f;
+            entry.wantedMip = std::max(entry.wantedMip,
+                                       getInitialMip(entry.fullWidth, entry.fullHeight, entry.fullLevels));
+        }
+        entry.requestedPixels = 0.0f;
+        wantedBytes += getBytesAtMip(entry, entry.wantedMip);
+    }
+
+    // over budget, keep dropping a mip from whichever texture has the most texels per covered pixel
+    while (wantedBytes > _memoryBudget) {
+        TextureEntry *mostOversampled = nullptr;
+        float highestRatio = 0.0f;
+        for (auto &entry : _entries) {
+            if (entry.state != READY || entry.wantedMip + 1 >= entry.fullLevels) {
+                continue;
+            }
+            float texels = static_cast<float>(std::max(entry.fullWidth, entry.fullHeight) >> entry.wantedMip);
+            float ratio = texels / std::max(entry.coveragePixels, 1.0f);
+            if (mostOversampled == nullptr || ratio > highestRatio) {
+                mostOversampled = &entry;
+                highestRatio = ratio;
+            }
+        }
+        if (mostOversampled == nullptr) {
+            break;
+        }
+        wantedBytes -= getBytesAtMip(*mostOversampled, mostOversampled->wantedMip);
+        mostOversampled->wantedMip++;
+        wantedBytes += getBytesAtMip(*mostOversampled, mostOversampled->wantedMip);
+    }
+
+    for (size_t handle = 0; handle < _entries.size(); ++handle) {
+        TextureEntry &entry = _entries[handle];
+        if (entry.state != READY) {
+            continue;
+        }
+        if (entry.wantedMip > entry.residentMip && GLAD_GL_VERSION_4_3) {
+            shrink(entry, entry.wantedMip);
+        } else if (entry.wantedMip < entry.residentMip && !entry.streaming) {
+            entry.streaming = true;
+            queueDecode(static_cast<unsigned int>(handle), entry.path, entry.role, entry.wantedMip);
+        }
+    }
+}
+
+void scratch::TextureManager::shrink(TextureEntry &entry, int mip) {
+    int width = std::max(1, entry.fullWidth >> mip);
+    int height = std::max(1, entry.fullHeight >> mip);
+    GLsizei levels = entry.fullLevels - mip;
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexStorage2D(GL_TEXTURE_2D, levels, entry.internalFormat, width, height);
+    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, entry.swizzle);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    int skippedLevels = mip - entry.residentMip;
+    for (GLsizei level = 0; level < levels; ++level) {
+        glCopyImageSubData(entry.glTexture, GL_TEXTURE_2D, level + skippedLevels, 0, 0, 0,
+                           texture, GL_TEXTURE_2D, level, 0, 0, 0,
+                           std::max(1, width >> level), std::max(1, height >> level), 1);
+    }
+    retireGlTexture(entry);
+    entry.glTexture = texture;
+    entry.residentMip = mip;
+}
+
+void scratch::TextureManager::releaseGlTexture(TextureEntry &entry) {
+    if (entry.bindlessHandle != 0) {
+        makeTextureHandleNonResident(entry.bindlessHandle);
+        entry.bindlessHandle = 0;
+    }
+    if (entry.glTexture != 0) {
+        glDeleteTextures(1, &entry.glTexture);
+        entry.glTexture = 0;
+    }
+}
+
+void scratch::TextureManager::retireGlTexture(TextureEntry &entry) {
+    if (entry.glTexture != 0) {
+        _retiredTextures.push_back({entry.glTexture, entry.bindlessHandle, FrameRingBuffer::getFrame()});
+    }
+    entry.glTexture = 0;
+    entry.bindlessHandle = 0;
+}
+
+void scratch::TextureManager::releaseRetiredTextures() {
+    auto firstInUse = std::partition(_retiredTextures.begin(), _retiredTextures.end(),
+                                     [](const RetiredTexture &retired) {
+                                         return FrameRingBuffer::isFrameComplete(retired.frame);
+                                     });
+    for (auto it = _retiredTextures.begin(); it != firstInUse; ++it) {
+        releaseRetiredTexture(*it);
+    }
+    _retiredTextures.erase(_retiredTextures.begin(), firstInUse);
+}
+
+void scratch::TextureManager::releaseRetiredTexture(RetiredTexture &retired) {
+    if (retired.bindlessHandle != 0) {
+        makeTextureHandleNonResident(retired.bindlessHandle);
+    }
+    glDeleteTextures(1, &retired.texture);
+}
+
+size_t scratch::TextureManager::getBytesAtMip(const TextureEntry &entry, int mip) {
+    return entry.fullBytes >> (2 * mip);
+}
+
+void scratch::TextureManager::requestScreenCoverage(unsigned int handle, float screenFraction) {
+    TextureEntry &entry = _entries[handle];
+    entry.requestedPixels = std::max(entry.requestedPixels, screenFraction * static_cast<float>(_viewportHeight));
+}
+
+void scratch::TextureManager::setViewportHeight(int height) {
+    _viewportHeight = height;
+}
+
+void scratch::TextureManager::setMemoryBudget(size_t bytes) {
+    _memoryBudget = bytes;
+}
+
+size_t scratch::TextureManager::getResidentBytes() {
+    size_t residentBytes = 0;
+    for (const auto &entry : _entries) {
+        if (entry.state == READY) {
+            residentBytes += getBytesAtMip(entry, entry.residentMip);
+        }
+    }
+    return residentBytes;
+}
+
+std::vector<scratch::TextureStreamingStats> scratch::TextureManager::getStreamingStats() {
+    std::vector<TextureStreamingStats> stats;
+    for (const auto &entry : _entries) {
+        if (entry.state != READY || entry.path == "placeholder") {
+            continue;
+        }
+        stats.push_back({entry.path, entry.fullWidth, entry.fullHeight, entry.fullLevels, entry.residentMip,
+                         entry.wantedMip, getBytesAtMip(entry, entry.residentMip), entry.streaming});
+    }
+    return stats;
+}
+
+unsigned int scratch::TextureManager::getPlaceholder(TextureRole role) {
+    return _placeholders.at(role);
+}
+
+scratch::TextureBindingMode scratch::TextureManager::getBindingMode() {
+    return _bindingMode;
+}
+
+glm::uvec2 scratch::TextureManager::getShaderReference(unsigned int handle) {
+    TextureEntry &entry = resolve(handle);
+    if (_bindingMode == BINDLESS_TEXTURES) {
+        if (entry.bindlessHandle == 0) {
+            entry.bindlessHandle = getTextureSamplerHandle(entry.glTexture, getOrCreateSampler(entry.wrapMode));
+            makeTextureHandleResident(entry.bindlessHandle);
+        }
+        return glm::uvec2(static_cast<uint32_t>(entry.bindlessHandle & 0xFFFFFFFF),
+                          static_cast<uint32_t>(entry.bindlessHandle >> 32));
+    }
+    if (entry.arrayPage < 0) {
+        const TextureEntry &placeholder = _entries[_placeholders[entry.role]];
+        return glm::uvec2(placeholder.arrayPage, placeholder.arrayLayer);
+    }
+    return glm::uvec2(entry.arrayPage, entry.arrayLayer);
+}
+
+bool scratch::TextureManager::isBatchable(unsigned int handle) {
+    const TextureEntry &entry = _entries[handle];
+    return _bindingMode != TEXTURE_ARRAYS || entry.state != READY || entry.arrayPage >= 0;
+}
+
+unsigned int scratch::TextureManager::bindArrayPages(unsigned int firstUnit) {
+    for (size_t i = 0; i < _arrayPages.size(); ++i) {
+        auto unit = static_cast<GLuint>(firstUnit + i);
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, _arrayPages[i].texture);
+        glBindSampler(unit, getOrCreateSampler(_arrayPages[i].wrapMode));
+    }
+    return static_cast<unsigned int>(_arrayPages.size());
+}
+
+void scratch::TextureManager::unbindSamplers(unsigned int firstUnit, unsigned int count) {
+    for (unsigned int unit = firstUnit; unit < firstUnit + count; ++unit) {
+        glBindSampler(unit, 0);
+    }
+}
+
+bool scratch::TextureManager::loadBindlessFunctions() {
+    if (!glfwExtensionSupported("GL_ARB_bindless_texture")) {
+        return false;
+    }
+    getTextureSamplerHandle = reinterpret_cast<GetTextureSamplerHandleFunction>(
+            glfwGetProcAddress("glGetTextureSamplerHandleARB"));
+    makeTextureHandleResident = reinterpret_cast<TextureHandleFunction>(
+            glfwGetProcAddress("glMakeTextureHandleResidentARB"));
+    makeTextureHandleNonResident = reinterpret_cast<TextureHandleFunction>(
+            glfwGetProcAddress("glMakeTextureHandleNonResidentARB"));
+    return getTextureSamplerHandle != nullptr && makeTextureHandleResident != nullptr &&
+           makeTextureHandleNonResident != nullptr;
+}
+
+unsigned int scratch::TextureManager::getSampler(unsigned int handle) {
+    return _samplers[_entries[handle].wrapMode];
+}
+
+bool scratch::TextureManager::isReady(unsigned int handle) {
+    return _entries[handle].state == READY;
+}
+
+size_t scratch::TextureManager::getPendingCount() {
+    size_t pending = 0;
+    for (const auto &entry : _entries) {
+        if (entry.state != READY && entry.state != FAILED) {
+            pending++;
+        }
+    }
+    return pending;
+}
+
+void scratch::TextureManager::setUploadBudget(size_t bytesPerFrame) {
+    _uploadBudget = bytesPerFrame;
+    // staging segments are sized to the budget
+    if (_stagingBuffer != 0) {
+        destroyStagingBuffer();
+        createStagingBuffer();
+    }
+}
+
+scratch::TextureRole scratch::TextureManager::roleFromTypeName(const std::string &typeName) {
+    if (typeName == "texture_specular")
+        return SPECULAR_TEXTURE;
+    if (typeName == "texture_normal")
+        return NORMAL_TEXTURE;
+    if (typeName == "texture_height")
+        return HEIGHT_TEXTURE;
+    return DIFFUSE_TEXTURE;
+}
+
+void scratch::TextureManager::createPlaceholders() {
+    // Neutral values so a half loaded material still shades sensibly
+    const std::map<TextureRole, uint32_t> placeholderColors{
+            {DIFFUSE_TEXTURE,  0xFFFFFFFF},
+            {SPECULAR_TEXTURE, 0xFF000000},
+            {NORMAL_TEXTURE,   0xFFFF8080},
+            {HEIGHT_TEXTURE,   0xFF000000}};
+    for (const auto &[role, color] : placeholderColors) {
+        DecodedImage image;
+        image.width = 1;
+        image.height = 1;
+        image.channels = 4;
+        unsigned char pixel[4] = {static_cast<unsigned char>(color & 0xFF),
+                                  static_cast<unsigned char>((color >> 8) & 0xFF),
+                                  static_cast<unsigned char>((color >> 16) & 0xFF),
+                                  static_cast<unsigned char>((color >> 24) & 0xFF)};
+
+        // placeholders are regular entries, just never in the lookup by path
+        TextureEntry entry;
+        entry.path = "placeholder";
+        entry.role = role;
+        entry.wrapMode = GL_REPEAT;
+        getOrCreateSampler(entry.wrapMode);
+        upload(entry, image, pixel);
+        _placeholders[role] = static_cast<unsigned int>(_entries.size());
+        _entries.push_back(entry);
+    }
+}
+
+void scratch::TextureManager::createStagingBuffer() {
+    // Persistent mapping needs GL 4.4, without it uploads come from client memory
+    if (!GLAD_GL_VERSION_4_4) {
+        std::cout << "Persistent buffer mapping unavailable, uploading textures from client memory" << std::endl;
+        return;
+    }
+    _stagingSegmentSize = _uploadBudget;
+    auto totalSize = static_cast<GLsizeiptr>(_stagingSegmentSize * STAGING_SEGMENTS);
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glGenBuffers(1, &_stagingBuffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _stagingBuffer);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, totalSize, nullptr, flags);
+    _stagingMemory = static_cast<unsigned char *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, totalSize, flags));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    _stagingSegment = 0;
+}
+
+void scratch::TextureManager::destroyStagingBuffer() {
+    for (auto &fence : _stagingFences) {
+        if (fence != nullptr) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    if (_stagingBuffer != 0) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _stagingBuffer);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glDeleteBuffers(1, &_stagingBuffer);
+        _stagingBuffer = 0;
+    }
+    _stagingMemory = nullptr;
+    _stagingSegmentSize = 0;
+}
@@ -0,0 +1,331 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "threading/job_system.h"
+#include "dds_file.h"
+
+namespace scratch {
+    // What a texture is sampled as, decides its placeholder while loading
+    enum TextureRole {
+        DIFFUSE_TEXTURE,
+        SPECULAR_TEXTURE,
+        NORMAL_TEXTURE,
+        HEIGHT_TEXTURE
+    };
+
+    // How batched shaders reach their textures
+    enum TextureBindingMode {
+        // every material binds its own textures to units, no batching
+        BIND_PER_MATERIAL,
+        // textures of the same size and format share a GL_TEXTURE_2D_ARRAY, shaders get a page and layer
+        TEXTURE_ARRAYS,
+        // ARB_bindless_texture handles stored straight in the material buffer, needs NV_gpu_shader5 as well
+        BINDLESS_TEXTURES
+    };
+    const std::map<TextureBindingMode, std::string> BINDING_MODE_TO_STRING{
+            {BIND_PER_MATERIAL, "BIND_PER_MATERIAL"},
+            {TEXTURE_ARRAYS,    "TEXTURE_ARRAYS"},
+            {BINDLESS_TEXTURES, "BINDLESS_TEXTURES"}};
+    const std::map<std::string, TextureBindingMode> STRING_TO_BINDING_MODE{
+            {"BIND_PER_MATERIAL", BIND_PER_MATERIAL},
+            {"TEXTURE_ARRAYS",    TEXTURE_ARRAYS},
+            {"BINDLESS_TEXTURES", BINDLESS_TEXTURES}};
+
+    // Streaming state of one texture, mips count from the full size level 0
+    struct TextureStreamingStats {
+        std::string path;
+        int width;
+        int height;
+        int levels;
+        // largest level currently on the GPU
+        int residentMip;
+        // largest level the last frames' screen coverage and the memory budget asked for
+        int requestedMip;
+        size_t residentBytes;
+        bool streaming;
+    };
+
+    // Loads textures in the background. Files are decoded and their mips filtered on the job system, then
+    // uploaded on the main thread through a persistently mapped pixel unpack buffer, never more than the upload
+    // budget per frame.
+    // Until a texture is uploaded, a 1x1 placeholder for its role is bound in its place.
+    // A cooked .dds next to the source image (see tools/texture_cooker) is used instead when it's up to date.
+    // Textures start out with only their small mips resident. Larger mips are streamed in as draws report the
+    // screen coverage of meshes using them, and dropped again for unused textures or to stay in the memory budget.
+    class TextureManager {
+    public:
+        static const unsigned int MAX_ARRAY_PAGES = 16;
+
+        // Needs a current GL context. Falls back from the preferred binding mode to whatever the driver supports.
+        static void initialize(TextureBindingMode preferredBindingMode = BINDLESS_TEXTURES);
+
+        static void shutdown();
+
+        // Returns a handle straight away, the texture itself arrives over the next frames.
+        // Requesting the same file for the same role again returns the same handle.
+        static unsigned int requestTexture(const std::string &path, TextureRole role, GLint wrapMode = GL_REPEAT);
+
+        // Uploads decoded textures that fit in this frame's budget, call once per frame on the main thread
+        static void update();
+
+        // GL texture name to bind for a handle, the role's placeholder while it is still loading
+        static unsigned int getGlTexture(unsigned int handle);
+
+        // Shared sampler object holding the handle's filtering and wrapping
+        static unsigned int getSampler(unsigned int handle);
+
+        static bool isReady(unsigned int handle);
+
+        // Handle of the neutral texture shown for role while nothing better is loaded
+        static unsigned int getPlaceholder(TextureRole role);
+
+        static TextureBindingMode getBindingMode();
+
+        // What a batched shader needs to sample the handle: the two halves of a bindless handle,
+        // or an array page and layer. Draws of one multi-draw can share a shader invocation group, so the
+        // reference isn't dynamically uniform. Bindless mode is only chosen with GL_NV_gpu_shader5, which allows
+        // that, and lit-batched.frag only ever indexes the array pages with constants.
+        static glm::uvec2 getShaderReference(unsigned int handle);
+
+        // Whether batched shaders can reach the handle, not when it's loaded but every array page was taken
+        static bool isBatchable(unsigned int handle);
+
+        // Binds every array page to consecutive units from firstUnit on, returns how many were bound
+        static unsigned int bindArrayPages(unsigned int firstUnit);
+
+        // Clears the sampler objects bound to count units from firstUnit on, so those units go back to
+        // their textures' own filtering and wrapping
+        static void unbindSamplers(unsigned int firstUnit, unsigned int count);
+
+        static size_t getPendingCount();
+
+        // Report that something covering screenFraction of the viewport height is drawn with the texture
+        static void requestScreenCoverage(unsigned int handle, float screenFraction);
+
+        // Turns screen coverage into pixels, call when the viewport changes
+        static void setViewportHeight(int height);
+
+        // GPU memory streamed textures may use, the least needed mips are dropped to stay under it
+        static void setMemoryBudget(size_t bytes);
+
+        static size_t getResidentBytes();
+
+        static std::vector<TextureStreamingStats> getStreamingStats();
+
+        static void setUploadBudget(size_t bytesPerFrame);
+
+        static TextureRole roleFromTypeName(const std::string &typeName);
+
+    private:
+        enum LoadState {
+            DECODING,
+            WAITING_FOR_UPLOAD,
+            READY,
+            FAILED
+        };
+
+        // Where one level of a decoded image's chain is inside its pixels
+        struct ImageLevel {
+            int width;
+            int height;
+            size_t offset;
+            size_t byteSize;
+        };
+
+        struct DecodedImage {
+            int width = 0;
+            int height = 0;
+            int channels = 0;
+            std::unique_ptr<unsigned char, void (*)(void *)> pixels{nullptr, nullptr};
+            // every level of pixels, largest first, made on the decode job. Empty for a single level image.
+            std::vector<ImageLevel> levels;
+            // set instead of pixels when loaded from a cooked file
+            std::unique_ptr<scratch::CompressedTexture> compressed;
+            // full size level the decoded one is a mip of
+            int topMip = 0;
+            int fullWidth = 0;
+            int fullHeight = 0;
+
+            bool isValid() const;
+
+            const unsigned char *getData() const;
+
+            size_t getByteSize() const;
+        };
+
+        struct TextureEntry {
+            std::string path;
+            TextureRole role;
+            GLint wrapMode;
+            GLuint glTexture = 0;
+            LoadState state = DECODING;
+            // copy inside an array page in TEXTURE_ARRAYS mode
+            int arrayPage = -1;
+            int arrayLayer = -1;
+            // resident handle in BINDLESS_TEXTURES mode, made on first use
+            GLuint64 bindlessHandle = 0;
+
+            // streaming, glTexture only holds the levels from residentMip down
+            GLenum internalFormat = 0;
+            GLint swizzle[4] = {GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA};
+            int fullWidth = 0;
+            int fullHeight = 0;
+            int fullLevels = 0;
+            // estimated size of the whole chain, each mip dropped quarters it
+            size_t fullBytes = 0;
+            int residentMip = 0;
+            int wantedMip = 0;
+            // largest coverage in pixels requested this frame, and the one used for the last decision
+            float requestedPixels = 0.0f;
+            float coveragePixels = 0.0f;
+            unsigned int lastRequestedFrame = 0;
+            // a decode for larger mips is in flight
+            bool streaming = false;
+        };
+
+        // Layers of one size, format and wrap mode, filled in upload order
+        struct ArrayPage {
+            GLuint texture;
+            GLenum internalFormat;
+            GLint swizzle[4];
+            GLint wrapMode;
+            GLsizei width;
+            GLsizei height;
+            GLsizei levels;
+            GLsizei usedLayers;
+        };
+
+        // Sized format the texture is stored in, the layout of the source pixels and how to read them back
+        struct StorageFormat {
+            GLenum internalFormat;
+            GLenum uploadFormat;
+            GLint swizzle[4];
+        };
+
+        struct DecodeResult {
+            unsigned int handle;
+            DecodedImage image;
+        };
+
+        // A texture replaced while frames that sample it may still be queued
+        struct RetiredTexture {
+            GLuint texture;
+            GLuint64 bindlessHandle;
+            // FrameRingBuffer frame it was last usable in
+            uint64_t frame;
+        };
+
+        // Number of frames the staging ring can have in flight
+        static const size_t STAGING_SEGMENTS = 3;
+
+        // decodes in flight on the job system, shutdown waits for them
+        inline static scratch::JobCounter _decodeJobs;
+        // set by shutdown so queued decodes return without doing anything
+        inline static std::atomic<bool> _cancelDecodes{false};
+        inline static std::vector<TextureEntry> _entries;
+        inline static std::map<std::string, unsigned int> _handlesByKey;
+        // handles of the always ready 1x1 textures standing in for each role
+        inline static std::map<TextureRole, unsigned int> _placeholders;
+        inline static TextureBindingMode _bindingMode = BIND_PER_MATERIAL;
+        inline static std::vector<ArrayPage> _arrayPages;
+        // warned once that textures no longer fit in the pages
+        inline static bool _arrayPagesFull = false;
+        // one per wrap mode, every texture uses the same filtering
+        inline static std::map<GLint, GLuint> _samplers;
+        // filled in by initialize, read by the decode workers afterwards
+        inline static std::map<BlockFormat, bool> _supportedBlockFormats;
+
+        // filled by the decode workers, drained by update
+        inline static std::mutex _decodedMutex;
+        inline static std::vector<DecodeResult> _decoded;
+        inline static std::vector<DecodeResult> _waitingForUpload;
+        // freed by update once the GPU has finished their frame
+        inline static std::vector<RetiredTexture> _retiredTextures;
+
+        inline static size_t _uploadBudget = 16 * 1024 * 1024;
+        inline static GLuint _stagingBuffer = 0;
+        inline static unsigned char *_stagingMemory = nullptr;
+        inline static size_t _stagingSegmentSize = 0;
+        inline static size_t _stagingSegment = 0;
+        inline static GLsync _stagingFences[STAGING_SEGMENTS] = {};
+
+        inline static size_t _memoryBudget = 512 * 1024 * 1024;
+        inline static int _viewportHeight = 1080;
+        inline static unsigned int _frame = 0;
+
+        static void createPlaceholders();
+
+        static void createStagingBuffer();
+
+        static void destroyStagingBuffer();
+
+        // topMip is the largest level to keep, negative to start at the initial streaming size
+        static void decode(unsigned int handle, const std::string &path, TextureRole role, int topMip);
+
+        static void dropLargerMips(DecodedImage &image, TextureRole role, int topMip);
+
+        // Box filters the uncompressed image's whole mip chain so upload only copies levels
+        static void generateMips(DecodedImage &image, TextureRole role);
+
+        // Queues decode as a WORKER_THREAD job, so no waiting thread ends up running it
+        static void queueDecode(unsigned int handle, const std::string &path, TextureRole role, int topMip);
+
+        // Picks every texture's wanted mip from coverage and budget, then streams in or drops mips to match
+        static void updateResidency();
+
+        // Moves the texture to storage without the levels above mip, copying the rest on the GPU. The old
+        // storage is retired rather than freed.
+        static void shrink(TextureEntry &entry, int mip);
+
+        static void releaseGlTexture(TextureEntry &entry);
+
+        // Hands the entry's texture and handle to the retired list, a bindless handle made non resident while
+        // queued draws still read it is undefined, unlike a deleted texture GL keeps alive
+        static void retireGlTexture(TextureEntry &entry);
+
+        // Frees the retired textures whose frame FrameRingBuffer reports complete
+        static void releaseRetiredTextures();
+
+        static void releaseRetiredTexture(RetiredTexture &retired);
+
+        static size_t getBytesAtMip(const TextureEntry &entry, int mip);
+
+        static bool loadCookedTexture(const std::string &path, DecodedImage &image);
+
+        static GLenum getCompressedFormat(BlockFormat format, bool srgb);
+
+        static StorageFormat chooseStorageFormat(TextureRole role, int channels);
+
+        // Immutable storage when available, otherwise the same sized format level by level
+        static void allocateStorage(GLenum internalFormat, GLenum uploadFormat, GLsizei levels,
+                                    GLsizei width, GLsizei height);
+
+        static GLuint getOrCreateSampler(GLint wrapMode);
+
+        // The entry itself once ready, otherwise the placeholder for its role
+        static TextureEntry &resolve(unsigned int handle);
+
+        static void storeInArrayPage(TextureEntry &entry, GLenum internalFormat, const GLint *swizzle, GLsizei levels,
+                                     GLsizei width, GLsizei height);
+
+        // ARB_bindless_texture entry points, looked up by hand since the loader may not generate them
+        static bool loadBindlessFunctions();
+
+        // Creates the GL texture from either client memory or an offset into the bound unpack buffer
+        static void upload(TextureEntry &entry, const DecodedImage &image, const void *pixelSource);
+    };
+}
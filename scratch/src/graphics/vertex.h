@@ -0,0 +1,29 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+namespace scratch {
+    struct Vertex {
+        // position
+        glm::vec3 position;
+        // texCoords
+        glm::vec2 texCoords;
+        // normal
+        glm::vec3 normal;
+        // tangent
+        glm::vec3 tangent;
+        // bitangent
+        glm::vec3 bitangent;
+    };
+
+    // Up to four skeleton joints a vertex follows, weights are normalized bytes summing to 255. Kept apart from
+    // Vertex so only skinned meshes pay for them, see GeometryPool.
+    struct SkinningVertex {
+        uint16_t boneIndices[4] = {};
+        uint8_t boneWeights[4] = {};
+    };
+}
@@ -7,6 +7,12 @@
 #include <imgui.h>
 
 #include "main_menu_bar.h"
+#include "graphics/dynamic_resolution.h"
+#include "graphics/occlusion_culler.h"
+#include "graphics/post_process_chain.h"
+#include "graphics/render_system.h"
+#include "graphics/shadow_maps.h"
+#include "graphics/texture_manager.h"
 
 bool has_suffix(const std::string &str, const std::string &suffix) {
     return str.size() >= suffix.size() &&
@@ -42,11 +48,183 @@ void scratch::MainMenuBar::render() {
     if (demoWindowOpen) {
         ImGui::ShowDemoWindow(&demoWindowOpen);
     }
+    if (ImGui::MenuItem("Texture Streaming")) {
+        textureStreamingWindowOpen = true;
+    }
+    if (textureStreamingWindowOpen) {
+        renderTextureStreamingWindow();
+    }
+    if (ImGui::MenuItem("Shadows")) {
+        shadowSettingsWindowOpen = true;
+    }
+    if (shadowSettingsWindowOpen) {
+        renderShadowSettingsWindow();
+    }
+    if (ImGui::MenuItem("Depth Pre-pass")) {
+        depthPrepassWindowOpen = true;
+    }
+    if (depthPrepassWindowOpen) {
+        renderDepthPrepassWindow();
+    }
+    if (ImGui::MenuItem("Post Processing")) {
+        postProcessingWindowOpen = true;
+    }
+    if (postProcessingWindowOpen) {
+        renderPostProcessingWindow();
+    }
+    if (ImGui::MenuItem("Occlusion Culling")) {
+        occlusionCullingWindowOpen = true;
+    }
+    if (occlusionCullingWindowOpen) {
+        renderOcclusionCullingWindow();
+    }
     ImGui::Spacing();
     ImGui::Text("%.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
     ImGui::EndMainMenuBar();
 }
 
+void scratch::MainMenuBar::renderTextureStreamingWindow() {
+    if (!ImGui::Begin("Texture Streaming", &textureStreamingWindowOpen)) {
+        ImGui::End();
+        return;
+    }
+    ImGui::Text("Resident: %.1f MB", scratch::TextureManager::getResidentBytes() / (1024.0 * 1024.0));
+    ImGui::Text("Loading: %zu", scratch::TextureManager::getPendingCount());
+    ImGui::Separator();
+    ImGui::Columns(5, "textures");
+    ImGui::Text("Path");
+    ImGui::NextColumn();
+    ImGui::Text("Size");
+    ImGui::NextColumn();
+    ImGui::Text("Resident Mip");
+    ImGui::NextColumn();
+    ImGui::Text("Requested Mip");
+    ImGui::NextColumn();
+    ImGui::Text("KB");
+    ImGui::NextColumn();
+    ImGui::Separator();
+    for (const auto &stats : scratch::TextureManager::getStreamingStats()) {
+        ImGui::TextUnformatted(stats.path.c_str());
+        ImGui::NextColumn();
+        ImGui::Text("%dx%d", stats.width, stats.height);
+        ImGui::NextColumn();
+        ImGui::Text(stats.streaming ? "%d (streaming)" : "%d", stats.residentMip);
+        ImGui::NextColumn();
+        ImGui::Text("%d", stats.requestedMip);
+        ImGui::NextColumn();
+        ImGui::Text("%zu", stats.residentBytes / 1024);
+        ImGui::NextColumn();
+    }
+    ImGui::Columns(1);
+    ImGui::End();
+}
+
+void scratch::MainMenuBar::renderShadowSettingsWindow() {
+    if (!ImGui::Begin("Shadows", &shadowSettingsWindowOpen)) {
+        ImGui::End();
+        return;
+    }
+    int cascadeCount = static_cast<int>(scratch::ShadowMaps::getCascadeCount());
+    if (ImGui::SliderInt("Cascades", &cascadeCount, 0, scratch::ShadowMaps::MAX_CASCADES)) {
+        scratch::ShadowMaps::setCascadeCount(static_cast<unsigned int>(cascadeCount));
+    }
+    const char *resolutions[] = {"512", "1024", "2048", "4096"};
+    int resolutionIndex = 0;
+    while ((512 << resolutionIndex) < scratch::ShadowMaps::getResolution() && resolutionIndex < 3) {
+        ++resolutionIndex;
+    }
+    if (ImGui::Combo("Resolution", &resolutionIndex, resolutions, 4)) {
+        scratch::ShadowMaps::setResolution(512 << resolutionIndex);
+    }
+    float shadowDistance = scratch::ShadowMaps::getShadowDistance();
+    if (ImGui::SliderFloat("Distance", &shadowDistance, 5.0f, 200.0f)) {
+        scratch::ShadowMaps::setShadowDistance(shadowDistance);
+    }
+    float splitLambda = scratch::ShadowMaps::getSplitLambda();
+    if (ImGui::SliderFloat("Split Lambda", &splitLambda, 0.0f, 1.0f)) {
+        scratch::ShadowMaps::setSplitLambda(splitLambda);
+    }
+    ImGui::End();
+}
+
+void scratch::MainMenuBar::renderDepthPrepassWindow() {
+    if (!ImGui::Begin("Depth Pre-pass", &depthPrepassWindowOpen)) {
+        ImGui::End();
+        return;
+    }
+    bool enabled = RenderSystem::isDepthPrepassEnabled();
+    if (ImGui::Checkbox("Enabled", &enabled)) {
+        RenderSystem::setDepthPrepassEnabled(enabled);
+    }
+    const RenderSystem::DepthPrepassStats &stats = RenderSystem::getDepthPrepassStats();
+    ImGui::Text("Shaded fragments: %llu", static_cast<unsigned long long>(stats.shadedSamples));
+    if (enabled && stats.prepassSamples > 0) {
+        // the pre-pass draws front to back with GL_LESS, roughly what shading would have run without it
+        uint64_t saved = stats.prepassSamples > stats.shadedSamples ? stats.prepassSamples - stats.shadedSamples : 0;
+        ImGui::Text("Without pre-pass: %llu", static_cast<unsigned long long>(stats.prepassSamples));
+        ImGui::Text("Saved: %llu (%.1f%%)", static_cast<unsigned long long>(saved),
+                    100.0 * static_cast<double>(saved) / static_cast<double>(stats.prepassSamples));
+    }
+    ImGui::End();
+}
+
+void scratch::MainMenuBar::renderPostProcessingWindow() {
+    if (!ImGui::Begin("Post Processing", &postProcessingWindowOpen)) {
+        ImGui::End();
+        return;
+    }
+    bool dynamicResolution = scratch::DynamicResolution::isEnabled();
+    if (ImGui::Checkbox("Dynamic Resolution", &dynamicResolution)) {
+        scratch::DynamicResolution::setEnabled(dynamicResolution);
+    }
+    if (dynamicResolution) {
+        float targetFrameTime = scratch::DynamicResolution::getTargetFrameTime();
+        if (ImGui::SliderFloat("Target ms", &targetFrameTime, 4.0f, 33.3f)) {
+            scratch::DynamicResolution::setTargetFrameTime(targetFrameTime);
+        }
+        ImGui::Text("Scale: %.2f", scratch::DynamicResolution::getRenderScale());
+    } else {
+        float renderScale = RenderSystem::getRenderScale();
+        if (ImGui::SliderFloat("Render Scale", &renderScale, RenderSystem::MIN_RENDER_SCALE, 1.0f)) {
+            RenderSystem::setRenderScale(renderScale);
+        }
+    }
+    ImGui::Text("GPU: %.2f ms", scratch::DynamicResolution::getGpuFrameTime());
+    float exposure = scratch::PostProcessChain::getExposure();
+    if (ImGui::SliderFloat("Exposure", &exposure, 0.1f, 8.0f)) {
+        scratch::PostProcessChain::setExposure(exposure);
+    }
+    const char *toneMappers[] = {"Reinhard", "ACES"};
+    int toneMapper = static_cast<int>(scratch::PostProcessChain::getToneMapper());
+    if (ImGui::Combo("Tone Mapping", &toneMapper, toneMappers, 2)) {
+        scratch::PostProcessChain::setToneMapper(static_cast<scratch::ToneMapper>(toneMapper));
+    }
+    bool fxaa = scratch::PostProcessChain::isFxaaEnabled();
+    if (ImGui::Checkbox("FXAA", &fxaa)) {
+        scratch::PostProcessChain::setFxaaEnabled(fxaa);
+    }
+    ImGui::End();
+}
+
+void scratch::MainMenuBar::renderOcclusionCullingWindow() {
+    if (!ImGui::Begin("Occlusion Culling", &occlusionCullingWindowOpen)) {
+        ImGui::End();
+        return;
+    }
+    if (!scratch::OcclusionCuller::isSupported()) {
+        ImGui::Text("Needs OpenGL 4.3");
+        ImGui::End();
+        return;
+    }
+    bool enabled = scratch::OcclusionCuller::isEnabled();
+    if (ImGui::Checkbox("Enabled", &enabled)) {
+        scratch::OcclusionCuller::setEnabled(enabled);
+    }
+    // results stay on the GPU, so there's no culled count to show here
+    ImGui::Text("Depth pyramid: %s", scratch::OcclusionCuller::isReady() ? "ready" : "waiting for a frame");
+    ImGui::End();
+}
+
 void scratch::MainMenuBar::saveSceneDialog() const {
     nfdchar_t *outPath = nullptr;
     std::string currentPath = std::filesystem::current_path().string();
@@ -8,6 +8,21 @@ namespace scratch {
         void render();
     private:
         bool demoWindowOpen;
+        bool textureStreamingWindowOpen = false;
+        bool shadowSettingsWindowOpen = false;
+        bool depthPrepassWindowOpen = false;
+        bool occlusionCullingWindowOpen = false;
+        bool postProcessingWindowOpen = false;
+
+        void renderTextureStreamingWindow();
+
+        void renderShadowSettingsWindow();
+
+        void renderDepthPrepassWindow();
+
+        void renderOcclusionCullingWindow();
+
+        void renderPostProcessingWindow();
 
         void reloadCurrentScene() const;
 
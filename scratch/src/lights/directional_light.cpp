@@ -42,7 +42,7 @@ void scratch::DirectionalLight::setSpecular(const scratch::Color &specular) {
     _specular = specular;
 }
 
-void scratch::DirectionalLight::applyToShader(scratch::Shader &shader) {
+void scratch::DirectionalLight::applyToShader(scratch::Shader &shader) const {
     shader.setVec3("dirLight.direction", _direction);
     shader.setVec3("dirLight.ambient", _ambient.getValue());
     shader.setVec3("dirLight.diffuse", _diffuse.getValue());
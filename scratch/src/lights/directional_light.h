@@ -35,7 +35,7 @@ namespace scratch {
 
         void setSpecular(const scratch::Color &_specular);
 
-        void applyToShader(Shader &shader);
+        void applyToShader(Shader &shader) const;
 
         void serialize(rapidjson::PrettyWriter<rapidjson::StringBuffer> &writer);
 
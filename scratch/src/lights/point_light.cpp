@@ -0,0 +1,72 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include <converter/string_converter.h>
+#include "point_light.h"
+
+scratch::PointLight::PointLight(const glm::vec3 &position, const scratch::Color &diffuse,
+                                const scratch::Color &specular, float range) : _position(position),
+                                                                               _diffuse(diffuse),
+                                                                               _specular(specular),
+                                                                               _range(range) {}
+
+const glm::vec3 &scratch::PointLight::getPosition() const {
+    return _position;
+}
+
+void scratch::PointLight::setPosition(const glm::vec3 &position) {
+    _position = position;
+}
+
+const scratch::Color &scratch::PointLight::getDiffuse() const {
+    return _diffuse;
+}
+
+void scratch::PointLight::setDiffuse(const scratch::Color &diffuse) {
+    _diffuse = diffuse;
+}
+
+const scratch::Color &scratch::PointLight::getSpecular() const {
+    return _specular;
+}
+
+void scratch::PointLight::setSpecular(const scratch::Color &specular) {
+    _specular = specular;
+}
+
+float scratch::PointLight::getRange() const {
+    return _range;
+}
+
+void scratch::PointLight::setRange(float range) {
+    _range = range;
+}
+
+void scratch::PointLight::serialize(rapidjson::PrettyWriter<rapidjson::StringBuffer> &writer) {
+    writer.StartObject();
+
+    writer.String("position");
+    std::string serializedPosition = scratch::StringConverter::toString(_position);
+    writer.String(serializedPosition.c_str(), static_cast<rapidjson::SizeType>(serializedPosition.length()));
+
+    writer.String("diffuse");
+    std::string serializedDiffuse = scratch::StringConverter::toString(_diffuse.getValue());
+    writer.String(serializedDiffuse.c_str(), static_cast<rapidjson::SizeType>(serializedDiffuse.length()));
+
+    writer.String("specular");
+    std::string serializedSpecular = scratch::StringConverter::toString(_specular.getValue());
+    writer.String(serializedSpecular.c_str(), static_cast<rapidjson::SizeType>(serializedSpecular.length()));
+
+    writer.String("range");
+    writer.Double(_range);
+
+    writer.EndObject();
+}
+
+void scratch::PointLight::deserialize(const rapidjson::Value &object) {
+    _position = scratch::StringConverter::parsevec3(object["position"].GetString());
+    _diffuse = scratch::StringConverter::parsevec3(object["diffuse"].GetString());
+    _specular = scratch::StringConverter::parsevec3(object["specular"].GetString());
+    _range = object["range"].GetFloat();
+}
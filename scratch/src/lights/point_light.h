@@ -0,0 +1,47 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include "color/color.h"
+#include "glm/glm.hpp"
+#include <include/rapidjson/writer.h>
+#include <include/rapidjson/prettywriter.h>
+#include <include/rapidjson/document.h>
+
+namespace scratch {
+    // Light shining in every direction from a point, fading out to nothing at its range
+    class PointLight {
+    public:
+        PointLight(const glm::vec3 &position, const scratch::Color &diffuse, const scratch::Color &specular,
+                   float range);
+
+        PointLight() {}
+
+        const glm::vec3 &getPosition() const;
+
+        void setPosition(const glm::vec3 &position);
+
+        const scratch::Color &getDiffuse() const;
+
+        void setDiffuse(const scratch::Color &diffuse);
+
+        const scratch::Color &getSpecular() const;
+
+        void setSpecular(const scratch::Color &specular);
+
+        float getRange() const;
+
+        void setRange(float range);
+
+        void serialize(rapidjson::PrettyWriter<rapidjson::StringBuffer> &writer);
+
+        void deserialize(const rapidjson::Value &object);
+
+    private:
+        glm::vec3 _position = glm::vec3(0.0f);
+        scratch::Color _diffuse = scratch::WHITE;
+        scratch::Color _specular = scratch::WHITE;
+        float _range = 10.0f;
+    };
+}
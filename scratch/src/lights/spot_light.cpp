@@ -0,0 +1,108 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include <converter/string_converter.h>
+#include "spot_light.h"
+
+scratch::SpotLight::SpotLight(const glm::vec3 &position, const glm::vec3 &direction, const scratch::Color &diffuse,
+                              const scratch::Color &specular, float range, float innerCutoff, float outerCutoff)
+        : _position(position), _direction(direction), _diffuse(diffuse), _specular(specular), _range(range),
+          _innerCutoff(innerCutoff), _outerCutoff(outerCutoff) {}
+
+const glm::vec3 &scratch::SpotLight::getPosition() const {
+    return _position;
+}
+
+void scratch::SpotLight::setPosition(const glm::vec3 &position) {
+    _position = position;
+}
+
+const glm::vec3 &scratch::SpotLight::getDirection() const {
+    return _direction;
+}
+
+void scratch::SpotLight::setDirection(const glm::vec3 &direction) {
+    _direction = direction;
+}
+
+const scratch::Color &scratch::SpotLight::getDiffuse() const {
+    return _diffuse;
+}
+
+void scratch::SpotLight::setDiffuse(const scratch::Color &diffuse) {
+    _diffuse = diffuse;
+}
+
+const scratch::Color &scratch::SpotLight::getSpecular() const {
+    return _specular;
+}
+
+void scratch::SpotLight::setSpecular(const scratch::Color &specular) {
+    _specular = specular;
+}
+
+float scratch::SpotLight::getRange() const {
+    return _range;
+}
+
+void scratch::SpotLight::setRange(float range) {
+    _range = range;
+}
+
+float scratch::SpotLight::getInnerCutoff() const {
+    return _innerCutoff;
+}
+
+void scratch::SpotLight::setInnerCutoff(float innerCutoff) {
+    _innerCutoff = innerCutoff;
+}
+
+float scratch::SpotLight::getOuterCutoff() const {
+    return _outerCutoff;
+}
+
+void scratch::SpotLight::setOuterCutoff(float outerCutoff) {
+    _outerCutoff = outerCutoff;
+}
+
+void scratch::SpotLight::serialize(rapidjson::PrettyWriter<rapidjson::StringBuffer> &writer) {
+    writer.StartObject();
+
+    writer.String("position");
+    std::string serializedPosition = scratch::StringConverter::toString(_position);
+    writer.String(serializedPosition.c_str(), static_cast<rapidjson::SizeType>(serializedPosition.length()));
+
+    writer.String("direction");
+    std::string serializedDirection = scratch::StringConverter::toString(_direction);
+    writer.String(serializedDirection.c_str(), static_cast<rapidjson::SizeType>(serializedDirection.length()));
+
+    writer.String("diffuse");
+    std::string serializedDiffuse = scratch::StringConverter::toString(_diffuse.getValue());
+    writer.String(serializedDiffuse.c_str(), static_cast<rapidjson::SizeType>(serializedDiffuse.length()));
+
+    writer.String("specular");
+    std::string serializedSpecular = scratch::StringConverter::toString(_specular.getValue());
+    writer.String(serializedSpecular.c_str(), static_cast<rapidjson::SizeType>(serializedSpecular.length()));
+
+    writer.String("range");
+    writer.Double(_range);
+
+    writer.String("innerCutoff");
+    writer.Double(_innerCutoff);
+
+    writer.String("outerCutoff");
+    writer.Double(_outerCutoff);
+
+    writer.EndObject();
+}
+
+void scratch::SpotLight::deserialize(const rapidjson::Value &object) {
+    _position = scratch::StringConverter::parsevec3(object["position"].GetString());
+    _direction = scratch::StringConverter::parsevec3(object["direction"].GetString());
+    _diffuse = scratch::StringConverter::parsevec3(object["diffuse"].GetString());
+    _specular = scratch::StringConverter::parsevec3(object["specular"].GetString());
+    _range = object["range"].GetFloat();
+    _innerCutoff = object["innerCutoff"].GetFloat();
+    _outerCutoff = object["outerCutoff"].GetFloat();
+}
@@ -0,0 +1,63 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include "color/color.h"
+#include "glm/glm.hpp"
+#include <include/rapidjson/writer.h>
+#include <include/rapidjson/prettywriter.h>
+#include <include/rapidjson/document.h>
+
+namespace scratch {
+    // Cone of light, full strength inside the inner cutoff and fading to nothing at the outer one.
+    // Cutoffs are half angles in degrees.
+    class SpotLight {
+    public:
+        SpotLight(const glm::vec3 &position, const glm::vec3 &direction, const scratch::Color &diffuse,
+                  const scratch::Color &specular, float range, float innerCutoff, float outerCutoff);
+
+        SpotLight() {}
+
+        const glm::vec3 &getPosition() const;
+
+        void setPosition(const glm::vec3 &position);
+
+        const glm::vec3 &getDirection() const;
+
+        void setDirection(const glm::vec3 &direction);
+
+        const scratch::Color &getDiffuse() const;
+
+        void setDiffuse(const scratch::Color &diffuse);
+
+        const scratch::Color &getSpecular() const;
+
+        void setSpecular(const scratch::Color &specular);
+
+        float getRange() const;
+
+        void setRange(float range);
+
+        float getInnerCutoff() const;
+
+        void setInnerCutoff(float innerCutoff);
+
+        float getOuterCutoff() const;
+
+        void setOuterCutoff(float outerCutoff);
+
+        void serialize(rapidjson::PrettyWriter<rapidjson::StringBuffer> &writer);
+
+        void deserialize(const rapidjson::Value &object);
+
+    private:
+        glm::vec3 _position = glm::vec3(0.0f);
+        glm::vec3 _direction = glm::vec3(0.0f, -1.0f, 0.0f);
+        scratch::Color _diffuse = scratch::WHITE;
+        scratch::Color _specular = scratch::WHITE;
+        float _range = 10.0f;
+        float _innerCutoff = 12.5f;
+        float _outerCutoff = 17.5f;
+    };
+}
@@ -7,6 +7,7 @@
 
 
 // Standard Headers
+#include <cmath>
 #include <cstdlib>
 #include <iostream>
 #include <optional>
@@ -20,6 +21,7 @@
 // Local Headers
 #include "time/scratch_time.h"
 #include "graphics/render_system.h"
+#include "graphics/texture_manager.h"
 
 
 void mouseButtonCallback(GLFWwindow *window, int button, int action, int mods);
@@ -52,6 +54,8 @@ int main() {
     auto selectionShader = scratch::ScratchManagers->sceneManager->createShader(
             "./assets/shaders/entity-selection.vert",
             "./assets/shaders/entity-selection.frag");
+    // picking reads back a frame straight away, it can't wait for a background compile
+    selectionShader->waitUntilReady();
 
 //    loadDefaultScene();
     selectedSceneNodeId = 0;
@@ -72,10 +76,13 @@ int main() {
     while (glfwWindowShouldClose(scratch::MainWindow) == false) {
         glfwPollEvents();
         scratch::Time::updateClock();
+        // GL work handed back by jobs, before anything this frame draws
+        scratch::ScratchManagers->jobSystem->runMainThreadJobs();
 
         handleInput();
 
         RenderSystem::startFrame();
+        scratch::ScratchManagers->sceneManager->reloadChangedShaders();
 
         auto selectedNode = selectedSceneNodeId == 0 ? nullptr : scratch::ScratchManagers->sceneManager->findSceneNode(
                 selectedSceneNodeId);
@@ -95,6 +102,23 @@ int main() {
                 materialPropsWidget.setMaterials(selectedNode->getEntity()->getRenderable()->getMaterials());
                 materialPropsWidget.render();
             }
+            const std::shared_ptr<scratch::Entity> &selectedEntity = selectedNode->getEntity();
+            const std::vector<scratch::AnimationClip> &animations = selectedEntity->getRenderable()->getAnimations();
+            if (!animations.empty() && ImGui::CollapsingHeader("Animation", ImGuiTreeNodeFlags_DefaultOpen)) {
+                // the first entry is the bind pose
+                std::vector<const char *> clipNames = {"Bind Pose"};
+                for (const auto &animation : animations) {
+                    clipNames.push_back(animation.name.c_str());
+                }
+                scratch::AnimationState animationState = selectedEntity->getAnimationState();
+                int selectedClip = animationState.clipIndex + 1;
+                if (ImGui::Combo("Clip", &selectedClip, clipNames.data(), static_cast<int>(clipNames.size()))) {
+                    selectedEntity->playAnimation(selectedClip - 1, animationState.looping);
+                }
+                if (ImGui::SliderFloat("Speed", &animationState.speed, 0.0f, 2.0f)) {
+                    selectedEntity->setAnimationSpeed(animationState.speed);
+                }
+            }
 
             ImGui::End();
         }
@@ -121,10 +145,17 @@ int main() {
 
         mainMenuBar.render();
 
-        scratch::ScratchManagers->sceneManager->render(*scratch::MainCamera);
+        scratch::ScratchManagers->sceneManager->updateAnimations(scratch::Time::getDeltaTime());
+
+        // Everything above may change the scene, from here on it is only read. Next frame's packet is
+        // snapshotted on the job system while last frame's is drawn and presented.
+        scratch::ScratchManagers->sceneManager->beginSnapshot(*scratch::MainCamera);
+        scratch::ScratchManagers->sceneManager->render();
 
         RenderSystem::endFrame();
+        scratch::ScratchManagers->sceneManager->waitForSnapshot();
     }
+    RenderSystem::shutdown();
     glfwTerminate();
     return EXIT_SUCCESS;
 }
@@ -206,8 +237,12 @@ void loadDefaultScene() {
     std::cout << "Loading Shaders..." << std::endl;
     auto unlitShader = scratch::ScratchManagers->sceneManager->createShader("./assets/shaders/unlit.vert",
                                                                             "./assets/shaders/unlit.frag");
-    auto litShader = scratch::ScratchManagers->sceneManager->createShader("./assets/shaders/lit.vert",
-                                                                          "./assets/shaders/lit.frag");
+    // the batched variant needs bindless textures or texture arrays to reach its material textures
+    bool batched = scratch::TextureManager::getBindingMode() != scratch::BIND_PER_MATERIAL;
+    auto litShader = batched ? scratch::ScratchManagers->sceneManager->createShader("./assets/shaders/lit-batched.vert",
+                                                                                    "./assets/shaders/lit-batched.frag")
+                             : scratch::ScratchManagers->sceneManager->createShader("./assets/shaders/lit.vert",
+                                                                                    "./assets/shaders/lit.frag");
 
     std::cout << "Loading Models..." << std::endl;
     auto nanoSuitModel = scratch::ScratchManagers->sceneManager->createModelRenderable(
@@ -234,4 +269,19 @@ void loadDefaultScene() {
     directionalLight->setAmbient(scratch::Color(glm::vec3(0.2f)));
     directionalLight->setDiffuse(scratch::Color(glm::vec3(0.5f)));
     directionalLight->setSpecular(scratch::WHITE);
+
+    // a ring of coloured point lights around the models and a spot light from above
+    const int pointLightCount = 16;
+    for (int i = 0; i < pointLightCount; ++i) {
+        float angle = glm::radians(360.0f * static_cast<float>(i) / pointLightCount);
+        auto pointLight = scratch::ScratchManagers->sceneManager->createPointLight();
+        pointLight->setPosition(glm::vec3(-1.0f + 3.0f * std::cos(angle), 1.0f, 3.0f * std::sin(angle)));
+        pointLight->setDiffuse(scratch::Color(glm::vec3(0.5f + 0.5f * std::cos(angle),
+                                                        0.5f + 0.5f * std::sin(angle), 0.5f)));
+        pointLight->setRange(3.0f);
+    }
+    auto spotLight = scratch::ScratchManagers->sceneManager->createSpotLight();
+    spotLight->setPosition(glm::vec3(0.0f, 5.0f, 0.0f));
+    spotLight->setDirection(glm::vec3(0.0f, -1.0f, 0.0f));
+    spotLight->setRange(8.0f);
 }
\ No newline at end of file
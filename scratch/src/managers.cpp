@@ -5,5 +5,6 @@
 #include "managers.h"
 
 scratch::Managers::Managers() {
+    jobSystem = std::make_unique<JobSystem>();
     sceneManager = std::make_unique<SceneManager>();
 }
@@ -2,12 +2,15 @@
 
 #include <memory>
 #include <scene/scene_manager.h>
+#include <threading/job_system.h>
 
 namespace scratch {
     class Managers {
     public:
         Managers();
 
+        std::unique_ptr<scratch::JobSystem> jobSystem;
+
         std::unique_ptr<scratch::SceneManager> sceneManager;
     };
 }
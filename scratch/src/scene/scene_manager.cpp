@@ -4,8 +4,12 @@
 
 #include <graphics/model_renderable.h>
 
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
 #include <utility>
 #include <graphics/render_system.h>
+#include <graphics/render_graph.h>
 #include <main.h>
 #include <include/rapidjson/prettywriter.h>
 #include "scene_manager.h"
@@ -21,8 +25,10 @@ scratch::SceneManager::SceneManager() {
 
 std::shared_ptr<scratch::Renderable>
 scratch::SceneManager::createModelRenderable(const std::string &modelPath,
-                                             const std::shared_ptr<Shader> &defaultShader) {
-    std::shared_ptr<scratch::Model> newModel = std::make_shared<scratch::Model>(_idFactory.generateId(), modelPath);
+                                             const std::shared_ptr<Shader> &defaultShader,
+                                             const ModelImportSettings &importSettings) {
+    std::shared_ptr<scratch::Model> newModel = std::make_shared<scratch::Model>(_idFactory.generateId(), modelPath,
+                                                                                importSettings);
     for (auto material : newModel->getMaterials()) {
         material->setId(_idFactory.generateId());
         _materials.push_back(material);
@@ -39,6 +45,10 @@ scratch::SceneManager::createModelRenderable(const std::string &modelPath,
 
 std::shared_ptr<scratch::Entity> scratch::SceneManager::createEntity(std::shared_ptr<Renderable> renderable) {
     std::shared_ptr<scratch::Entity> pEntity = std::make_shared<scratch::Entity>(_idFactory.generateId(), renderable);
+    // rigged models come in moving
+    if (!pEntity->getRenderable()->getAnimations().empty()) {
+        pEntity->playAnimation(0);
+    }
     _entities.push_back(pEntity);
     return pEntity;
 }
@@ -55,24 +65,225 @@ scratch::SceneManager::createShader(const std::string &vertexPath, const std::st
     std::shared_ptr<scratch::Shader> shader = std::make_shared<scratch::Shader>(_idFactory.generateId(), vertexPath,
                                                                                 fragmentPath);
     _shaders.push_back(shader);
+    watchShaderSources(*shader);
     return shader;
 }
 
 
-void scratch::SceneManager::render(const scratch::Camera &camera) {
-    std::vector<scratch::Mesh> renderQueue = std::vector<scratch::Mesh>();
-    for (auto currentNode : _rootNode.getChildren()) {
-        auto currentEntity = currentNode->getEntity();
-        std::vector<scratch::Mesh> meshesToRender = currentEntity->getRenderable()->getMeshes();
-        glm::mat4 modelMatrix = currentNode->generateTransformMatrix();
-        for (auto &mesh : meshesToRender) {
-            // TODO: get rid of these
-            // also remove code from serialization in material
-            mesh.getMaterial()->setMat4("model", modelMatrix);
-            renderQueue.push_back(mesh);
+void scratch::SceneManager::beginSnapshot(const scratch::Camera &camera) {
+    scratch::FramePacket &packet = _framePackets[_buildingPacket];
+    // the small stuff is copied here, the job only has to walk the nodes
+    packet.camera = camera;
+    packet.view = camera.getViewMatrix();
+    packet.projection = camera.getProjectionMatrix();
+    packet.directionalLight = _directionalLight != nullptr ? *_directionalLight : scratch::DirectionalLight();
+    packet.pointLights.clear();
+    for (const auto &pointLight : _pointLights) {
+        packet.pointLights.push_back(*pointLight);
+    }
+    packet.spotLights.clear();
+    for (const auto &spotLight : _spotLights) {
+        packet.spotLights.push_back(*spotLight);
+    }
+    // every entity playing a clip gets its own slice of the palette, nodes sharing an entity share it
+    _animationInstances.clear();
+    _animatedEntities.clear();
+    for (const auto &node : _rootNode.getChildren()) {
+        const scratch::Entity &entity = *node->getEntity();
+        const scratch::AnimationState &animationState = entity.getAnimationState();
+        const std::vector<scratch::AnimationClip> &animations = entity.getRenderable()->getAnimations();
+        if (animationState.clipIndex < 0 || animationState.clipIndex >= static_cast<int>(animations.size()) ||
+            _animatedEntities.count(entity.getID()) > 0) {
+            continue;
         }
+        _animatedEntities.emplace(entity.getID(), _animationInstances.size());
+        _animationInstances.push_back({&entity.getRenderable()->getSkeleton(), &animations[animationState.clipIndex],
+                                       animationState.time,
+                                       scratch::AnimationSampler::getJointCount(_animationInstances)});
+    }
+
+    scratch::JobSystem &jobSystem = *scratch::ScratchManagers->jobSystem;
+    _snapshotPending = true;
+    jobSystem.run([this, &packet, &jobSystem]() {
+        // poses first, animated draw items are culled with their posed bounds
+        scratch::AnimationSampler::sample(_animationInstances, _poses, packet.bonePalette, _poseBounds, jobSystem);
+        buildRenderQueue(packet, jobSystem);
+    }, &_snapshotDone);
+}
+
+void scratch::SceneManager::updateAnimations(float deltaTime) {
+    for (const auto &entity : _entities) {
+        entity->advanceAnimation(deltaTime);
     }
-    RenderSystem::render(renderQueue, *_directionalLight);
+}
+
+void scratch::SceneManager::waitForSnapshot() {
+    if (!_snapshotPending) {
+        return;
+    }
+    scratch::ScratchManagers->jobSystem->wait(_snapshotDone);
+    _snapshotPending = false;
+    _drawingPacket = _buildingPacket;
+    _buildingPacket = 1 - _buildingPacket;
+    _hasFramePacket = true;
+}
+
+void scratch::SceneManager::render() {
+    if (!_hasFramePacket) {
+        // the first frame has nothing from before, so it draws the snapshot still being built
+        waitForSnapshot();
+        if (!_hasFramePacket) {
+            return;
+        }
+    }
+    const scratch::FramePacket &packet = _framePackets[_drawingPacket];
+    // texture streaming belongs to this thread, so the coverage the snapshot found is handed over here
+    for (const auto &[material, coverage] : packet.textureCoverage) {
+        material->requestTextureCoverage(coverage);
+    }
+    // only submission touches the GL context, so it stays on this thread
+    RenderSystem::render(packet);
+}
+
+void scratch::SceneManager::buildRenderQueue(scratch::FramePacket &packet, scratch::JobSystem &jobSystem) {
+    struct LodChange {
+        unsigned int nodeId;
+        size_t meshIndex;
+        unsigned int lod;
+    };
+    // what one chunk produces, nothing in it is shared with other chunks
+    struct ChunkList {
+        std::vector<scratch::DrawItem> items;
+        // indices into items, sorted by key
+        std::vector<size_t> visibleItems;
+        std::vector<LodChange> lodChanges;
+        std::unordered_map<const scratch::Material *, float> textureCoverage;
+        std::vector<std::shared_ptr<const scratch::Renderable>> renderables;
+    };
+
+    const std::vector<std::shared_ptr<scratch::SceneNode>> &nodes = _rootNode.getChildren();
+    size_t chunkCount = (nodes.size() + NODES_PER_CHUNK - 1) / NODES_PER_CHUNK;
+    std::vector<ChunkList> chunks(chunkCount);
+    const scratch::Camera &camera = packet.camera;
+    const glm::mat4 &view = packet.view;
+    scratch::Frustum frustum(packet.projection * view);
+
+    jobSystem.parallelFor(chunkCount, [&](size_t chunkIndex) {
+        ChunkList &chunk = chunks[chunkIndex];
+        size_t lastNode = std::min(nodes.size(), (chunkIndex + 1) * NODES_PER_CHUNK);
+        for (size_t nodeIndex = chunkIndex * NODES_PER_CHUNK; nodeIndex < lastNode; ++nodeIndex) {
+            scratch::SceneNode &node = *nodes[nodeIndex];
+            const std::shared_ptr<scratch::Renderable> &renderable = node.getEntity()->getRenderable();
+            chunk.renderables.push_back(renderable);
+            const std::vector<scratch::Mesh> &meshesToRender = renderable->getMeshes();
+            glm::mat4 modelMatrix = node.generateTransformMatrix();
+            auto animated = _animatedEntities.find(node.getEntity()->getID());
+            for (size_t i = 0; i < meshesToRender.size(); ++i) {
+                const scratch::Mesh &mesh = meshesToRender[i];
+                unsigned int previousLod = _lodSelector.getCurrentLod(node.getId(), i);
+                unsigned int lod = _lodSelector.selectLod(node.getId(), i, mesh, modelMatrix, camera);
+                if (lod != previousLod) {
+                    chunk.lodChanges.push_back({node.getId(), i, lod});
+                }
+
+                scratch::Bounds localBounds = mesh.getBounds();
+                uint32_t paletteOffset = scratch::DrawItem::NO_PALETTE;
+                if (animated != _animatedEntities.end() && mesh.isSkinned()) {
+                    paletteOffset = _animationInstances[animated->second].firstJoint;
+                    // limbs leave the bind pose's box, the posed one covers every vertex wherever it went
+                    const scratch::Bounds &poseBounds = _poseBounds[animated->second];
+                    if (!poseBounds.isEmpty()) {
+                        localBounds = poseBounds;
+                    }
+                }
+                scratch::Bounds bounds = localBounds.transform(modelMatrix);
+                uint64_t sortKey = 0;
+                if (frustum.intersects(bounds)) {
+                    // only what's on screen asks for mips, the rest fall back to their initial size when unused
+                    float &coverage = chunk.textureCoverage[mesh.getMaterial().get()];
+                    coverage = std::max(coverage, scratch::LodSelector::calculateScreenSize(mesh.getBounds(),
+                                                                                            modelMatrix, camera));
+                    // positive floats order the same as their bits
+                    float viewDepth = std::max(-(view * glm::vec4(bounds.getCenter(), 1.0f)).z, 0.0f);
+                    uint32_t depthBits;
+                    std::memcpy(&depthBits, &viewDepth, sizeof(depthBits));
+                    sortKey = (static_cast<uint64_t>(depthBits) << 32) | mesh.getMaterial()->getId();
+                    chunk.visibleItems.push_back(chunk.items.size());
+                }
+                chunk.items.push_back({&mesh, modelMatrix, lod, bounds, sortKey, paletteOffset});
+            }
+        }
+        std::sort(chunk.visibleItems.begin(), chunk.visibleItems.end(), [&chunk](size_t a, size_t b) {
+            return chunk.items[a].sortKey < chunk.items[b].sortKey;
+        });
+    });
+
+    // where each chunk's lists start once concatenated
+    std::vector<size_t> itemOffsets(chunkCount + 1, 0);
+    std::vector<size_t> visibleOffsets(chunkCount + 1, 0);
+    for (size_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex) {
+        itemOffsets[chunkIndex + 1] = itemOffsets[chunkIndex] + chunks[chunkIndex].items.size();
+        visibleOffsets[chunkIndex + 1] = visibleOffsets[chunkIndex] + chunks[chunkIndex].visibleItems.size();
+    }
+    // the packet is reused every other frame, so its lists mostly keep their capacity
+    scratch::RenderQueue &renderQueue = packet.renderQueue;
+    renderQueue.items.clear();
+    renderQueue.items.resize(itemOffsets[chunkCount]);
+    std::vector<const scratch::DrawItem *> visibleItems(visibleOffsets[chunkCount]);
+    jobSystem.parallelFor(chunkCount, [&](size_t chunkIndex) {
+        const ChunkList &chunk = chunks[chunkIndex];
+        std::copy(chunk.items.begin(), chunk.items.end(), renderQueue.items.begin() + itemOffsets[chunkIndex]);
+        for (size_t i = 0; i < chunk.visibleItems.size(); ++i) {
+            visibleItems[visibleOffsets[chunkIndex] + i] =
+                    &renderQueue.items[itemOffsets[chunkIndex] + chunk.visibleItems[i]];
+        }
+    });
+
+    packet.textureCoverage.clear();
+    packet.renderables.clear();
+    for (const auto &chunk : chunks) {
+        // only snapshots touch the lod selector, and never two at once
+        for (const auto &lodChange : chunk.lodChanges) {
+            _lodSelector.recordLod(lodChange.nodeId, lodChange.meshIndex, lodChange.lod);
+        }
+        packet.textureCoverage.insert(packet.textureCoverage.end(), chunk.textureCoverage.begin(),
+                                      chunk.textureCoverage.end());
+        packet.renderables.insert(packet.renderables.end(), chunk.renderables.begin(), chunk.renderables.end());
+    }
+    // every mesh instance drawn has at most one remembered level, more means renderables went away since
+    if (_lodSelector.getInstanceCount() > renderQueue.items.size()) {
+        std::unordered_map<unsigned int, size_t> meshCounts;
+        for (const auto &node : nodes) {
+            meshCounts[node->getId()] = node->getEntity()->getRenderable()->getMeshes().size();
+        }
+        _lodSelector.retainNodes(meshCounts);
+    }
+
+    // every chunk's run is sorted, merge neighbouring runs until one is left
+    auto bySortKey = [](const scratch::DrawItem *a, const scratch::DrawItem *b) {
+        return a->sortKey < b->sortKey;
+    };
+    std::vector<const scratch::DrawItem *> merged(visibleItems.size());
+    std::vector<size_t> runStarts = visibleOffsets;
+    while (runStarts.size() > 2) {
+        size_t runCount = runStarts.size() - 1;
+        jobSystem.parallelFor((runCount + 1) / 2, [&](size_t pair) {
+            size_t first = runStarts[pair * 2];
+            size_t middle = runStarts[std::min(pair * 2 + 1, runCount)];
+            size_t last = runStarts[std::min(pair * 2 + 2, runCount)];
+            std::merge(visibleItems.begin() + first, visibleItems.begin() + middle,
+                       visibleItems.begin() + middle, visibleItems.begin() + last, merged.begin() + first,
+                       bySortKey);
+        });
+        visibleItems.swap(merged);
+        std::vector<size_t> mergedStarts;
+        for (size_t run = 0; run < runCount; run += 2) {
+            mergedStarts.push_back(runStarts[run]);
+        }
+        mergedStarts.push_back(runStarts[runCount]);
+        runStarts.swap(mergedStarts);
+    }
+    renderQueue.visibleItems = std::move(visibleItems);
 }
 
 std::shared_ptr<scratch::DirectionalLight> scratch::SceneManager::createDirectionalLight() {
@@ -80,6 +291,26 @@ std::shared_ptr<scratch::DirectionalLight> scratch::SceneManager::createDirectio
     return _directionalLight;
 }
 
+std::shared_ptr<scratch::PointLight> scratch::SceneManager::createPointLight() {
+    std::shared_ptr<scratch::PointLight> pointLight = std::make_shared<scratch::PointLight>();
+    _pointLights.push_back(pointLight);
+    return pointLight;
+}
+
+std::shared_ptr<scratch::SpotLight> scratch::SceneManager::createSpotLight() {
+    std::shared_ptr<scratch::SpotLight> spotLight = std::make_shared<scratch::SpotLight>();
+    _spotLights.push_back(spotLight);
+    return spotLight;
+}
+
+const std::vector<std::shared_ptr<scratch::PointLight>> &scratch::SceneManager::getPointLights() const {
+    return _pointLights;
+}
+
+const std::vector<std::shared_ptr<scratch::SpotLight>> &scratch::SceneManager::getSpotLights() const {
+    return _spotLights;
+}
+
 std::shared_ptr<scratch::SceneNode> scratch::SceneManager::findSceneNode(unsigned int id) {
     for (auto currentNode : _rootNode.getChildren()) {
         if (currentNode->getId() == id) {
@@ -89,41 +320,70 @@ std::shared_ptr<scratch::SceneNode> scratch::SceneManager::findSceneNode(unsigne
     return nullptr;
 }
 
-//TODO: Render to separate frame buffer
 //TODO: break this off
 unsigned int scratch::SceneManager::handleSelection(scratch::Shader &selectionShader, glm::vec2 mousePosition) {
-    glDisable(GL_FRAMEBUFFER_SRGB);
-    glClearColor(0, 0, 0, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    int width, height;
+    glfwGetWindowSize(scratch::MainWindow, &width, &height);
     glm::mat4 view = scratch::MainCamera->getViewMatrix();
     glm::mat4 projection = scratch::MainCamera->getProjectionMatrix();
-    for (auto currentNode : _rootNode.getChildren()) {
-        auto currentEntity = currentNode->getEntity();
-        std::vector<scratch::Mesh> meshesToRender = currentEntity->getRenderable()->getMeshes();
-        glm::mat4 modelMatrix = currentNode->generateTransformMatrix();
-        for (auto &mesh : meshesToRender) {
-            selectionShader.use();
-            selectionShader.setMat4("model", modelMatrix);
-            selectionShader.setMat4("view", view);
-            selectionShader.setMat4("projection", projection);
-            selectionShader.setUnsignedInt("entityId", currentNode->getId());
-            mesh.draw();
+    unsigned int selectedId = 0;
+
+    scratch::RenderGraph graph;
+    // ids are written as plain bytes, so an 8 bit target of its own keeps them away from the scene
+    scratch::RenderGraphResource entityIds = graph.createTarget("Entity Ids", {width, height, GL_RGBA8, true});
+    graph.addPass("Entity Selection", [&](scratch::RenderGraph::PassBuilder &builder) {
+        scratch::RenderPassState state;
+        state.clearColor = true;
+        state.clearDepth = true;
+        builder.setRenderTarget(entityIds, state);
+        // only read back, nothing else in the graph uses it
+        builder.setSideEffect();
+    }, [&](const scratch::RenderGraph::PassResources &) {
+        for (auto currentNode : _rootNode.getChildren()) {
+            auto currentEntity = currentNode->getEntity();
+            const std::vector<scratch::Mesh> &meshesToRender = currentEntity->getRenderable()->getMeshes();
+            glm::mat4 modelMatrix = currentNode->generateTransformMatrix();
+            for (const auto &mesh : meshesToRender) {
+                selectionShader.use();
+                selectionShader.setMat4("model", modelMatrix);
+                selectionShader.setMat4("view", view);
+                selectionShader.setMat4("projection", projection);
+                selectionShader.setUnsignedInt("entityId", currentNode->getId());
+                mesh.draw();
+            }
         }
-    }
-    GLubyte pixel[3];
-    int width, height;
-    glfwGetWindowSize(scratch::MainWindow, &width, &height);
-    glReadPixels(mousePosition.x, height - mousePosition.y, 1, 1, GL_RGB, GL_UNSIGNED_BYTE, &pixel);
-    unsigned int selectedId = pixel[0] | pixel[1] << 8 | pixel[2] << 16;
+        GLubyte pixel[3];
+        glReadPixels(mousePosition.x, height - mousePosition.y, 1, 1, GL_RGB, GL_UNSIGNED_BYTE, &pixel);
+        selectedId = pixel[0] | pixel[1] << 8 | pixel[2] << 16;
+    });
+    graph.execute();
+    glViewport(0, 0, width, height);
     std::cout << "Selected Scene Node Id: " << selectedId << std::endl;
 
-    glEnable(GL_FRAMEBUFFER_SRGB);
-    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
     return selectedId;
 }
 
+void scratch::SceneManager::reloadChangedShaders() {
+    std::vector<std::string> changedFiles = _shaderWatcher.poll();
+    if (changedFiles.empty()) {
+        return;
+    }
+    for (const auto &shader : _shaders) {
+        for (const auto &changedFile : changedFiles) {
+            if (shader->getVertexPath() == changedFile || shader->getFragmentPath() == changedFile) {
+                // compiles in the background, the old program draws until the new one links
+                shader->reload();
+                break;
+            }
+        }
+    }
+}
+
+void scratch::SceneManager::watchShaderSources(const scratch::Shader &shader) {
+    _shaderWatcher.watch(shader.getVertexPath());
+    _shaderWatcher.watch(shader.getFragmentPath());
+}
+
 const std::vector<std::shared_ptr<scratch::Shader>> &scratch::SceneManager::getShaders() const {
     return _shaders;
 }
@@ -186,6 +446,20 @@ void scratch::SceneManager::saveScene(std::string scenePath) {
     writer.String("directionalLight");
     _directionalLight->serialize(writer);
 
+    writer.String("pointLights");
+    writer.StartArray();
+    for (auto &pointLight : _pointLights) {
+        pointLight->serialize(writer);
+    }
+    writer.EndArray();
+
+    writer.String("spotLights");
+    writer.StartArray();
+    for (auto &spotLight : _spotLights) {
+        spotLight->serialize(writer);
+    }
+    writer.EndArray();
+
     std::cout << "Serializing Scene Graph" << std::endl;
     writer.String("rootNode");
     _rootNode.serialize(writer);
@@ -226,6 +500,7 @@ void scratch::SceneManager::loadScene(std::string scenePath) {
         std::shared_ptr<scratch::Shader> shader = std::make_shared<scratch::Shader>();
         shader->deserialize(*itr);
         _shaders.push_back(shader);
+        watchShaderSources(*shader);
     }
 
     std::cout << "Deserializing Materials" << std::endl;
@@ -300,16 +575,52 @@ void scratch::SceneManager::loadScene(std::string scenePath) {
         }
         std::shared_ptr<scratch::Entity> newEntity = std::make_shared<scratch::Entity>((*itr)["id"].GetUint(),
                                                                                        linkedRenderable);
+        // scenes saved before animation keep their entities in the bind pose
+        if ((*itr).HasMember("animationClip") && (*itr)["animationClip"].IsInt()) {
+            int clipIndex = (*itr)["animationClip"].GetInt();
+            int clipCount = linkedRenderable ? static_cast<int>(linkedRenderable->getAnimations().size()) : 0;
+            if (clipIndex >= clipCount) {
+                // the model was re-imported with fewer clips since the scene was saved
+                std::cout << "WARNING: entity " << newEntity->getID() << " plays clip " << clipIndex
+                          << " of a renderable with " << clipCount << ", leaving it in the bind pose" << std::endl;
+                clipIndex = -1;
+            }
+            newEntity->playAnimation(std::max(clipIndex, -1));
+        }
+        if ((*itr).HasMember("animationSpeed") && (*itr)["animationSpeed"].IsNumber()) {
+            newEntity->setAnimationSpeed((*itr)["animationSpeed"].GetFloat());
+        }
         _entities.push_back(newEntity);
     }
 
     std::cout << "Deserializing Scene Graph" << std::endl;
     _rootNode.deserialize(document["rootNode"], _entities);
+    _lodSelector.clear();
 
     std::cout << "Deserializing Lights" << std::endl;
     _directionalLight = std::make_shared<scratch::DirectionalLight>();
     _directionalLight->deserialize(document["directionalLight"]);
 
+    // scenes saved before point and spot lights existed have neither array
+    _pointLights.clear();
+    if (document.HasMember("pointLights")) {
+        rapidjson::Value &pointLightsArray = document["pointLights"].GetArray();
+        for (rapidjson::Value::ConstValueIterator itr = pointLightsArray.Begin(); itr != pointLightsArray.End(); ++itr) {
+            std::shared_ptr<scratch::PointLight> pointLight = std::make_shared<scratch::PointLight>();
+            pointLight->deserialize(*itr);
+            _pointLights.push_back(pointLight);
+        }
+    }
+    _spotLights.clear();
+    if (document.HasMember("spotLights")) {
+        rapidjson::Value &spotLightsArray = document["spotLights"].GetArray();
+        for (rapidjson::Value::ConstValueIterator itr = spotLightsArray.Begin(); itr != spotLightsArray.End(); ++itr) {
+            std::shared_ptr<scratch::SpotLight> spotLight = std::make_shared<scratch::SpotLight>();
+            spotLight->deserialize(*itr);
+            _spotLights.push_back(spotLight);
+        }
+    }
+
     _currentSceneFilePath = scenePath;
 
     std::cout << "Finished Loading Scene" << std::endl;
@@ -1,11 +1,22 @@
 #pragma once
 
+#include <array>
 #include <memory>
+#include <unordered_map>
 #include <entity/entity.hpp>
 #include <entity/id_factory.h>
 #include <lights/directional_light.h>
+#include <lights/point_light.h>
+#include <lights/spot_light.h>
+#include <graphics/model_import_settings.h>
 #include "scene_node.h"
+#include "animation/animation_sampler.h"
 #include "camera/camera.h"
+#include "graphics/frame_packet.h"
+#include "graphics/lod_selector.h"
+#include "graphics/render_queue.h"
+#include "threading/job_system.h"
+#include "utilities/file_watcher.h"
 
 namespace scratch {
 
@@ -14,7 +25,8 @@ namespace scratch {
         SceneManager();
 
         std::shared_ptr<scratch::Renderable> createModelRenderable(const std::string &modelPath,
-                                                                   const std::shared_ptr<Shader> &shader);
+                                                                   const std::shared_ptr<Shader> &shader,
+                                                                   const ModelImportSettings &importSettings = ModelImportSettings());
 
         std::shared_ptr<scratch::Entity> createEntity(std::shared_ptr<Renderable> renderable);
 
@@ -26,12 +38,35 @@ namespace scratch {
 
         std::shared_ptr<scratch::DirectionalLight> createDirectionalLight();
 
-        void render(const scratch::Camera &camera);
+        std::shared_ptr<scratch::PointLight> createPointLight();
+
+        std::shared_ptr<scratch::SpotLight> createSpotLight();
+
+        const std::vector<std::shared_ptr<scratch::PointLight>> &getPointLights() const;
+
+        const std::vector<std::shared_ptr<scratch::SpotLight>> &getSpotLights() const;
+
+        // Starts copying the scene as it is now into a frame packet on the job system, next frame's render draws
+        // it. The scene is read until waitForSnapshot returns, so nothing may change it before then. Drawing the
+        // previous packet in the meantime is what overlaps one frame's CPU work with the next.
+        void beginSnapshot(const scratch::Camera &camera);
+
+        // Moves every entity's playing animation along, before beginSnapshot
+        void updateAnimations(float deltaTime);
+
+        // Waits for the snapshot started by beginSnapshot
+        void waitForSnapshot();
+
+        // Draws the packet snapshotted last frame
+        void render();
 
         unsigned int handleSelection(scratch::Shader &selectionShader, glm::vec2 mousePosition);
 
         const std::vector<std::shared_ptr<scratch::Shader>> &getShaders() const;
 
+        // Recompiles the shaders whose source files were saved since the last call, call once per frame
+        void reloadChangedShaders();
+
         SceneNode &getRootNode();
 
         void saveScene(std::string scenePath);
@@ -52,6 +87,35 @@ namespace scratch {
         std::vector<std::shared_ptr<scratch::Renderable>> _renderables;
         std::vector<std::shared_ptr<scratch::Entity>> _entities;
         std::shared_ptr<scratch::DirectionalLight> _directionalLight;
+        std::vector<std::shared_ptr<scratch::PointLight>> _pointLights;
+        std::vector<std::shared_ptr<scratch::SpotLight>> _spotLights;
+        scratch::LodSelector _lodSelector;
+        scratch::FileWatcher _shaderWatcher;
+        // one being built while the other is drawn, the job building a packet writes nothing else but the
+        // lod selector
+        std::array<scratch::FramePacket, 2> _framePackets;
+        size_t _buildingPacket = 0;
+        size_t _drawingPacket = 0;
+        bool _hasFramePacket = false;
+        bool _snapshotPending = false;
+        scratch::JobCounter _snapshotDone;
+        // what the snapshot job poses, picked on the main thread. _animatedEntities maps entity ids to instances.
+        std::vector<scratch::AnimationInstance> _animationInstances;
+        std::unordered_map<unsigned int, size_t> _animatedEntities;
+        // only the snapshot job touches these, reused so they keep their capacity
+        scratch::PoseBuffer _poses;
+        std::vector<scratch::Bounds> _poseBounds;
+
+        // Root children per render queue chunk, each chunk is one parallelFor task
+        static const size_t NODES_PER_CHUNK = 256;
+
+        void watchShaderSources(const scratch::Shader &shader);
+
+        // Fills the packet's draw items for every node, built chunk by chunk across the job system. Each chunk culls,
+        // computes world matrices and lods and sorts its own visible items into lists of its own, the sorted lists
+        // are then merged pairwise in parallel. Lod bookkeeping is applied after, texture coverage is left in the
+        // packet for the main thread.
+        void buildRenderQueue(scratch::FramePacket &packet, scratch::JobSystem &jobSystem);
     };
 
 }
@@ -0,0 +1,320 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+
+#include "job_system.h"
+
+namespace {
+    // which system and deque the running thread belongs to, threads a system didn't start have none
+    thread_local const scratch::JobSystem *currentSystem = nullptr;
+    thread_local unsigned int currentQueue = 0;
+    // xorshift state picking the first victim to steal from, so thieves don't all pile onto the same deque
+    thread_local uint32_t stealState = 0;
+
+    uint32_t nextStealVictim() {
+        if (stealState == 0) {
+            stealState = static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1u;
+        }
+        stealState ^= stealState << 13;
+        stealState ^= stealState >> 17;
+        stealState ^= stealState << 5;
+        return stealState;
+    }
+}
+
+bool scratch::JobCounter::isDone() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _pending == 0;
+}
+
+scratch::JobSystem::JobSystem(unsigned int workerCount) {
+    // whoever creates the system is the thread owning the GL context
+    _mainThreadId = std::this_thread::get_id();
+    _workerThreadJobLimit = workerCount > 1 ? workerCount - 1 : 1;
+    for (unsigned int i = 0; i <= workerCount; ++i) {
+        _queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (unsigned int i = 0; i < workerCount; ++i) {
+        _workers.emplace_back(&JobSystem::workerLoop, this, i + 1);
+    }
+}
+
+scratch::JobSystem::~JobSystem() {
+    _stopping = true;
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+    }
+    _jobAvailable.notify_all();
+    for (auto &worker : _workers) {
+        worker.join();
+    }
+}
+
+unsigned int scratch::JobSystem::defaultWorkerCount() {
+    unsigned int cores = std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 1;
+}
+
+void scratch::JobSystem::run(std::function<void()> job, JobCounter *counter, JobAffinity affinity) {
+    if (counter != nullptr) {
+        std::lock_guard<std::mutex> lock(counter->_mutex);
+        ++counter->_pending;
+    }
+    push({std::move(job), counter}, affinity);
+}
+
+void scratch::JobSystem::runAfter(JobCounter &dependency, std::function<void()> job, JobCounter *counter,
+                                  JobAffinity affinity) {
+    // counted straight away so waiting on counter covers the job before it is queued
+    if (counter != nullptr) {
+        std::lock_guard<std::mutex> lock(counter->_mutex);
+        ++counter->_pending;
+    }
+    {
+        std::lock_guard<std::mutex> lock(dependency._mutex);
+        if (dependency._pending != 0) {
+            dependency._continuations.push_back({std::move(job), counter, affinity});
+            return;
+        }
+    }
+    push({std::move(job), counter}, affinity);
+}
+
+void scratch::JobSystem::wait(const JobCounter &counter) {
+    const bool mainThread = isMainThread();
+    while (!counter.isDone()) {
+        Job job;
+        if (takeJob(job) || (mainThread && takeMainThreadJob(job))) {
+            execute(job);
+        } else {
+            // what's left is running on other threads
+            std::this_thread::yield();
+        }
+    }
+}
+
+void scratch::JobSystem::parallelFor(size_t count, const std::function<void(size_t)> &body, size_t grainSize) {
+    if (count == 0) {
+        return;
+    }
+    if (grainSize == 0) {
+        // a few ranges per thread, so threads finishing early have something left to steal
+        size_t threadCount = _workers.size() + 1;
+        grainSize = std::max<size_t>(1, count / (threadCount * 4));
+    }
+    if (count <= grainSize) {
+        for (size_t i = 0; i < count; ++i) {
+            body(i);
+        }
+        return;
+    }
+
+    JobCounter counter;
+    std::mutex failureMutex;
+    std::exception_ptr failure;
+    std::atomic<bool> failed(false);
+    for (size_t begin = 0; begin < count; begin += grainSize) {
+        size_t end = std::min(begin + grainSize, count);
+        run([&, begin, end]() {
+            try {
+                for (size_t i = begin; i < end && !failed; ++i) {
+                    body(i);
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(failureMutex);
+                if (!failure) {
+                    failure = std::current_exception();
+                }
+                failed = true;
+            }
+        }, &counter);
+    }
+    // the ranges reference this stack frame, so every one of them has to finish before an exception leaves
+    wait(counter);
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+void scratch::JobSystem::runMainThreadJobs() {
+    if (!isMainThread()) {
+        return;
+    }
+    // only what's queued now, jobs queuing more main thread jobs would never let the frame go on
+    size_t jobCount;
+    {
+        std::lock_guard<std::mutex> lock(_mainThreadQueue.mutex);
+        jobCount = _mainThreadQueue.jobs.size();
+    }
+    Job job;
+    for (size_t i = 0; i < jobCount && takeMainThreadJob(job); ++i) {
+        execute(job);
+    }
+}
+
+bool scratch::JobSystem::isMainThread() const {
+    return std::this_thread::get_id() == _mainThreadId;
+}
+
+unsigned int scratch::JobSystem::getWorkerCount() const {
+    return static_cast<unsigned int>(_workers.size());
+}
+
+void scratch::JobSystem::workerLoop(unsigned int queueIndex) {
+    currentSystem = this;
+    currentQueue = queueIndex;
+    while (true) {
+        Job job;
+        if (takeJob(job)) {
+            execute(job);
+            continue;
+        }
+        if (takeWorkerThreadJob(job)) {
+            execute(job);
+            --_runningWorkerThreadJobs;
+            // a worker may have gone to sleep on the limit with more of them queued
+            if (_queuedWorkerThreadJobs > 0) {
+                wakeWorker();
+            }
+            continue;
+        }
+        if (_stopping) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        ++_sleepingWorkers;
+        _jobAvailable.wait(lock, [this]() { return _stopping || hasWorkForWorkers(); });
+        --_sleepingWorkers;
+    }
+}
+
+void scratch::JobSystem::push(Job job, JobAffinity affinity) {
+    if (affinity == MAIN_THREAD) {
+        std::lock_guard<std::mutex> lock(_mainThreadQueue.mutex);
+        _mainThreadQueue.jobs.push_back(std::move(job));
+        return;
+    }
+    if (affinity == WORKER_THREAD) {
+        {
+            std::lock_guard<std::mutex> lock(_workerThreadQueue.mutex);
+            _workerThreadQueue.jobs.push_back(std::move(job));
+        }
+        ++_queuedWorkerThreadJobs;
+    } else {
+        {
+            WorkQueue &queue = *_queues[currentQueueIndex()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.jobs.push_back(std::move(job));
+        }
+        ++_queuedJobs;
+    }
+    wakeWorker();
+}
+
+void scratch::JobSystem::wakeWorker() {
+    // a worker going to sleep counts itself before checking for work, so one of the two sees the other
+    if (_sleepingWorkers > 0) {
+        {
+            std::lock_guard<std::mutex> lock(_sleepMutex);
+        }
+        _jobAvailable.notify_one();
+    }
+}
+
+bool scratch::JobSystem::takeJob(Job &job) {
+    if (_queuedJobs == 0) {
+        return false;
+    }
+    const unsigned int ownIndex = currentQueueIndex();
+    {
+        WorkQueue &queue = *_queues[ownIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            --_queuedJobs;
+            return true;
+        }
+    }
+    const size_t queueCount = _queues.size();
+    const size_t firstVictim = nextStealVictim() % queueCount;
+    for (size_t i = 0; i < queueCount; ++i) {
+        size_t victim = (firstVictim + i) % queueCount;
+        if (victim == ownIndex) {
+            continue;
+        }
+        WorkQueue &queue = *_queues[victim];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            --_queuedJobs;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool scratch::JobSystem::takeMainThreadJob(Job &job) {
+    std::lock_guard<std::mutex> lock(_mainThreadQueue.mutex);
+    if (_mainThreadQueue.jobs.empty()) {
+        return false;
+    }
+    job = std::move(_mainThreadQueue.jobs.front());
+    _mainThreadQueue.jobs.pop_front();
+    return true;
+}
+
+bool scratch::JobSystem::takeWorkerThreadJob(Job &job) {
+    if (_queuedWorkerThreadJobs == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(_workerThreadQueue.mutex);
+    if (_workerThreadQueue.jobs.empty() || _runningWorkerThreadJobs >= _workerThreadJobLimit) {
+        return false;
+    }
+    job = std::move(_workerThreadQueue.jobs.front());
+    _workerThreadQueue.jobs.pop_front();
+    --_queuedWorkerThreadJobs;
+    ++_runningWorkerThreadJobs;
+    return true;
+}
+
+bool scratch::JobSystem::hasWorkForWorkers() const {
+    return _queuedJobs > 0 ||
+           (_queuedWorkerThreadJobs > 0 && _runningWorkerThreadJobs < _workerThreadJobLimit);
+}
+
+void scratch::JobSystem::execute(Job &job) {
+    try {
+        job.function();
+    } catch (const std::exception &exception) {
+        std::cout << "ERROR::scratch::JOB_SYSTEM::JOB_FAILED\n" << exception.what() << std::endl;
+    } catch (...) {
+        std::cout << "ERROR::scratch::JOB_SYSTEM::JOB_FAILED" << std::endl;
+    }
+    if (job.counter == nullptr) {
+        return;
+    }
+
+    std::vector<JobCounter::Continuation> continuations;
+    {
+        // held until the counter is no longer touched, a waiter may destroy it as soon as it reads as done
+        std::lock_guard<std::mutex> lock(job.counter->_mutex);
+        if (--job.counter->_pending == 0) {
+            continuations.swap(job.counter->_continuations);
+        }
+    }
+    for (auto &continuation : continuations) {
+        push({std::move(continuation.function), continuation.counter}, continuation.affinity);
+    }
+}
+
+unsigned int scratch::JobSystem::currentQueueIndex() const {
+    return currentSystem == this ? currentQueue : 0;
+}
@@ -0,0 +1,150 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace scratch {
+    // Which threads may run a job. GL calls only work on the thread owning the context, the main one.
+    // WORKER_THREAD is for long blocking work like reading and decoding files, which would hitch whichever
+    // thread picked it up while waiting on something else.
+    enum JobAffinity {
+        ANY_THREAD,
+        MAIN_THREAD,
+        WORKER_THREAD
+    };
+
+    // Counts the jobs started with it that haven't finished. Waiting on it, or starting jobs after it, is how
+    // jobs depend on each other. Must outlive its jobs.
+    class JobCounter {
+    public:
+        JobCounter() = default;
+
+        JobCounter(const JobCounter &other) = delete;
+
+        JobCounter &operator=(const JobCounter &other) = delete;
+
+        bool isDone() const;
+
+    private:
+        friend class JobSystem;
+
+        struct Continuation {
+            std::function<void()> function;
+            JobCounter *counter;
+            JobAffinity affinity;
+        };
+
+        mutable std::mutex _mutex;
+        size_t _pending = 0;
+        // jobs started with runAfter, queued once the count drops to zero
+        std::vector<Continuation> _continuations;
+    };
+
+    // Work stealing scheduler shared by the whole engine. Every worker and the main thread have a deque of their
+    // own, new jobs go to the back of the spawning thread's deque and are taken from there again, newest first,
+    // so the data they touch is still in cache. Idle workers steal the oldest job from the front of someone
+    // else's deque, which tends to be the largest piece of work left. Waiting never blocks a thread, it runs
+    // other jobs until the counter is done, so jobs can spawn and wait on jobs of their own.
+    // Jobs with MAIN_THREAD affinity are queued apart and run by the main thread only, from
+    // runMainThreadJobs or while it waits. WORKER_THREAD jobs are queued apart too and only taken by idle
+    // workers between jobs, never by a waiting thread, and never by every worker at once so short jobs still
+    // find one.
+    class JobSystem {
+    public:
+        // Defaults to one worker per core minus the main thread, which runs jobs too while it waits
+        explicit JobSystem(unsigned int workerCount = defaultWorkerCount());
+
+        ~JobSystem();
+
+        JobSystem(const JobSystem &other) = delete;
+
+        JobSystem &operator=(const JobSystem &other) = delete;
+
+        static unsigned int defaultWorkerCount();
+
+        // Queues job, counter is incremented now and decremented once it has run. Exceptions thrown by job are
+        // logged and dropped.
+        void run(std::function<void()> job, JobCounter *counter = nullptr, JobAffinity affinity = ANY_THREAD);
+
+        // Like run, but queued only once dependency is done
+        void runAfter(JobCounter &dependency, std::function<void()> job, JobCounter *counter = nullptr,
+                      JobAffinity affinity = ANY_THREAD);
+
+        // Runs other jobs until counter is done
+        void wait(const JobCounter &counter);
+
+        // Runs body(i) for every i in [0, count), split into ranges of grainSize, and waits for them. 0 picks a
+        // grain giving each thread a few ranges to balance with. Can be called from inside a job. The first
+        // exception thrown by body is rethrown once every range is done.
+        void parallelFor(size_t count, const std::function<void(size_t)> &body, size_t grainSize = 0);
+
+        // Runs the MAIN_THREAD jobs queued so far, call once per frame from the main thread
+        void runMainThreadJobs();
+
+        bool isMainThread() const;
+
+        unsigned int getWorkerCount() const;
+
+    private:
+        struct Job {
+            std::function<void()> function;
+            JobCounter *counter = nullptr;
+        };
+
+        // one per thread, the owner works the back and thieves the front
+        struct WorkQueue {
+            std::mutex mutex;
+            std::deque<Job> jobs;
+        };
+
+        std::vector<std::thread> _workers;
+        // index 0 belongs to the main thread, worker i uses i + 1
+        std::vector<std::unique_ptr<WorkQueue>> _queues;
+        WorkQueue _mainThreadQueue;
+        WorkQueue _workerThreadQueue;
+        std::thread::id _mainThreadId;
+
+        // jobs sitting in the deques, so idle workers know whether looking is worth it
+        std::atomic<size_t> _queuedJobs{0};
+        std::atomic<size_t> _queuedWorkerThreadJobs{0};
+        std::atomic<unsigned int> _runningWorkerThreadJobs{0};
+        // set before the workers start, one worker is kept for everything else unless there is only one
+        unsigned int _workerThreadJobLimit = 1;
+        std::atomic<unsigned int> _sleepingWorkers{0};
+        std::mutex _sleepMutex;
+        std::condition_variable _jobAvailable;
+        std::atomic<bool> _stopping{false};
+
+        void workerLoop(unsigned int queueIndex);
+
+        void push(Job job, JobAffinity affinity);
+
+        // Pops from this thread's own deque, then steals from the others
+        bool takeJob(Job &job);
+
+        bool takeMainThreadJob(Job &job);
+
+        // Only while fewer than _workerThreadJobLimit are running, counts the taken job as running
+        bool takeWorkerThreadJob(Job &job);
+
+        // Whether a sleeping worker has anything to wake up for
+        bool hasWorkForWorkers() const;
+
+        void wakeWorker();
+
+        void execute(Job &job);
+
+        // The calling thread's deque, the main thread's for threads that aren't this system's
+        unsigned int currentQueueIndex() const;
+    };
+}
@@ -0,0 +1,102 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+#include "thread_pool.h"
+
+scratch::ThreadPool::ThreadPool(unsigned int threadCount) {
+    _stopping = false;
+    for (unsigned int i = 0; i < threadCount; ++i) {
+        _workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+scratch::ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _taskAvailable.notify_all();
+    for (auto &worker : _workers) {
+        worker.join();
+    }
+}
+
+unsigned int scratch::ThreadPool::defaultThreadCount() {
+    unsigned int cores = std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 1;
+}
+
+std::future<void> scratch::ThreadPool::submit(std::function<void()> task) {
+    std::packaged_task<void()> packagedTask(std::move(task));
+    std::future<void> result = packagedTask.get_future();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tasks.push(std::move(packagedTask));
+    }
+    _taskAvailable.notify_one();
+    return result;
+}
+
+void scratch::ThreadPool::parallelFor(size_t count, const std::function<void(size_t)> &body) {
+    if (count == 0) {
+        return;
+    }
+    std::atomic<size_t> nextIndex(0);
+    auto drain = [&nextIndex, count, &body]() {
+        for (size_t i = nextIndex++; i < count; i = nextIndex++) {
+            body(i);
+        }
+    };
+
+    size_t helperCount = std::min<size_t>(_workers.size(), count - 1);
+    std::vector<std::future<void>> helpers;
+    helpers.reserve(helperCount);
+    for (size_t i = 0; i < helperCount; ++i) {
+        helpers.push_back(submit(drain));
+    }
+    // helpers reference this stack frame, so every one of them has to finish before an exception leaves
+    std::exception_ptr failure;
+    try {
+        drain();
+    } catch (...) {
+        failure = std::current_exception();
+        nextIndex = count;
+    }
+    for (auto &helper : helpers) {
+        try {
+            helper.get();
+        } catch (...) {
+            if (!failure) {
+                failure = std::current_exception();
+            }
+        }
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+unsigned int scratch::ThreadPool::getThreadCount() const {
+    return static_cast<unsigned int>(_workers.size());
+}
+
+void scratch::ThreadPool::workerLoop() {
+    while (true) {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _taskAvailable.wait(lock, [this]() { return _stopping || !_tasks.empty(); });
+            if (_stopping && _tasks.empty()) {
+                return;
+            }
+            task = std::move(_tasks.front());
+            _tasks.pop();
+        }
+        task();
+    }
+}
@@ -0,0 +1,48 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace scratch {
+    // Fixed set of worker threads pulling tasks from a shared queue
+    class ThreadPool {
+    public:
+        // Defaults to one worker per core minus the calling thread, which helps out in parallelFor
+        explicit ThreadPool(unsigned int threadCount = defaultThreadCount());
+
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &other) = delete;
+
+        ThreadPool &operator=(const ThreadPool &other) = delete;
+
+        static unsigned int defaultThreadCount();
+
+        // Queues a task, exceptions thrown by it are rethrown from the returned future
+        std::future<void> submit(std::function<void()> task);
+
+        // Runs body(i) for every i in [0, count) across the workers and the calling thread, blocks until done.
+        // Must not be called from inside a pool task.
+        void parallelFor(size_t count, const std::function<void(size_t)> &body);
+
+        unsigned int getThreadCount() const;
+
+    private:
+        std::vector<std::thread> _workers;
+        std::queue<std::packaged_task<void()>> _tasks;
+        std::mutex _mutex;
+        std::condition_variable _taskAvailable;
+        bool _stopping;
+
+        void workerLoop();
+    };
+}
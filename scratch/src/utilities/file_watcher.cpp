@@ -0,0 +1,93 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+
+#include <iostream>
+
+#ifdef __linux__
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#endif
+
+#include "file_watcher.h"
+
+scratch::FileWatcher::FileWatcher() {
+#ifdef __linux__
+    _inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (_inotify < 0) {
+        std::cout << "inotify unavailable, falling back to polling modification times" << std::endl;
+    }
+#endif
+}
+
+scratch::FileWatcher::~FileWatcher() {
+#ifdef __linux__
+    if (_inotify >= 0) {
+        close(_inotify);
+    }
+#endif
+}
+
+void scratch::FileWatcher::watch(const std::string &path) {
+    std::string canonicalPath = toCanonical(path);
+    if (!_watchedPaths.emplace(canonicalPath, path).second) {
+        return;
+    }
+    std::error_code error;
+    _writeTimes[canonicalPath] = std::filesystem::last_write_time(canonicalPath, error);
+
+#ifdef __linux__
+    std::string directory = std::filesystem::path(canonicalPath).parent_path().string();
+    if (_inotify >= 0 && _watchedDirectories.insert(directory).second) {
+        int descriptor = inotify_add_watch(_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if (descriptor >= 0) {
+            _directories[descriptor] = directory;
+        } else {
+            std::cout << "Could not watch " << directory << std::endl;
+        }
+    }
+#endif
+}
+
+std::vector<std::string> scratch::FileWatcher::poll() {
+    std::set<std::string> changed;
+#ifdef __linux__
+    if (_inotify >= 0) {
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length;
+        while ((length = read(_inotify, buffer, sizeof(buffer))) > 0) {
+            for (char *position = buffer; position < buffer + length;) {
+                auto *event = reinterpret_cast<inotify_event *>(position);
+                position += sizeof(inotify_event) + event->len;
+                auto directory = _directories.find(event->wd);
+                if (event->len == 0 || directory == _directories.end()) {
+                    continue;
+                }
+                std::string eventPath = (std::filesystem::path(directory->second) / event->name).string();
+                auto watched = _watchedPaths.find(eventPath);
+                if (watched != _watchedPaths.end()) {
+                    changed.insert(watched->second);
+                }
+            }
+        }
+        return std::vector<std::string>(changed.begin(), changed.end());
+    }
+#endif
+    for (auto &[canonicalPath, writeTime] : _writeTimes) {
+        std::error_code error;
+        auto currentTime = std::filesystem::last_write_time(canonicalPath, error);
+        if (!error && currentTime != writeTime) {
+            writeTime = currentTime;
+            changed.insert(_watchedPaths[canonicalPath]);
+        }
+    }
+    return std::vector<std::string>(changed.begin(), changed.end());
+}
+
+std::string scratch::FileWatcher::toCanonical(const std::string &path) {
+    std::error_code error;
+    std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(path, error);
+    return error ? std::filesystem::absolute(path).lexically_normal().string() : canonicalPath.string();
+}
@@ -0,0 +1,44 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace scratch {
+    // Reports files that were written since the last poll. Uses inotify on Linux, watching the parent directories
+    // so editors that save by replacing the file are still seen. Other platforms compare modification times.
+    class FileWatcher {
+    public:
+        FileWatcher();
+
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher &other) = delete;
+
+        FileWatcher &operator=(const FileWatcher &other) = delete;
+
+        // Watching the same file twice is harmless
+        void watch(const std::string &path);
+
+        // Never blocks, every changed file is listed once with the path it was watched under
+        std::vector<std::string> poll();
+
+    private:
+        // canonical path -> path as passed to watch
+        std::map<std::string, std::string> _watchedPaths;
+        std::map<std::string, std::filesystem::file_time_type> _writeTimes;
+#ifdef __linux__
+        int _inotify = -1;
+        // watch descriptor -> canonical directory
+        std::map<int, std::string> _directories;
+        std::set<std::string> _watchedDirectories;
+#endif
+
+        static std::string toCanonical(const std::string &path);
+    };
+}
@@ -0,0 +1,168 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+// Skeletal animation microbenchmark. Poses a crowd of synthetic characters the way a frame snapshot does,
+// keyframe sampling plus the skinning palette, on one thread and then across the job system.
+//
+// usage: animation_benchmark [--instances <count>] [--joints <count>]
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "animation/animation_sampler.h"
+#include "threading/job_system.h"
+
+namespace {
+    const int REPEATS = 5;
+    // keys per second on every channel, about what exporters bake at
+    const float KEY_RATE = 30.0f;
+    const float CLIP_DURATION = 2.0f;
+
+    // best of REPEATS runs in milliseconds, the minimum being the run the OS disturbed least
+    double measure(const std::function<void()> &benchmark) {
+        double best = 0.0;
+        for (int i = 0; i < REPEATS; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            benchmark();
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            best = i == 0 ? elapsed.count() : std::min(best, elapsed.count());
+        }
+        return best;
+    }
+
+    void printRow(const std::string &name, double milliseconds, size_t instances, size_t joints) {
+        std::cout << std::left << std::setw(40) << name << std::right << std::setw(10) << std::fixed
+                  << std::setprecision(3) << milliseconds << " ms" << std::setw(12) << std::setprecision(2)
+                  << milliseconds * 1.0e3 / static_cast<double>(instances) << " us/character" << std::setw(10)
+                  << std::setprecision(1) << milliseconds * 1.0e6 / static_cast<double>(instances * joints)
+                  << " ns/joint" << std::endl;
+    }
+
+    // A spine with limbs branching off it every few joints, roughly a humanoid's shape at any joint count
+    scratch::Skeleton makeSkeleton(size_t jointCount) {
+        scratch::Skeleton skeleton;
+        for (size_t joint = 0; joint < jointCount; ++joint) {
+            int parent = joint == 0 ? -1 : static_cast<int>(joint % 4 == 0 ? joint / 2 : joint - 1);
+            skeleton.jointNames.push_back("joint" + std::to_string(joint));
+            skeleton.parents.push_back(parent);
+            skeleton.bindPose.push_back({glm::vec3(0.0f, 0.1f, 0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                                         glm::vec3(1.0f)});
+            skeleton.inverseBindMatrices.emplace_back(1.0f);
+            // a limb segment's worth of vertices around each joint
+            skeleton.jointBounds.emplace_back(glm::vec3(-0.05f, 0.0f, -0.05f), glm::vec3(0.05f, 0.1f, 0.05f));
+        }
+        return skeleton;
+    }
+
+    // Every joint rotates and the root moves too, scale is left to the bind pose like most clips do
+    scratch::AnimationClip makeClip(const scratch::Skeleton &skeleton) {
+        scratch::AnimationClip clip;
+        clip.name = "synthetic";
+        clip.duration = CLIP_DURATION;
+        clip.channels.resize(skeleton.getJointCount());
+        auto keyCount = static_cast<size_t>(CLIP_DURATION * KEY_RATE) + 1;
+        for (size_t joint = 0; joint < skeleton.getJointCount(); ++joint) {
+            scratch::JointChannel &channel = clip.channels[joint];
+            for (size_t key = 0; key < keyCount; ++key) {
+                float time = static_cast<float>(key) / KEY_RATE;
+                float angle = std::sin(time * 3.0f + static_cast<float>(joint)) * 0.5f;
+                channel.rotationTimes.push_back(time);
+                channel.rotations.emplace_back(std::cos(angle * 0.5f), std::sin(angle * 0.5f), 0.0f, 0.0f);
+                if (joint == 0) {
+                    channel.translationTimes.push_back(time);
+                    channel.translations.emplace_back(0.0f, std::sin(time), time);
+                }
+            }
+        }
+        return clip;
+    }
+
+    // characters spread over the clip so they don't all hit the same keys
+    std::vector<scratch::AnimationInstance> makeInstances(const scratch::Skeleton &skeleton,
+                                                          const scratch::AnimationClip &clip, size_t instanceCount) {
+        std::vector<scratch::AnimationInstance> instances;
+        instances.reserve(instanceCount);
+        for (size_t i = 0; i < instanceCount; ++i) {
+            float time = CLIP_DURATION * static_cast<float>(i) / static_cast<float>(instanceCount);
+            instances.push_back({&skeleton, &clip, time, scratch::AnimationSampler::getJointCount(instances)});
+        }
+        return instances;
+    }
+
+    void benchmarkSampling(size_t instanceCount, size_t jointCount) {
+        scratch::Skeleton skeleton = makeSkeleton(jointCount);
+        scratch::AnimationClip clip = makeClip(skeleton);
+        std::vector<scratch::AnimationInstance> instances = makeInstances(skeleton, clip, instanceCount);
+        scratch::PoseBuffer poses;
+        std::vector<glm::mat4> palette;
+        std::vector<scratch::Bounds> poseBounds;
+
+        uint32_t totalJoints = scratch::AnimationSampler::getJointCount(instances);
+        poses.resize(totalJoints);
+        palette.resize(totalJoints);
+        double sampling = measure([&]() {
+            for (const auto &instance : instances) {
+                scratch::AnimationSampler::samplePose(instance, poses);
+            }
+        });
+        printRow("keyframe sampling, 1 thread", sampling, instanceCount, jointCount);
+        double palettes = measure([&]() {
+            for (const auto &instance : instances) {
+                scratch::AnimationSampler::computePalette(instance, poses, palette.data() + instance.firstJoint);
+            }
+        });
+        printRow("palette, 1 thread", palettes, instanceCount, jointCount);
+        double serial = sampling + palettes;
+        printRow("sampling + palette, 1 thread", serial, instanceCount, jointCount);
+
+        // doubling up to every core, and every core even when that isn't a power of two
+        std::vector<unsigned int> workerCounts;
+        unsigned int maxWorkers = scratch::JobSystem::defaultWorkerCount();
+        for (unsigned int workers = 1; workers < maxWorkers; workers *= 2) {
+            workerCounts.push_back(workers);
+        }
+        workerCounts.push_back(maxWorkers);
+
+        for (unsigned int workers : workerCounts) {
+            scratch::JobSystem jobSystem(workers);
+            double jobs = measure([&]() {
+                scratch::AnimationSampler::sample(instances, poses, palette, poseBounds, jobSystem);
+            });
+            printRow("AnimationSampler::sample, " + std::to_string(workers + 1) + " threads", jobs, instanceCount,
+                     jointCount);
+            std::cout << std::left << std::setw(40) << "  speedup over 1 thread" << std::right << std::setw(10)
+                      << std::setprecision(2) << serial / jobs << "x" << std::endl;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t instanceCount = 500;
+    size_t jointCount = 64;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--instances" && i + 1 < argc) {
+            instanceCount = std::strtoull(argv[++i], nullptr, 10);
+        } else if (argument == "--joints" && i + 1 < argc) {
+            jointCount = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::cout << "usage: animation_benchmark [--instances <count>] [--joints <count>]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    instanceCount = std::max<size_t>(instanceCount, 1);
+    jointCount = std::max<size_t>(jointCount, 1);
+
+    std::cout << instanceCount << " characters of " << jointCount << " joints, " << KEY_RATE
+              << " keys a second, best of " << REPEATS << " runs" << std::endl;
+    benchmarkSampling(instanceCount, jointCount);
+    return EXIT_SUCCESS;
+}
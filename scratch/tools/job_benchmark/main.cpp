@@ -0,0 +1,159 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+// Job system microbenchmarks. Measures what spawning and stealing a job costs and how parallelFor scales with
+// the worker count, next to ThreadPool::parallelFor as the baseline it replaced.
+//
+// usage: job_benchmark [--jobs <count>] [--items <count>]
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "threading/job_system.h"
+#include "threading/thread_pool.h"
+
+namespace {
+    const int REPEATS = 5;
+
+    // best of REPEATS runs in milliseconds, the minimum being the run the OS disturbed least
+    double measure(const std::function<void()> &benchmark) {
+        double best = 0.0;
+        for (int i = 0; i < REPEATS; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            benchmark();
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            best = i == 0 ? elapsed.count() : std::min(best, elapsed.count());
+        }
+        return best;
+    }
+
+    // a few hundred nanoseconds of arithmetic the optimizer can't drop
+    void work(std::vector<float> &results, size_t i) {
+        float value = static_cast<float>(i);
+        for (int step = 0; step < 64; ++step) {
+            value = std::sqrt(value * value + 1.0f);
+        }
+        results[i] = value;
+    }
+
+    void printRow(const std::string &name, double milliseconds, size_t operations) {
+        std::cout << std::left << std::setw(40) << name << std::right << std::setw(10) << std::fixed
+                  << std::setprecision(3) << milliseconds << " ms" << std::setw(12) << std::setprecision(1)
+                  << milliseconds * 1.0e6 / static_cast<double>(operations) << " ns/op" << std::endl;
+    }
+
+    // every job queued by the main thread, so the workers steal all of them
+    void benchmarkSpawn(size_t jobCount) {
+        scratch::JobSystem jobSystem;
+        std::atomic<size_t> ran(0);
+        double milliseconds = measure([&]() {
+            scratch::JobCounter counter;
+            for (size_t i = 0; i < jobCount; ++i) {
+                jobSystem.run([&ran]() { ran.fetch_add(1, std::memory_order_relaxed); }, &counter);
+            }
+            jobSystem.wait(counter);
+        });
+        printRow("spawn + wait, empty jobs", milliseconds, jobCount);
+    }
+
+    // one job per worker spawning the rest from its own deque, which the others have to steal from
+    void benchmarkSteal(size_t jobCount) {
+        scratch::JobSystem jobSystem;
+        std::atomic<size_t> ran(0);
+        const size_t spawners = jobSystem.getWorkerCount() + 1;
+        double milliseconds = measure([&]() {
+            scratch::JobCounter counter;
+            for (size_t spawner = 0; spawner < spawners; ++spawner) {
+                jobSystem.run([&]() {
+                    for (size_t i = 0; i < jobCount / spawners; ++i) {
+                        jobSystem.run([&ran]() { ran.fetch_add(1, std::memory_order_relaxed); }, &counter);
+                    }
+                }, &counter);
+            }
+            jobSystem.wait(counter);
+        });
+        printRow("spawn from jobs + steal, empty jobs", milliseconds, jobCount);
+    }
+
+    // jobs chained one after the other, the latency of handing a continuation over
+    void benchmarkDependencies(size_t chainLength) {
+        scratch::JobSystem jobSystem;
+        double milliseconds = measure([&]() {
+            std::vector<scratch::JobCounter> counters(chainLength);
+            jobSystem.run([]() {}, &counters[0]);
+            for (size_t i = 1; i < chainLength; ++i) {
+                jobSystem.runAfter(counters[i - 1], []() {}, &counters[i]);
+            }
+            jobSystem.wait(counters.back());
+        });
+        printRow("dependency chain", milliseconds, chainLength);
+    }
+
+    void benchmarkParallelFor(size_t itemCount) {
+        std::vector<float> results(itemCount);
+        double serial = measure([&]() {
+            for (size_t i = 0; i < itemCount; ++i) {
+                work(results, i);
+            }
+        });
+        printRow("serial loop", serial, itemCount);
+
+        // doubling up to every core, and every core even when that isn't a power of two
+        std::vector<unsigned int> workerCounts;
+        unsigned int maxWorkers = scratch::JobSystem::defaultWorkerCount();
+        for (unsigned int workers = 1; workers < maxWorkers; workers *= 2) {
+            workerCounts.push_back(workers);
+        }
+        workerCounts.push_back(maxWorkers);
+
+        for (unsigned int workers : workerCounts) {
+            scratch::JobSystem jobSystem(workers);
+            double jobs = measure([&]() {
+                jobSystem.parallelFor(itemCount, [&](size_t i) { work(results, i); });
+            });
+            scratch::ThreadPool threadPool(workers);
+            double pool = measure([&]() {
+                threadPool.parallelFor(itemCount, [&](size_t i) { work(results, i); });
+            });
+            std::string threads = std::to_string(workers + 1) + " threads";
+            printRow("JobSystem::parallelFor, " + threads, jobs, itemCount);
+            printRow("ThreadPool::parallelFor, " + threads, pool, itemCount);
+            std::cout << std::left << std::setw(40) << "  speedup over serial, jobs / pool" << std::right
+                      << std::setw(10) << std::setprecision(2) << serial / jobs << "x" << std::setw(12)
+                      << serial / pool << "x" << std::endl;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t jobCount = 1000000;
+    size_t itemCount = 1 << 20;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--jobs" && i + 1 < argc) {
+            jobCount = std::strtoull(argv[++i], nullptr, 10);
+        } else if (argument == "--items" && i + 1 < argc) {
+            itemCount = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::cout << "usage: job_benchmark [--jobs <count>] [--items <count>]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::cout << "Job system with " << scratch::JobSystem::defaultWorkerCount() << " workers, best of "
+              << REPEATS << " runs" << std::endl;
+    benchmarkSpawn(jobCount);
+    benchmarkSteal(jobCount);
+    benchmarkDependencies(jobCount / 10);
+    benchmarkParallelFor(itemCount);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,139 @@
+//
+// Created by JJJai on 10/19/2026.
+//
+// Offline texture cooker. Compresses images into block compressed DDS files with a full mip chain,
+// written next to the source image where the engine picks them up instead of the original.
+//
+// usage: texture_cooker [--role diffuse|specular|normal|height] [--format bc1|bc3|bc5|bc7] <image>...
+//
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+
+#include <stb_image.h>
+
+#include "graphics/bc_encoder.h"
+#include "graphics/dds_file.h"
+#include "graphics/image_downsampler.h"
+
+enum CookRole {
+    DIFFUSE,
+    SPECULAR,
+    NORMAL,
+    HEIGHT
+};
+const std::map<std::string, CookRole> STRING_TO_COOK_ROLE{{"diffuse",  DIFFUSE},
+                                                          {"specular", SPECULAR},
+                                                          {"normal",   NORMAL},
+                                                          {"height",   HEIGHT}};
+
+struct Image {
+    int width;
+    int height;
+    std::vector<uint8_t> rgba;
+};
+
+Image downsample(const Image &source, CookRole role) {
+    scratch::DownsampleMode mode = role == DIFFUSE ? scratch::DOWNSAMPLE_SRGB
+                                                   : role == NORMAL ? scratch::DOWNSAMPLE_NORMAL
+                                                                    : scratch::DOWNSAMPLE_LINEAR;
+    Image result;
+    result.rgba = scratch::ImageDownsampler::halve(source.rgba.data(), source.width, source.height, 4, mode,
+                                                   result.width, result.height);
+    return result;
+}
+
+scratch::BlockFormat defaultFormat(const Image &image, CookRole role) {
+    if (role == NORMAL) {
+        return scratch::BC5;
+    }
+    bool opaque = true;
+    for (size_t i = 3; i < image.rgba.size(); i += 4) {
+        opaque = opaque && image.rgba[i] == 255;
+    }
+    return opaque ? scratch::BC1 : scratch::BC3;
+}
+
+void cook(const std::string &inputPath, CookRole role, bool formatOverridden, scratch::BlockFormat format) {
+    Image image;
+    int channels;
+    unsigned char *pixels = stbi_load(inputPath.c_str(), &image.width, &image.height, &channels, 4);
+    if (pixels == nullptr) {
+        throw std::runtime_error("Could not load " + inputPath + ": " + stbi_failure_reason());
+    }
+    image.rgba.assign(pixels, pixels + static_cast<size_t>(image.width) * image.height * 4);
+    stbi_image_free(pixels);
+
+    scratch::CompressedTexture texture;
+    texture.format = formatOverridden ? format : defaultFormat(image, role);
+    texture.srgb = role == DIFFUSE;
+
+    while (true) {
+        std::vector<uint8_t> blocks = scratch::BcEncoder::encode(texture.format, image.rgba.data(),
+                                                                 image.width, image.height);
+        texture.mips.push_back({image.width, image.height, texture.data.size(), blocks.size()});
+        texture.data.insert(texture.data.end(), blocks.begin(), blocks.end());
+        if (image.width == 1 && image.height == 1) {
+            break;
+        }
+        image = downsample(image, role);
+    }
+
+    std::string outputPath = std::filesystem::path(inputPath).replace_extension(".dds").string();
+    scratch::DdsFile::write(outputPath, texture);
+    std::cout << inputPath << " -> " << outputPath << " (" << scratch::BLOCK_FORMAT_TO_STRING.find(texture.format)->second
+              << ", " << texture.mips.size() << " mips)" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    CookRole role = DIFFUSE;
+    bool formatOverridden = false;
+    scratch::BlockFormat format = scratch::BC1;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--role" && i + 1 < argc) {
+            auto found = STRING_TO_COOK_ROLE.find(argv[++i]);
+            if (found == STRING_TO_COOK_ROLE.end()) {
+                std::cout << "Unknown role " << argv[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+            role = found->second;
+        } else if (argument == "--format" && i + 1 < argc) {
+            auto found = scratch::STRING_TO_BLOCK_FORMAT.find(argv[++i]);
+            if (found == scratch::STRING_TO_BLOCK_FORMAT.end()) {
+                std::cout << "Unknown format " << argv[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+            format = found->second;
+            formatOverridden = true;
+        } else {
+            inputs.push_back(argument);
+        }
+    }
+
+    if (inputs.empty()) {
+        std::cout << "usage: texture_cooker [--role diffuse|specular|normal|height] [--format bc1|bc3|bc5|bc7] <image>..."
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    int result = EXIT_SUCCESS;
+    for (const auto &input : inputs) {
+        try {
+            cook(input, role, formatOverridden, format);
+        } catch (const std::runtime_error &error) {
+            std::cout << error.what() << std::endl;
+            result = EXIT_FAILURE;
+        }
+    }
+    return result;
+}